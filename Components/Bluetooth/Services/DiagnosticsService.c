@@ -5,12 +5,25 @@
 #include "ble_conn_state.h"
 #include "nrf_log.h"
 
-void (*mWeightFilterInputCoefficientReceivedCallback)(float coefficient) = NULL;
-void (*mWeightFilterOutputCoefficientReceivedCallback)(float coefficient) = NULL;
+void (*mWeightFilterCutoffReceivedCallback)(float cutoff) = NULL;
+void (*mCompensationLearningReceivedCallback)(uint8_t command) = NULL;
+void (*mPipelineReceivedCallback)(const diagnostics_pipeline_t *pipeline) = NULL;
 
 
 DIAGNOSTICS_SERVICE_DEF(m_diagnostics_service);
 
+// Raw capture state. Packets are built and sent from main context only, the BLE event handler only
+// starts and stops the capture
+static volatile bool mRawCaptureEnabled = false;
+static uint8_t mRawCaptureQueue[DIAGNOSTICS_RAW_CAPTURE_QUEUE_LENGTH][DIAGNOSTICS_RAW_CAPTURE_PACKET_SIZE];
+static uint8_t mRawCaptureQueueHead = 0;
+static uint8_t mRawCaptureQueueCount = 0;
+static uint8_t mRawCapturePacket[DIAGNOSTICS_RAW_CAPTURE_PACKET_SIZE];
+static uint8_t mRawCapturePacketCodes = 0;
+static uint16_t mRawCaptureSequence = 0;
+static uint32_t mRawCaptureDroppedPackets = 0;
+static bool mRawCaptureRestart = false;
+
 /**@brief Function for handling the Write event.
  *
  * @param[in]   p_ble_evt   Event received from the BLE stack.
@@ -24,7 +37,24 @@ static void on_write(ble_evt_t const * p_ble_evt)
 
     ble_gatts_evt_write_t const * p_evt_write = &p_ble_evt->evt.gatts_evt.params.write;
 
-    if (    (p_evt_write->handle == m_diagnostics_service.weight_filter_output_coefficient_handles.cccd_handle) &&
+    if (    (p_evt_write->handle == m_diagnostics_service.raw_capture_handles.cccd_handle) &&
+            (p_evt_write->len == 2))
+    {
+        if (ble_srv_is_notification_enabled(p_evt_write->data))
+        {
+            NRF_LOG_INFO("Raw capture started.");
+            m_diagnostics_service.raw_capture_conn_handle = p_ble_evt->evt.gatts_evt.conn_handle;
+            mRawCaptureRestart = true;
+            mRawCaptureEnabled = true;
+        }
+        else
+        {
+            NRF_LOG_INFO("Raw capture stopped.");
+            mRawCaptureEnabled = false;
+        }
+    }
+
+    if (    (p_evt_write->handle == m_diagnostics_service.weight_filter_cutoff_handles.cccd_handle) &&
             (p_evt_write->len == 4))
     {
         if (m_diagnostics_service.evt_handler == NULL)
@@ -49,21 +79,55 @@ static void on_write(ble_evt_t const * p_ble_evt)
         m_diagnostics_service.evt_handler(&m_diagnostics_service, &evt);
     }
 
-    if (    (p_evt_write->handle == m_diagnostics_service.weight_filter_output_coefficient_handles.value_handle) &&
+    if (    (p_evt_write->handle == m_diagnostics_service.weight_filter_cutoff_handles.value_handle) &&
             (p_evt_write->len == 4)
        )
     {
-        NRF_LOG_INFO("Value Received from weight filter output coefficient.");
+        NRF_LOG_INFO("Value Received from weight filter cutoff.");
+
+        if (mWeightFilterCutoffReceivedCallback != NULL)
+        {
+            float cutoff;
+            memcpy(&cutoff, p_evt_write->data, sizeof(cutoff));
+            (mWeightFilterCutoffReceivedCallback)(cutoff);
+        }
+        else
+        {
+            NRF_LOG_INFO("No weight filter cutoff received callback set.");
+        }
+    }
+
+    if (    (p_evt_write->handle == m_diagnostics_service.compensation_learning_handles.value_handle) &&
+            (p_evt_write->len == 1)
+       )
+    {
+        NRF_LOG_INFO("Compensation learning command %d received.", p_evt_write->data[0]);
+
+        if (mCompensationLearningReceivedCallback != NULL)
+        {
+            (mCompensationLearningReceivedCallback)(p_evt_write->data[0]);
+        }
+        else
+        {
+            NRF_LOG_INFO("No compensation learning received callback set.");
+        }
+    }
+
+    if (    (p_evt_write->handle == m_diagnostics_service.pipeline_handles.value_handle) &&
+            (p_evt_write->len == sizeof(diagnostics_pipeline_t))
+       )
+    {
+        NRF_LOG_INFO("Pipeline %d received.", p_evt_write->data[0]);
 
-        if (*mWeightFilterOutputCoefficientReceivedCallback != NULL)
+        if (mPipelineReceivedCallback != NULL)
         {
-            float coefficient;
-            memcpy(&coefficient, p_evt_write->data, sizeof(coefficient));
-            (mWeightFilterOutputCoefficientReceivedCallback)(coefficient);
+            diagnostics_pipeline_t pipeline;
+            memcpy(&pipeline, p_evt_write->data, sizeof(pipeline));
+            (mPipelineReceivedCallback)(&pipeline);
         }
         else
         {
-            NRF_LOG_INFO("No weight filter output coefficient received callback set.");
+            NRF_LOG_INFO("No pipeline received callback set.");
         }
     }
 }
@@ -81,6 +145,14 @@ void diagnostics_service_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_contex
             on_write(p_ble_evt);
             break;
 
+        case BLE_GAP_EVT_DISCONNECTED:
+            if (p_ble_evt->evt.gap_evt.conn_handle == m_diagnostics_service.raw_capture_conn_handle)
+            {
+                mRawCaptureEnabled = false;
+                m_diagnostics_service.raw_capture_conn_handle = BLE_CONN_HANDLE_INVALID;
+            }
+            break;
+
         default:
             // No implementation needed.
             break;
@@ -88,31 +160,31 @@ void diagnostics_service_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_contex
 }
 
 
-/**@brief Function for adding the Weight Filter Output Coefficient characteristic.
+/**@brief Function for adding the Weight Filter Cutoff characteristic.
  *
 .
  * @param[in]   p_diagnostics_service_init   Information needed to initialize the service.
  *
  * @return      NRF_SUCCESS on success, otherwise an error code.
  */
-static ret_code_t diagnostics_service_weight_filter_output_coefficient_char_add(const diagnostics_service_init_t * p_diagnostics_service_init)
+static ret_code_t diagnostics_service_weight_filter_cutoff_char_add(const diagnostics_service_init_t * p_diagnostics_service_init)
 {
     ret_code_t             err_code;
     ble_add_char_params_t  add_char_params;
     ble_add_descr_params_t add_descr_params;
-    float                  initial_weight_filter_output_coefficient_threshold;
+    float                  initial_weight_filter_cutoff;
     uint8_t                init_len;
     uint8_t                encoded_report_ref[BLE_SRV_ENCODED_REPORT_REF_LEN];
 
-    // Add weight filter output coefficient characteristic
-    initial_weight_filter_output_coefficient_threshold = 0.5;
+    // Add weight filter cutoff characteristic
+    initial_weight_filter_cutoff = p_diagnostics_service_init->initial_filter_cutoff_value;
 
     memset(&add_char_params, 0, sizeof(add_char_params));
-    add_char_params.uuid              = DIAGNOSTICS_SERVICE_WEIGHT_FILTER_OUTPUT_COEFFICIENT_CHAR_UUID;
+    add_char_params.uuid              = DIAGNOSTICS_SERVICE_WEIGHT_FILTER_CUTOFF_CHAR_UUID;
     add_char_params.uuid_type         = m_diagnostics_service.uuid_type;
     add_char_params.max_len           = sizeof(float);
     add_char_params.init_len          = sizeof(float);
-    add_char_params.p_init_value      = (uint8_t*)&initial_weight_filter_output_coefficient_threshold;
+    add_char_params.p_init_value      = (uint8_t*)&initial_weight_filter_cutoff;
     add_char_params.char_props.notify = m_diagnostics_service.is_notification_supported;
     add_char_params.char_props.read   = 1;
     add_char_params.char_props.write   = 1;
@@ -122,7 +194,7 @@ static ret_code_t diagnostics_service_weight_filter_output_coefficient_char_add(
 
     err_code = characteristic_add(m_diagnostics_service.service_handle,
                                   &add_char_params,
-                                  &(m_diagnostics_service.weight_filter_output_coefficient_handles));
+                                  &(m_diagnostics_service.weight_filter_cutoff_handles));
     if (err_code != NRF_SUCCESS)
     {
         return err_code;
@@ -141,7 +213,7 @@ static ret_code_t diagnostics_service_weight_filter_output_coefficient_char_add(
         add_descr_params.max_len     = add_descr_params.init_len;
         add_descr_params.p_value     = encoded_report_ref;
 
-        err_code = descriptor_add(m_diagnostics_service.weight_filter_output_coefficient_handles.value_handle,
+        err_code = descriptor_add(m_diagnostics_service.weight_filter_cutoff_handles.value_handle,
                                   &add_descr_params,
                                   &m_diagnostics_service.report_ref_handle);
         return err_code;
@@ -154,6 +226,221 @@ static ret_code_t diagnostics_service_weight_filter_output_coefficient_char_add(
     return NRF_SUCCESS;
 }
 
+/**@brief Function for adding the raw capture characteristic.
+ *
+ * @param[in]   p_diagnostics_service_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static ret_code_t diagnostics_service_raw_capture_char_add(const diagnostics_service_init_t * p_diagnostics_service_init)
+{
+    ble_add_char_params_t  add_char_params;
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid              = DIAGNOSTICS_SERVICE_RAW_CAPTURE_CHAR_UUID;
+    add_char_params.uuid_type         = m_diagnostics_service.uuid_type;
+    add_char_params.max_len           = DIAGNOSTICS_RAW_CAPTURE_PACKET_SIZE;
+    add_char_params.init_len          = 0;
+    add_char_params.is_var_len        = true;
+    add_char_params.char_props.notify = m_diagnostics_service.is_notification_supported;
+    add_char_params.cccd_write_access = p_diagnostics_service_init->bl_cccd_wr_sec;
+    add_char_params.read_access       = p_diagnostics_service_init->bl_rd_sec;
+
+    return characteristic_add(m_diagnostics_service.service_handle,
+                              &add_char_params,
+                              &(m_diagnostics_service.raw_capture_handles));
+}
+
+/**@brief Function for adding the rejected samples characteristic.
+ *
+ * @param[in]   p_diagnostics_service_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static ret_code_t diagnostics_service_rejected_samples_char_add(const diagnostics_service_init_t * p_diagnostics_service_init)
+{
+    ble_add_char_params_t  add_char_params;
+    uint32_t               initial_rejected_samples = 0;
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid              = DIAGNOSTICS_SERVICE_REJECTED_SAMPLES_CHAR_UUID;
+    add_char_params.uuid_type         = m_diagnostics_service.uuid_type;
+    add_char_params.max_len           = sizeof(uint32_t);
+    add_char_params.init_len          = sizeof(uint32_t);
+    add_char_params.p_init_value      = (uint8_t*)&initial_rejected_samples;
+    add_char_params.char_props.notify = m_diagnostics_service.is_notification_supported;
+    add_char_params.char_props.read   = 1;
+    add_char_params.cccd_write_access = p_diagnostics_service_init->bl_cccd_wr_sec;
+    add_char_params.read_access       = p_diagnostics_service_init->bl_rd_sec;
+
+    return characteristic_add(m_diagnostics_service.service_handle,
+                              &add_char_params,
+                              &(m_diagnostics_service.rejected_samples_handles));
+}
+
+/**@brief Function for adding the zero tracking correction characteristic.
+ *
+ * @param[in]   p_diagnostics_service_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static ret_code_t diagnostics_service_zero_tracking_char_add(const diagnostics_service_init_t * p_diagnostics_service_init)
+{
+    ble_add_char_params_t  add_char_params;
+    float                  initial_correction = 0.0f;
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid              = DIAGNOSTICS_SERVICE_ZERO_TRACKING_CHAR_UUID;
+    add_char_params.uuid_type         = m_diagnostics_service.uuid_type;
+    add_char_params.max_len           = sizeof(float);
+    add_char_params.init_len          = sizeof(float);
+    add_char_params.p_init_value      = (uint8_t*)&initial_correction;
+    add_char_params.char_props.notify = m_diagnostics_service.is_notification_supported;
+    add_char_params.char_props.read   = 1;
+    add_char_params.cccd_write_access = p_diagnostics_service_init->bl_cccd_wr_sec;
+    add_char_params.read_access       = p_diagnostics_service_init->bl_rd_sec;
+
+    return characteristic_add(m_diagnostics_service.service_handle,
+                              &add_char_params,
+                              &(m_diagnostics_service.zero_tracking_handles));
+}
+
+/**@brief Function for adding the compensation learning characteristic.
+ *
+ * @param[in]   p_diagnostics_service_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static ret_code_t diagnostics_service_compensation_learning_char_add(const diagnostics_service_init_t * p_diagnostics_service_init)
+{
+    ble_add_char_params_t  add_char_params;
+    uint8_t                initial_result = 0;
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid              = DIAGNOSTICS_SERVICE_COMPENSATION_LEARNING_CHAR_UUID;
+    add_char_params.uuid_type         = m_diagnostics_service.uuid_type;
+    add_char_params.max_len           = sizeof(uint8_t);
+    add_char_params.init_len          = sizeof(uint8_t);
+    add_char_params.p_init_value      = &initial_result;
+    add_char_params.char_props.notify = m_diagnostics_service.is_notification_supported;
+    add_char_params.char_props.read   = 1;
+    add_char_params.char_props.write  = 1;
+    add_char_params.cccd_write_access = p_diagnostics_service_init->bl_cccd_wr_sec;
+    add_char_params.read_access       = p_diagnostics_service_init->bl_rd_sec;
+    add_char_params.write_access      = SEC_OPEN;
+
+    return characteristic_add(m_diagnostics_service.service_handle,
+                              &add_char_params,
+                              &(m_diagnostics_service.compensation_learning_handles));
+}
+
+/**@brief Function for adding the sample queue characteristic.
+ *
+ * @param[in]   p_diagnostics_service_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static ret_code_t diagnostics_service_sample_queue_char_add(const diagnostics_service_init_t * p_diagnostics_service_init)
+{
+    ble_add_char_params_t  add_char_params;
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid              = DIAGNOSTICS_SERVICE_SAMPLE_QUEUE_CHAR_UUID;
+    add_char_params.uuid_type         = m_diagnostics_service.uuid_type;
+    add_char_params.max_len           = sizeof(diagnostics_sample_queue_t);
+    add_char_params.init_len          = sizeof(diagnostics_sample_queue_t);
+    add_char_params.p_init_value      = (uint8_t*)&m_diagnostics_service.sample_queue_last;
+    add_char_params.char_props.notify = m_diagnostics_service.is_notification_supported;
+    add_char_params.char_props.read   = 1;
+    add_char_params.cccd_write_access = p_diagnostics_service_init->bl_cccd_wr_sec;
+    add_char_params.read_access       = p_diagnostics_service_init->bl_rd_sec;
+
+    return characteristic_add(m_diagnostics_service.service_handle,
+                              &add_char_params,
+                              &(m_diagnostics_service.sample_queue_handles));
+}
+
+/**@brief Function for adding the tare characteristic.
+ *
+ * @param[in]   p_diagnostics_service_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static ret_code_t diagnostics_service_tare_char_add(const diagnostics_service_init_t * p_diagnostics_service_init)
+{
+    ble_add_char_params_t  add_char_params;
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid              = DIAGNOSTICS_SERVICE_TARE_CHAR_UUID;
+    add_char_params.uuid_type         = m_diagnostics_service.uuid_type;
+    add_char_params.max_len           = sizeof(diagnostics_tare_t);
+    add_char_params.init_len          = sizeof(diagnostics_tare_t);
+    add_char_params.p_init_value      = (uint8_t*)&m_diagnostics_service.tare_last;
+    add_char_params.char_props.notify = m_diagnostics_service.is_notification_supported;
+    add_char_params.char_props.read   = 1;
+    add_char_params.cccd_write_access = p_diagnostics_service_init->bl_cccd_wr_sec;
+    add_char_params.read_access       = p_diagnostics_service_init->bl_rd_sec;
+
+    return characteristic_add(m_diagnostics_service.service_handle,
+                              &add_char_params,
+                              &(m_diagnostics_service.tare_handles));
+}
+
+/**@brief Function for adding the flow fit quality characteristic.
+ *
+ * @param[in]   p_diagnostics_service_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static ret_code_t diagnostics_service_flow_fit_quality_char_add(const diagnostics_service_init_t * p_diagnostics_service_init)
+{
+    ble_add_char_params_t  add_char_params;
+    float                  initial_quality = 0.0f;
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid              = DIAGNOSTICS_SERVICE_FLOW_FIT_QUALITY_CHAR_UUID;
+    add_char_params.uuid_type         = m_diagnostics_service.uuid_type;
+    add_char_params.max_len           = sizeof(float);
+    add_char_params.init_len          = sizeof(float);
+    add_char_params.p_init_value      = (uint8_t*)&initial_quality;
+    add_char_params.char_props.notify = m_diagnostics_service.is_notification_supported;
+    add_char_params.char_props.read   = 1;
+    add_char_params.cccd_write_access = p_diagnostics_service_init->bl_cccd_wr_sec;
+    add_char_params.read_access       = p_diagnostics_service_init->bl_rd_sec;
+
+    return characteristic_add(m_diagnostics_service.service_handle,
+                              &add_char_params,
+                              &(m_diagnostics_service.flow_fit_quality_handles));
+}
+
+/**@brief Function for adding the pipeline characteristic.
+ *
+ * @param[in]   p_diagnostics_service_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static ret_code_t diagnostics_service_pipeline_char_add(const diagnostics_service_init_t * p_diagnostics_service_init)
+{
+    ble_add_char_params_t  add_char_params;
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid              = DIAGNOSTICS_SERVICE_PIPELINE_CHAR_UUID;
+    add_char_params.uuid_type         = m_diagnostics_service.uuid_type;
+    add_char_params.max_len           = sizeof(diagnostics_pipeline_t);
+    add_char_params.init_len          = sizeof(diagnostics_pipeline_t);
+    add_char_params.p_init_value      = (uint8_t*)&m_diagnostics_service.pipeline_last;
+    add_char_params.char_props.notify = m_diagnostics_service.is_notification_supported;
+    add_char_params.char_props.read   = 1;
+    add_char_params.char_props.write  = 1;
+    add_char_params.cccd_write_access = p_diagnostics_service_init->bl_cccd_wr_sec;
+    add_char_params.read_access       = p_diagnostics_service_init->bl_rd_sec;
+    add_char_params.write_access      = SEC_OPEN;
+
+    return characteristic_add(m_diagnostics_service.service_handle,
+                              &add_char_params,
+                              &(m_diagnostics_service.pipeline_handles));
+}
+
 ret_code_t diagnostics_service_init()
 {
     // Initialize Diagnostics Service.
@@ -168,7 +455,7 @@ ret_code_t diagnostics_service_init()
     diagnostics_service_init.evt_handler          = NULL;
     diagnostics_service_init.support_notification = true;
     diagnostics_service_init.p_report_ref         = NULL;
-    diagnostics_service_init.initial_filter_output_coefficient_value   = 0.5;
+    diagnostics_service_init.initial_filter_cutoff_value   = 6.0;
 
 
     ret_code_t err_code;
@@ -177,7 +464,7 @@ ret_code_t diagnostics_service_init()
     // Initialize service structure
     m_diagnostics_service.evt_handler               = diagnostics_service_init.evt_handler;
     m_diagnostics_service.is_notification_supported = diagnostics_service_init.support_notification;
-    m_diagnostics_service.weight_filter_output_coefficient_last        = 0.5;
+    m_diagnostics_service.weight_filter_cutoff_last        = diagnostics_service_init.initial_filter_cutoff_value;
 
     // Add service
     //BLE_UUID_BLE_ASSIGN(ble_uuid, DIAGNOSTICS_SERVICE_SERVICE_UUID);
@@ -192,8 +479,80 @@ ret_code_t diagnostics_service_init()
     err_code = sd_ble_gatts_service_add(BLE_GATTS_SRVC_TYPE_PRIMARY, &ble_uuid, &m_diagnostics_service.service_handle);
     VERIFY_SUCCESS(err_code);
 
-    // Add weight filter output coefficient characteristic
-    err_code = diagnostics_service_weight_filter_output_coefficient_char_add(&diagnostics_service_init);
+    // Add weight filter cutoff characteristic
+    err_code = diagnostics_service_weight_filter_cutoff_char_add(&diagnostics_service_init);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add raw capture characteristic
+    m_diagnostics_service.raw_capture_conn_handle = BLE_CONN_HANDLE_INVALID;
+
+    err_code = diagnostics_service_raw_capture_char_add(&diagnostics_service_init);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add rejected samples characteristic
+    m_diagnostics_service.rejected_samples_last = 0;
+
+    err_code = diagnostics_service_rejected_samples_char_add(&diagnostics_service_init);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add zero tracking correction characteristic
+    m_diagnostics_service.zero_tracking_last = 0.0f;
+
+    err_code = diagnostics_service_zero_tracking_char_add(&diagnostics_service_init);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add compensation learning characteristic
+    m_diagnostics_service.compensation_learning_result = 0;
+
+    err_code = diagnostics_service_compensation_learning_char_add(&diagnostics_service_init);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add sample queue characteristic
+    memset(&m_diagnostics_service.sample_queue_last, 0, sizeof(m_diagnostics_service.sample_queue_last));
+
+    err_code = diagnostics_service_sample_queue_char_add(&diagnostics_service_init);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add tare characteristic
+    memset(&m_diagnostics_service.tare_last, 0, sizeof(m_diagnostics_service.tare_last));
+
+    err_code = diagnostics_service_tare_char_add(&diagnostics_service_init);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add flow fit quality characteristic
+    m_diagnostics_service.flow_fit_quality_last = 0.0f;
+
+    err_code = diagnostics_service_flow_fit_quality_char_add(&diagnostics_service_init);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add pipeline characteristic
+    memset(&m_diagnostics_service.pipeline_last, 0, sizeof(m_diagnostics_service.pipeline_last));
+
+    err_code = diagnostics_service_pipeline_char_add(&diagnostics_service_init);
     if (err_code != NRF_SUCCESS)
     {
         return err_code;
@@ -226,85 +585,193 @@ static ret_code_t diagnostics_service_notification_send(ble_gatts_hvx_params_t *
     return err_code;
 }
 
-ret_code_t diagnostics_service_weight_filter_output_coefficient_update(float coefficient, uint16_t conn_handle)
+/**@brief Function for setting a characteristic value and notifying it to the connected clients.
+ *
+ * @param[in]   value_handle Value handle of the characteristic.
+ * @param[in]   p_value      New value.
+ * @param[in]   len          Length of the new value.
+ * @param[in]   conn_handle  Connection handle, or BLE_CONN_HANDLE_ALL.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static ret_code_t diagnostics_service_value_update(uint16_t value_handle, uint8_t * p_value, uint16_t len, uint16_t conn_handle)
 {
     ret_code_t         err_code = NRF_SUCCESS;
     ble_gatts_value_t  gatts_value;
 
-    if (coefficient != m_diagnostics_service.weight_filter_output_coefficient_last)
-    {
-        // Initialize value struct.
-        memset(&gatts_value, 0, sizeof(gatts_value));
+    // Initialize value struct.
+    memset(&gatts_value, 0, sizeof(gatts_value));
 
-        gatts_value.len     = sizeof(uint16_t);
-        gatts_value.offset  = 0;
-        gatts_value.p_value = (uint8_t*)&coefficient;
+    gatts_value.len     = len;
+    gatts_value.offset  = 0;
+    gatts_value.p_value = p_value;
 
-        // Update database.
-        err_code = sd_ble_gatts_value_set(BLE_CONN_HANDLE_INVALID,
-                                          m_diagnostics_service.weight_filter_output_coefficient_handles.value_handle,
-                                          &gatts_value);
-        if (err_code == NRF_SUCCESS)
-        {
-            // Save new output coefficient value.
-            m_diagnostics_service.weight_filter_output_coefficient_last = coefficient;
-        }
-        else
-        {
-            NRF_LOG_DEBUG("Error during weight filter output coefficient update: 0x%08X", err_code)
+    // Update database.
+    err_code = sd_ble_gatts_value_set(BLE_CONN_HANDLE_INVALID, value_handle, &gatts_value);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_DEBUG("Error during diagnostics value update: 0x%08X", err_code)
 
-            return err_code;
-        }
+        return err_code;
+    }
 
-        // Send value if connected and notifying.
-        if (m_diagnostics_service.is_notification_supported)
-        {
-            ble_gatts_hvx_params_t hvx_params;
+    // Send value if connected and notifying.
+    if (m_diagnostics_service.is_notification_supported)
+    {
+        ble_gatts_hvx_params_t hvx_params;
+
+        memset(&hvx_params, 0, sizeof(hvx_params));
 
-            memset(&hvx_params, 0, sizeof(hvx_params));
+        hvx_params.handle = value_handle;
+        hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+        hvx_params.offset = gatts_value.offset;
+        hvx_params.p_len  = &gatts_value.len;
+        hvx_params.p_data = gatts_value.p_value;
 
-            hvx_params.handle = m_diagnostics_service.weight_filter_output_coefficient_handles.value_handle;
-            hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
-            hvx_params.offset = gatts_value.offset;
-            hvx_params.p_len  = &gatts_value.len;
-            hvx_params.p_data = gatts_value.p_value;
+        if (conn_handle == BLE_CONN_HANDLE_ALL)
+        {
+            ble_conn_state_conn_handle_list_t conn_handles = ble_conn_state_conn_handles();
 
-            if (conn_handle == BLE_CONN_HANDLE_ALL)
+            // Try sending notifications to all valid connection handles.
+            for (uint32_t i = 0; i < conn_handles.len; i++)
             {
-                ble_conn_state_conn_handle_list_t conn_handles = ble_conn_state_conn_handles();
-
-                // Try sending notifications to all valid connection handles.
-                for (uint32_t i = 0; i < conn_handles.len; i++)
+                if (ble_conn_state_status(conn_handles.conn_handles[i]) == BLE_CONN_STATUS_CONNECTED)
                 {
-                    if (ble_conn_state_status(conn_handles.conn_handles[i]) == BLE_CONN_STATUS_CONNECTED)
+                    if (err_code == NRF_SUCCESS)
                     {
-                        if (err_code == NRF_SUCCESS)
-                        {
-                            err_code = diagnostics_service_notification_send(&hvx_params, conn_handles.conn_handles[i]);
-                        }
-                        else
-                        {
-                            // Preserve the first non-zero error code
-                            UNUSED_RETURN_VALUE(diagnostics_service_notification_send(&hvx_params, conn_handles.conn_handles[i]));
-                        }
+                        err_code = diagnostics_service_notification_send(&hvx_params, conn_handles.conn_handles[i]);
+                    }
+                    else
+                    {
+                        // Preserve the first non-zero error code
+                        UNUSED_RETURN_VALUE(diagnostics_service_notification_send(&hvx_params, conn_handles.conn_handles[i]));
                     }
                 }
             }
-            else
-            {
-                err_code = diagnostics_service_notification_send(&hvx_params, conn_handle);
-            }
         }
         else
         {
-            err_code = NRF_ERROR_INVALID_STATE;
+            err_code = diagnostics_service_notification_send(&hvx_params, conn_handle);
         }
     }
+    else
+    {
+        err_code = NRF_ERROR_INVALID_STATE;
+    }
 
     return err_code;
 }
 
-ret_code_t diagnostics_service_weight_filter_output_coefficient_on_reconnection_update(uint16_t    conn_handle)
+ret_code_t diagnostics_service_weight_filter_cutoff_update(float cutoff, uint16_t conn_handle)
+{
+    if (cutoff == m_diagnostics_service.weight_filter_cutoff_last)
+    {
+        return NRF_SUCCESS;
+    }
+
+    m_diagnostics_service.weight_filter_cutoff_last = cutoff;
+
+    return diagnostics_service_value_update(m_diagnostics_service.weight_filter_cutoff_handles.value_handle,
+                                            (uint8_t*)&m_diagnostics_service.weight_filter_cutoff_last,
+                                            sizeof(float),
+                                            conn_handle);
+}
+
+ret_code_t diagnostics_service_rejected_samples_update(uint32_t rejectedSamples, uint16_t conn_handle)
+{
+    if (rejectedSamples == m_diagnostics_service.rejected_samples_last)
+    {
+        return NRF_SUCCESS;
+    }
+
+    m_diagnostics_service.rejected_samples_last = rejectedSamples;
+
+    return diagnostics_service_value_update(m_diagnostics_service.rejected_samples_handles.value_handle,
+                                            (uint8_t*)&m_diagnostics_service.rejected_samples_last,
+                                            sizeof(uint32_t),
+                                            conn_handle);
+}
+
+ret_code_t diagnostics_service_zero_tracking_update(float correction, uint16_t conn_handle)
+{
+    if (correction == m_diagnostics_service.zero_tracking_last)
+    {
+        return NRF_SUCCESS;
+    }
+
+    m_diagnostics_service.zero_tracking_last = correction;
+
+    return diagnostics_service_value_update(m_diagnostics_service.zero_tracking_handles.value_handle,
+                                            (uint8_t*)&m_diagnostics_service.zero_tracking_last,
+                                            sizeof(float),
+                                            conn_handle);
+}
+
+ret_code_t diagnostics_service_sample_queue_update(uint32_t overruns, uint32_t highWatermark, uint16_t conn_handle)
+{
+    if (overruns == m_diagnostics_service.sample_queue_last.overruns &&
+        highWatermark == m_diagnostics_service.sample_queue_last.high_watermark)
+    {
+        return NRF_SUCCESS;
+    }
+
+    m_diagnostics_service.sample_queue_last.overruns = overruns;
+    m_diagnostics_service.sample_queue_last.high_watermark = highWatermark;
+
+    return diagnostics_service_value_update(m_diagnostics_service.sample_queue_handles.value_handle,
+                                            (uint8_t*)&m_diagnostics_service.sample_queue_last,
+                                            sizeof(diagnostics_sample_queue_t),
+                                            conn_handle);
+}
+
+ret_code_t diagnostics_service_flow_fit_quality_update(float quality, uint16_t conn_handle)
+{
+    if (quality == m_diagnostics_service.flow_fit_quality_last)
+    {
+        return NRF_SUCCESS;
+    }
+
+    m_diagnostics_service.flow_fit_quality_last = quality;
+
+    return diagnostics_service_value_update(m_diagnostics_service.flow_fit_quality_handles.value_handle,
+                                            (uint8_t*)&m_diagnostics_service.flow_fit_quality_last,
+                                            sizeof(float),
+                                            conn_handle);
+}
+
+ret_code_t diagnostics_service_pipeline_update(const diagnostics_pipeline_t *pipeline, uint16_t conn_handle)
+{
+    if (memcmp(pipeline, &m_diagnostics_service.pipeline_last, sizeof(diagnostics_pipeline_t)) == 0)
+    {
+        return NRF_SUCCESS;
+    }
+
+    m_diagnostics_service.pipeline_last = *pipeline;
+
+    return diagnostics_service_value_update(m_diagnostics_service.pipeline_handles.value_handle,
+                                            (uint8_t*)&m_diagnostics_service.pipeline_last,
+                                            sizeof(diagnostics_pipeline_t),
+                                            conn_handle);
+}
+
+void diagnostics_service_pipeline_received_callback(void (*func)(const diagnostics_pipeline_t *pipeline))
+{
+    mPipelineReceivedCallback = func;
+}
+
+ret_code_t diagnostics_service_tare_update(uint32_t latencyMs, uint16_t attempts, uint16_t conn_handle)
+{
+    // Always notified, consecutive tares can take the same time
+    m_diagnostics_service.tare_last.latency_ms = latencyMs;
+    m_diagnostics_service.tare_last.attempts = attempts;
+
+    return diagnostics_service_value_update(m_diagnostics_service.tare_handles.value_handle,
+                                            (uint8_t*)&m_diagnostics_service.tare_last,
+                                            sizeof(diagnostics_tare_t),
+                                            conn_handle);
+}
+
+ret_code_t diagnostics_service_weight_filter_cutoff_on_reconnection_update(uint16_t    conn_handle)
 {
     ret_code_t err_code;
 
@@ -315,11 +782,11 @@ ret_code_t diagnostics_service_weight_filter_output_coefficient_on_reconnection_
 
         memset(&hvx_params, 0, sizeof(hvx_params));
 
-        hvx_params.handle = m_diagnostics_service.weight_filter_output_coefficient_handles.value_handle;
+        hvx_params.handle = m_diagnostics_service.weight_filter_cutoff_handles.value_handle;
         hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
         hvx_params.offset = 0;
         hvx_params.p_len  = &len;
-        hvx_params.p_data = (uint8_t*)&m_diagnostics_service.weight_filter_output_coefficient_last;
+        hvx_params.p_data = (uint8_t*)&m_diagnostics_service.weight_filter_cutoff_last;
 
         err_code = diagnostics_service_notification_send(&hvx_params, conn_handle);
 
@@ -329,7 +796,117 @@ ret_code_t diagnostics_service_weight_filter_output_coefficient_on_reconnection_
     return NRF_ERROR_INVALID_STATE;
 }
 
-void diagnostics_service_weight_filter_output_coefficient_received_callback(void (*func)(float coefficient ))
+void diagnostics_service_weight_filter_cutoff_received_callback(void (*func)(float cutoff))
+{
+    mWeightFilterCutoffReceivedCallback = func;
+}
+
+void diagnostics_service_compensation_learning_received_callback(void (*func)(uint8_t command))
+{
+    mCompensationLearningReceivedCallback = func;
+}
+
+ret_code_t diagnostics_service_compensation_learning_result_update(uint8_t result, uint16_t conn_handle)
+{
+    // Always notified, the same result can end consecutive steps
+    m_diagnostics_service.compensation_learning_result = result;
+
+    return diagnostics_service_value_update(m_diagnostics_service.compensation_learning_handles.value_handle,
+                                            &m_diagnostics_service.compensation_learning_result,
+                                            sizeof(uint8_t),
+                                            conn_handle);
+}
+
+// Send queued raw capture packets until the SoftDevice runs out of notification buffers
+static void diagnostics_service_raw_capture_flush()
+{
+    while (mRawCaptureQueueCount > 0)
+    {
+        uint16_t               len = DIAGNOSTICS_RAW_CAPTURE_PACKET_SIZE;
+        ble_gatts_hvx_params_t hvx_params;
+
+        memset(&hvx_params, 0, sizeof(hvx_params));
+
+        hvx_params.handle = m_diagnostics_service.raw_capture_handles.value_handle;
+        hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+        hvx_params.offset = 0;
+        hvx_params.p_len  = &len;
+        hvx_params.p_data = mRawCaptureQueue[mRawCaptureQueueHead];
+
+        ret_code_t err_code = sd_ble_gatts_hvx(m_diagnostics_service.raw_capture_conn_handle, &hvx_params);
+
+        if (err_code == NRF_ERROR_RESOURCES)
+        {
+            // Try again on the next code
+            return;
+        }
+
+        if (err_code != NRF_SUCCESS)
+        {
+            NRF_LOG_DEBUG("Error: 0x%08X while sending raw capture", err_code);
+        }
+
+        mRawCaptureQueueHead = (mRawCaptureQueueHead + 1) % DIAGNOSTICS_RAW_CAPTURE_QUEUE_LENGTH;
+        mRawCaptureQueueCount--;
+    }
+}
+
+static void diagnostics_service_raw_capture_queue_packet()
+{
+    if (mRawCaptureQueueCount == DIAGNOSTICS_RAW_CAPTURE_QUEUE_LENGTH)
+    {
+        // The gap in sequence numbers shows the client where codes were lost
+        mRawCaptureDroppedPackets++;
+        return;
+    }
+
+    uint8_t tail = (mRawCaptureQueueHead + mRawCaptureQueueCount) % DIAGNOSTICS_RAW_CAPTURE_QUEUE_LENGTH;
+    memcpy(mRawCaptureQueue[tail], mRawCapturePacket, DIAGNOSTICS_RAW_CAPTURE_PACKET_SIZE);
+    mRawCaptureQueueCount++;
+}
+
+void diagnostics_service_raw_capture_add(int32_t rawValue)
+{
+    if (!mRawCaptureEnabled)
+    {
+        return;
+    }
+
+    if (mRawCaptureRestart)
+    {
+        mRawCaptureRestart = false;
+        mRawCaptureQueueCount = 0;
+        mRawCapturePacketCodes = 0;
+        mRawCaptureSequence = 0;
+    }
+
+    if (mRawCapturePacketCodes == 0)
+    {
+        mRawCapturePacket[0] = (uint8_t)(mRawCaptureSequence);
+        mRawCapturePacket[1] = (uint8_t)(mRawCaptureSequence >> 8);
+        mRawCaptureSequence++;
+    }
+
+    uint8_t *code = &mRawCapturePacket[DIAGNOSTICS_RAW_CAPTURE_SEQUENCE_BYTES + mRawCapturePacketCodes * DIAGNOSTICS_RAW_CAPTURE_CODE_BYTES];
+    code[0] = (uint8_t)(rawValue);
+    code[1] = (uint8_t)(rawValue >> 8);
+    code[2] = (uint8_t)(rawValue >> 16);
+
+    if (++mRawCapturePacketCodes == DIAGNOSTICS_RAW_CAPTURE_CODES_PER_PACKET)
+    {
+        diagnostics_service_raw_capture_queue_packet();
+        mRawCapturePacketCodes = 0;
+    }
+
+    diagnostics_service_raw_capture_flush();
+}
+
+bool diagnostics_service_raw_capture_enabled()
+{
+    return mRawCaptureEnabled;
+}
+
+uint32_t diagnostics_service_raw_capture_dropped_packets()
 {
-    mWeightFilterOutputCoefficientReceivedCallback = func;
+    return mRawCaptureDroppedPackets;
 }
@@ -27,7 +27,55 @@ extern "C" {
 #define DIAGNOSTICS_SERVICE_UUID_BASE {0x1a, 0xc5, 0x1b, 0x8e, 0xa3, 0x06, 0x75, 0xb0, 0x45, 0x41, 0xf4, 0x67, 0xdc, 0x2b, 0xfc, 0x2b}
 
 #define DIAGNOSTICS_SERVICE_SERVICE_UUID                    0x1400
-#define DIAGNOSTICS_SERVICE_WEIGHT_FILTER_OUTPUT_COEFFICIENT_CHAR_UUID          0x1401
+#define DIAGNOSTICS_SERVICE_WEIGHT_FILTER_CUTOFF_CHAR_UUID                      0x1403
+#define DIAGNOSTICS_SERVICE_RAW_CAPTURE_CHAR_UUID                               0x1402
+#define DIAGNOSTICS_SERVICE_REJECTED_SAMPLES_CHAR_UUID                          0x1404
+#define DIAGNOSTICS_SERVICE_ZERO_TRACKING_CHAR_UUID                             0x1405
+#define DIAGNOSTICS_SERVICE_COMPENSATION_LEARNING_CHAR_UUID                     0x1406
+#define DIAGNOSTICS_SERVICE_SAMPLE_QUEUE_CHAR_UUID                              0x1407
+#define DIAGNOSTICS_SERVICE_TARE_CHAR_UUID                                      0x1408
+#define DIAGNOSTICS_SERVICE_FLOW_FIT_QUALITY_CHAR_UUID                          0x1409
+#define DIAGNOSTICS_SERVICE_PIPELINE_CHAR_UUID                                  0x140A
+
+// Compensation learning commands written to the compensation learning characteristic. The result of the
+// step is notified back on the same characteristic
+#define DIAGNOSTICS_COMPENSATION_LEARNING_FINISH            0
+#define DIAGNOSTICS_COMPENSATION_LEARNING_OFFSET_TEMPCO     1
+#define DIAGNOSTICS_COMPENSATION_LEARNING_SPAN_TEMPCO       2
+#define DIAGNOSTICS_COMPENSATION_LEARNING_CREEP             3
+
+// Raw capture notifications carry a little endian packet sequence number followed by as many
+// 3 byte little endian ADS123X codes as fit in the ATT payload
+#define DIAGNOSTICS_RAW_CAPTURE_SEQUENCE_BYTES      2
+#define DIAGNOSTICS_RAW_CAPTURE_CODE_BYTES          3
+#define DIAGNOSTICS_RAW_CAPTURE_CODES_PER_PACKET    ((NRF_SDH_BLE_GATT_MAX_MTU_SIZE - 3 - DIAGNOSTICS_RAW_CAPTURE_SEQUENCE_BYTES) / DIAGNOSTICS_RAW_CAPTURE_CODE_BYTES)
+#define DIAGNOSTICS_RAW_CAPTURE_PACKET_SIZE         (DIAGNOSTICS_RAW_CAPTURE_SEQUENCE_BYTES + DIAGNOSTICS_RAW_CAPTURE_CODES_PER_PACKET * DIAGNOSTICS_RAW_CAPTURE_CODE_BYTES)
+
+// Packets held while the SoftDevice notification queue is full
+#define DIAGNOSTICS_RAW_CAPTURE_QUEUE_LENGTH        8
+
+// Weight sensor sample queue health as read from the sample queue characteristic, little endian
+typedef struct __attribute__((packed))
+{
+    uint32_t overruns;          // conversions dropped because the queue was full
+    uint32_t high_watermark;    // most conversions waiting at once
+} diagnostics_sample_queue_t;
+
+// Last successful tare as read from the tare characteristic, little endian
+typedef struct __attribute__((packed))
+{
+    uint32_t latency_ms;        // from the request to the new zero
+    uint16_t attempts;          // averages needed, 0 if taken from conversions that had already settled
+} diagnostics_tare_t;
+
+// Weight sensor pipeline written to and read from the pipeline characteristic, little endian. The noise values
+// tune the Kalman pipeline whichever pipeline is selected
+typedef struct __attribute__((packed))
+{
+    uint8_t pipeline;           // a weight_sensor_pipeline_t
+    float process_noise;        // (g/s^2)^2/Hz
+    float measurement_noise;    // g^2
+} diagnostics_pipeline_t;
 
 
 /**@brief Macro for defining a ble_bas instance.
@@ -70,8 +118,8 @@ typedef struct
 {
     diagnostics_service_evt_handler_t  evt_handler;                 /**< Event handler to be called for handling events in the Diagnostics Service. */
     bool                   support_notification;                    /**< TRUE if notification of Diagnostics Level measurement is supported. */
-    ble_srv_report_ref_t * p_report_ref;                            /**< If not NULL, a Report Reference descriptor with the specified value will be added to the weight filter output coefficient characteristic */
-    float               initial_filter_output_coefficient_value;    /**< Initial filter output coefficient */
+    ble_srv_report_ref_t * p_report_ref;                            /**< If not NULL, a Report Reference descriptor with the specified value will be added to the weight filter cutoff characteristic */
+    float               initial_filter_cutoff_value;                /**< Initial weight filter cutoff in Hz */
     security_req_t         bl_rd_sec;                               /**< Security requirement for reading the BL characteristic value. */
     security_req_t         bl_cccd_wr_sec;                          /**< Security requirement for writing the BL characteristic CCCD. */
     security_req_t         bl_report_rd_sec;                        /**< Security requirement for reading the BL characteristic descriptor. */
@@ -82,9 +130,25 @@ struct diagnostics_service_s
 {
     diagnostics_service_evt_handler_t   evt_handler;                            /**< Event handler to be called for handling events in the Diagnostics Service. */
     uint16_t                            service_handle;                         /**< Handle of Diagnostics Service (as provided by the BLE stack). */
-    ble_gatts_char_handles_t            weight_filter_output_coefficient_handles;/**< Handles related to the Diagnostics Level characteristic. */
+    ble_gatts_char_handles_t            weight_filter_cutoff_handles;           /**< Handles related to the weight filter cutoff characteristic. */
+    ble_gatts_char_handles_t            raw_capture_handles;                    /**< Handles related to the raw capture characteristic. */
+    uint16_t                            raw_capture_conn_handle;                /**< Connection that enabled raw capture notifications. */
+    ble_gatts_char_handles_t            rejected_samples_handles;               /**< Handles related to the rejected samples characteristic. */
+    uint32_t                            rejected_samples_last;                  /**< Last rejected sample count passed to the Diagnostics Service. */
+    ble_gatts_char_handles_t            zero_tracking_handles;                  /**< Handles related to the zero tracking correction characteristic. */
+    float                               zero_tracking_last;                     /**< Last zero tracking correction passed to the Diagnostics Service. */
+    ble_gatts_char_handles_t            compensation_learning_handles;          /**< Handles related to the compensation learning characteristic. */
+    uint8_t                             compensation_learning_result;           /**< Result of the last compensation learning step. */
+    ble_gatts_char_handles_t            sample_queue_handles;                   /**< Handles related to the sample queue characteristic. */
+    diagnostics_sample_queue_t          sample_queue_last;                      /**< Last sample queue state passed to the Diagnostics Service. */
+    ble_gatts_char_handles_t            tare_handles;                           /**< Handles related to the tare characteristic. */
+    diagnostics_tare_t                  tare_last;                              /**< Last tare passed to the Diagnostics Service. */
+    ble_gatts_char_handles_t            flow_fit_quality_handles;               /**< Handles related to the flow fit quality characteristic. */
+    float                               flow_fit_quality_last;                  /**< Last flow fit quality passed to the Diagnostics Service. */
+    ble_gatts_char_handles_t            pipeline_handles;                       /**< Handles related to the pipeline characteristic. */
+    diagnostics_pipeline_t              pipeline_last;                          /**< Last pipeline passed to the Diagnostics Service. */
     uint16_t                            report_ref_handle;                      /**< Handle of the Report Reference descriptor. */
-    float                               weight_filter_output_coefficient_last;         /**< Last Diagnostics Level measurement passed to the Diagnostics Service. */
+    float                               weight_filter_cutoff_last;              /**< Last weight filter cutoff passed to the Diagnostics Service. */
     bool                                is_notification_supported;              /**< TRUE if notification of Diagnostics Level is supported. */
     uint8_t                             uuid_type;
 };
@@ -108,13 +172,13 @@ ret_code_t diagnostics_service_init();
 void diagnostics_service_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
 
 
-ret_code_t diagnostics_service_weight_filter_output_coefficient_update(float coefficient, uint16_t conn_handle);
+ret_code_t diagnostics_service_weight_filter_cutoff_update(float cutoff, uint16_t conn_handle);
 
 
-/**@brief Function for sending the weight filter output coefficient when bonded client reconnects.
+/**@brief Function for sending the weight filter cutoff when bonded client reconnects.
  *
  * @details The application calls this function, in the case of a reconnection of
- *          a bonded client if the value of the weight filter output coefficient has changed since
+ *          a bonded client if the value of the weight filter cutoff has changed since
  *          its disconnection.
  *
  *
@@ -124,10 +188,123 @@ ret_code_t diagnostics_service_weight_filter_output_coefficient_update(float coe
  *              NRF_ERROR_INVALID_STATE when notification is not supported,
  *              otherwise an error code returned by @ref sd_ble_gatts_hvx.
  */
-ret_code_t diagnostics_service_weight_filter_output_coefficient_on_reconnection_update(uint16_t    conn_handle);
+ret_code_t diagnostics_service_weight_filter_cutoff_on_reconnection_update(uint16_t    conn_handle);
+
+
+void diagnostics_service_weight_filter_cutoff_received_callback(void (*func)(float cutoff));
+
+
+/**@brief Function for updating the count of weight sensor conversions rejected as outliers.
+ *
+ * @details The value is only set and notified when it has changed.
+ *
+ * @param[in]   rejectedSamples Conversions rejected since power up.
+ * @param[in]   conn_handle     Connection handle, or BLE_CONN_HANDLE_ALL.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t diagnostics_service_rejected_samples_update(uint32_t rejectedSamples, uint16_t conn_handle);
+
+
+/**@brief Function for updating the zero drift corrected by the weight sensor zero tracking.
+ *
+ * @details The value is only set and notified when it has changed.
+ *
+ * @param[in]   correction      Correction since the last tare in grams.
+ * @param[in]   conn_handle     Connection handle, or BLE_CONN_HANDLE_ALL.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t diagnostics_service_zero_tracking_update(float correction, uint16_t conn_handle);
+
+
+/**@brief Function for updating the weight sensor sample queue overruns and high watermark.
+ *
+ * @details The value is only set and notified when it has changed.
+ *
+ * @param[in]   overruns        Conversions dropped since power up.
+ * @param[in]   highWatermark   Most conversions waiting in the queue at once.
+ * @param[in]   conn_handle     Connection handle, or BLE_CONN_HANDLE_ALL.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t diagnostics_service_sample_queue_update(uint32_t overruns, uint32_t highWatermark, uint16_t conn_handle);
+
+
+/**@brief Function for notifying how long the last successful tare took.
+ *
+ * @param[in]   latencyMs       Time from the tare request to the new zero.
+ * @param[in]   attempts        Averages the tare needed, 0 if it used conversions that had already settled.
+ * @param[in]   conn_handle     Connection handle, or BLE_CONN_HANDLE_ALL.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t diagnostics_service_tare_update(uint32_t latencyMs, uint16_t attempts, uint16_t conn_handle);
+
+
+/**@brief Function for updating how well the least squares flow fit follows the weight.
+ *
+ * @details The value is only set and notified when it has changed.
+ *
+ * @param[in]   quality         R squared of the fit, 0 to 1.
+ * @param[in]   conn_handle     Connection handle, or BLE_CONN_HANDLE_ALL.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t diagnostics_service_flow_fit_quality_update(float quality, uint16_t conn_handle);
+
+
+/**@brief Function for updating the weight sensor pipeline and its Kalman tuning.
+ *
+ * @details The value is only set and notified when it has changed.
+ *
+ * @param[in]   pipeline        Pipeline in use and the Kalman noise values.
+ * @param[in]   conn_handle     Connection handle, or BLE_CONN_HANDLE_ALL.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t diagnostics_service_pipeline_update(const diagnostics_pipeline_t *pipeline, uint16_t conn_handle);
+
+
+/**@brief Function for setting the function called when a pipeline is written.
+ *
+ * @param[in]   func            Called from the BLE event handler with the pipeline written.
+ */
+void diagnostics_service_pipeline_received_callback(void (*func)(const diagnostics_pipeline_t *pipeline));
+
+
+/**@brief Function for setting the function called when a compensation learning command is written.
+ *
+ * @param[in]   func            Called with one of the DIAGNOSTICS_COMPENSATION_LEARNING_ commands.
+ */
+void diagnostics_service_compensation_learning_received_callback(void (*func)(uint8_t command));
+
+
+/**@brief Function for notifying the result of a compensation learning step.
+ *
+ * @param[in]   result          Result of the step, a weight_sensor_result_t.
+ * @param[in]   conn_handle     Connection handle, or BLE_CONN_HANDLE_ALL.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t diagnostics_service_compensation_learning_result_update(uint8_t result, uint16_t conn_handle);
+
+
+/**@brief Function for adding a raw ADS123X code to the raw capture stream.
+ *
+ * @details Codes are only captured while a client has notifications enabled on the raw capture
+ *          characteristic. Must be called from main context.
+ *
+ * @param[in]   rawValue    Sign extended 24-bit conversion code.
+ */
+void diagnostics_service_raw_capture_add(int32_t rawValue);
+
+
+bool diagnostics_service_raw_capture_enabled();
 
 
-void diagnostics_service_weight_filter_output_coefficient_received_callback(void (*func)(float coefficient ));
+/**@brief Number of raw capture packets dropped because the notification queue was full. */
+uint32_t diagnostics_service_raw_capture_dropped_packets();
 
 
 extern diagnostics_service_t m_diagnostics_service;
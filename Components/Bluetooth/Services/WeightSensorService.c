@@ -8,7 +8,7 @@
 #include "nrf_log_ctrl.h"
 
 void (*mTareCallback)(void) = NULL;
-void (*mCalibrationCallback)(void) = NULL;
+void (*mCalibrationCallback)(uint8_t command, float referenceMass) = NULL;
 void (*mCoffeeToWaterRatioCallback)(uint16_t requestValue) = NULL;
 void (*mWeighModeCallback)(uint8_t requestValue) = NULL;
 void (*mSetCoffeeWeightCallback)(void) = NULL;
@@ -22,6 +22,9 @@ static uint32_t weight_sensor_coffee_to_water_ratio_char_add(ble_weight_sensor_s
 static uint32_t weight_sensor_weigh_mode_char_add(ble_weight_sensor_service_t * p_weight_sensor_service, const ble_weight_sensor_service_init_t * p_ble_weight_sensor_service_init);
 static uint32_t weight_sensor_set_coffee_weight_char_add(ble_weight_sensor_service_t * p_weight_sensor_service, const ble_weight_sensor_service_init_t * p_ble_weight_sensor_service_init);
 static uint32_t weight_sensor_water_weight_char_add(ble_weight_sensor_service_t * p_weight_sensor_service, const ble_weight_sensor_service_init_t * p_ble_weight_sensor_service_init);
+static uint32_t weight_sensor_pour_stop_char_add(ble_weight_sensor_service_t * p_weight_sensor_service, const ble_weight_sensor_service_init_t * p_ble_weight_sensor_service_init);
+static uint32_t weight_sensor_brew_phase_char_add(ble_weight_sensor_service_t * p_weight_sensor_service, const ble_weight_sensor_service_init_t * p_ble_weight_sensor_service_init);
+static uint32_t weight_sensor_shot_result_char_add(ble_weight_sensor_service_t * p_weight_sensor_service, const ble_weight_sensor_service_init_t * p_ble_weight_sensor_service_init);
 
 
 BLE_WEIGHT_SENSOR_DEF(m_weight_sensor);
@@ -108,6 +111,24 @@ uint32_t ble_weight_sensor_service_init()
         return err_code;
     }
 
+    err_code =  weight_sensor_pour_stop_char_add(&m_weight_sensor, &weight_sensor_service_init);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    err_code =  weight_sensor_brew_phase_char_add(&m_weight_sensor, &weight_sensor_service_init);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    err_code =  weight_sensor_shot_result_char_add(&m_weight_sensor, &weight_sensor_service_init);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
     return NRF_SUCCESS;
 }    
 
@@ -298,7 +319,7 @@ uint32_t weight_sensor_calibration_char_add(ble_weight_sensor_service_t * p_weig
     attr_md.vloc       = BLE_GATTS_VLOC_STACK;
     attr_md.rd_auth    = 0;
     attr_md.wr_auth    = 0;
-    attr_md.vlen       = 0;
+    attr_md.vlen       = 1;
 
     ble_uuid.type = m_weight_sensor.uuid_type;
 
@@ -314,7 +335,7 @@ uint32_t weight_sensor_calibration_char_add(ble_weight_sensor_service_t * p_weig
     uint8_t resetValue = 0;        
     attr_char_value.p_value   = (uint8_t*)&resetValue; // Pointer to the initial value
 
-    attr_char_value.max_len   = 1*sizeof(uint8_t);
+    attr_char_value.max_len   = WEIGHT_SENSOR_CALIBRATION_MAX_LEN;
 
     err_code = sd_ble_gatts_characteristic_add(m_weight_sensor.service_handle, &char_md,
                                                &attr_char_value,
@@ -623,6 +644,225 @@ uint32_t weight_sensor_water_weight_char_add(ble_weight_sensor_service_t * p_wei
 
 }
 
+/**@brief Function for adding the pour stop characteristic.
+ *
+ * @param[in]   p_cus        Custom Service structure.
+ * @param[in]   p_cus_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+uint32_t weight_sensor_pour_stop_char_add(ble_weight_sensor_service_t * p_weight_sensor_service, const ble_weight_sensor_service_init_t * p_ble_weight_sensor_service_init)
+{
+    uint32_t            err_code;
+    ble_gatts_char_md_t char_md;
+    ble_gatts_attr_md_t cccd_md;
+    ble_gatts_attr_t    attr_char_value;
+    ble_uuid_t          ble_uuid;
+    ble_gatts_attr_md_t attr_md;
+
+    memset(&cccd_md, 0, sizeof(cccd_md));
+
+    // Read  operation on Cccd should be possible without authentication.
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.read_perm);
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.write_perm);
+    
+    cccd_md.vloc       = BLE_GATTS_VLOC_STACK;
+
+    memset(&char_md, 0, sizeof(char_md));
+
+    char_md.char_props.read   = 1;
+    char_md.char_props.write  = 0;
+    char_md.char_props.notify = 1; 
+    char_md.p_char_user_desc  = NULL;
+    char_md.p_char_pf         = NULL;
+    char_md.p_user_desc_md    = NULL;
+    char_md.p_cccd_md         = &cccd_md; 
+    char_md.p_sccd_md         = NULL;
+
+    memset(&attr_md, 0, sizeof(attr_md));
+
+    attr_md.read_perm  = p_ble_weight_sensor_service_init->weight_sensor_sensor_attr_md.read_perm;
+    attr_md.write_perm = p_ble_weight_sensor_service_init->weight_sensor_sensor_attr_md.write_perm;
+    attr_md.vloc       = BLE_GATTS_VLOC_STACK;
+    attr_md.rd_auth    = 0;
+    attr_md.wr_auth    = 0;
+    attr_md.vlen       = 0;
+
+    ble_uuid.type = m_weight_sensor.uuid_type;
+
+    ble_uuid.uuid = WEIGHT_SENSOR_POUR_STOP_CHAR_UUID;
+
+    memset(&attr_char_value, 0, sizeof(attr_char_value));
+
+    attr_char_value.p_uuid    = &ble_uuid;
+    attr_char_value.p_attr_md = &attr_md;
+    attr_char_value.init_len  = 1*sizeof(uint8_t);
+    attr_char_value.init_offs = 0;
+
+    uint8_t resetValue = 0;        
+    attr_char_value.p_value   = (uint8_t*)&resetValue; // Pointer to the initial value
+
+    attr_char_value.max_len   = 1*sizeof(uint8_t);
+
+    err_code = sd_ble_gatts_characteristic_add(m_weight_sensor.service_handle, &char_md,
+                                               &attr_char_value,
+                                               &m_weight_sensor.weight_sensor_pour_stop_handles);
+    
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    return NRF_SUCCESS;
+
+}
+
+/**@brief Function for adding the brew phase characteristic.
+ *
+ * @param[in]   p_cus        Custom Service structure.
+ * @param[in]   p_cus_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+uint32_t weight_sensor_brew_phase_char_add(ble_weight_sensor_service_t * p_weight_sensor_service, const ble_weight_sensor_service_init_t * p_ble_weight_sensor_service_init)
+{
+    uint32_t            err_code;
+    ble_gatts_char_md_t char_md;
+    ble_gatts_attr_md_t cccd_md;
+    ble_gatts_attr_t    attr_char_value;
+    ble_uuid_t          ble_uuid;
+    ble_gatts_attr_md_t attr_md;
+
+    memset(&cccd_md, 0, sizeof(cccd_md));
+
+    // Read  operation on Cccd should be possible without authentication.
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.read_perm);
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.write_perm);
+    
+    cccd_md.vloc       = BLE_GATTS_VLOC_STACK;
+
+    memset(&char_md, 0, sizeof(char_md));
+
+    char_md.char_props.read   = 1;
+    char_md.char_props.write  = 0;
+    char_md.char_props.notify = 1; 
+    char_md.p_char_user_desc  = NULL;
+    char_md.p_char_pf         = NULL;
+    char_md.p_user_desc_md    = NULL;
+    char_md.p_cccd_md         = &cccd_md; 
+    char_md.p_sccd_md         = NULL;
+
+    memset(&attr_md, 0, sizeof(attr_md));
+
+    attr_md.read_perm  = p_ble_weight_sensor_service_init->weight_sensor_sensor_attr_md.read_perm;
+    attr_md.write_perm = p_ble_weight_sensor_service_init->weight_sensor_sensor_attr_md.write_perm;
+    attr_md.vloc       = BLE_GATTS_VLOC_STACK;
+    attr_md.rd_auth    = 0;
+    attr_md.wr_auth    = 0;
+    attr_md.vlen       = 0;
+
+    ble_uuid.type = m_weight_sensor.uuid_type;
+
+    ble_uuid.uuid = WEIGHT_SENSOR_BREW_PHASE_CHAR_UUID;
+
+    memset(&attr_char_value, 0, sizeof(attr_char_value));
+
+    attr_char_value.p_uuid    = &ble_uuid;
+    attr_char_value.p_attr_md = &attr_md;
+    attr_char_value.init_len  = WEIGHT_SENSOR_BREW_PHASE_LENGTH;
+    attr_char_value.init_offs = 0;
+
+    uint8_t resetValue[WEIGHT_SENSOR_BREW_PHASE_LENGTH] = {0};
+    attr_char_value.p_value   = resetValue; // Pointer to the initial value
+
+    attr_char_value.max_len   = WEIGHT_SENSOR_BREW_PHASE_LENGTH;
+
+    err_code = sd_ble_gatts_characteristic_add(m_weight_sensor.service_handle, &char_md,
+                                               &attr_char_value,
+                                               &m_weight_sensor.weight_sensor_brew_phase_handles);
+    
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    return NRF_SUCCESS;
+
+}
+
+/**@brief Function for adding the shot result characteristic.
+ *
+ * @param[in]   p_cus        Custom Service structure.
+ * @param[in]   p_cus_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+uint32_t weight_sensor_shot_result_char_add(ble_weight_sensor_service_t * p_weight_sensor_service, const ble_weight_sensor_service_init_t * p_ble_weight_sensor_service_init)
+{
+    uint32_t            err_code;
+    ble_gatts_char_md_t char_md;
+    ble_gatts_attr_md_t cccd_md;
+    ble_gatts_attr_t    attr_char_value;
+    ble_uuid_t          ble_uuid;
+    ble_gatts_attr_md_t attr_md;
+
+    memset(&cccd_md, 0, sizeof(cccd_md));
+
+    // Read  operation on Cccd should be possible without authentication.
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.read_perm);
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.write_perm);
+    
+    cccd_md.vloc       = BLE_GATTS_VLOC_STACK;
+
+    memset(&char_md, 0, sizeof(char_md));
+
+    char_md.char_props.read   = 1;
+    char_md.char_props.write  = 0;
+    char_md.char_props.notify = 1; 
+    char_md.p_char_user_desc  = NULL;
+    char_md.p_char_pf         = NULL;
+    char_md.p_user_desc_md    = NULL;
+    char_md.p_cccd_md         = &cccd_md; 
+    char_md.p_sccd_md         = NULL;
+
+    memset(&attr_md, 0, sizeof(attr_md));
+
+    attr_md.read_perm  = p_ble_weight_sensor_service_init->weight_sensor_sensor_attr_md.read_perm;
+    attr_md.write_perm = p_ble_weight_sensor_service_init->weight_sensor_sensor_attr_md.write_perm;
+    attr_md.vloc       = BLE_GATTS_VLOC_STACK;
+    attr_md.rd_auth    = 0;
+    attr_md.wr_auth    = 0;
+    attr_md.vlen       = 0;
+
+    ble_uuid.type = m_weight_sensor.uuid_type;
+
+    ble_uuid.uuid = WEIGHT_SENSOR_SHOT_RESULT_CHAR_UUID;
+
+    memset(&attr_char_value, 0, sizeof(attr_char_value));
+
+    attr_char_value.p_uuid    = &ble_uuid;
+    attr_char_value.p_attr_md = &attr_md;
+    attr_char_value.init_len  = WEIGHT_SENSOR_SHOT_RESULT_LENGTH;
+    attr_char_value.init_offs = 0;
+
+    uint8_t resetValue[WEIGHT_SENSOR_SHOT_RESULT_LENGTH] = {0};
+    attr_char_value.p_value   = resetValue; // Pointer to the initial value
+
+    attr_char_value.max_len   = WEIGHT_SENSOR_SHOT_RESULT_LENGTH;
+
+    err_code = sd_ble_gatts_characteristic_add(m_weight_sensor.service_handle, &char_md,
+                                               &attr_char_value,
+                                               &m_weight_sensor.weight_sensor_shot_result_handles);
+    
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    return NRF_SUCCESS;
+
+}
+
 void ble_weight_sensor_on_ble_evt( ble_evt_t const * p_ble_evt, void * p_context)
 {
     ble_weight_sensor_service_t * p_weight_sensor_service = (ble_weight_sensor_service_t *) p_context;
@@ -762,18 +1002,31 @@ static void ble_weight_sensor_on_write(ble_weight_sensor_service_t * p_weight_se
     }
 
     if ((p_evt_write->handle == m_weight_sensor.weight_sensor_calibration_handles.value_handle)
-        && (p_evt_write->len == 1)
+        && (p_evt_write->len == 1 || p_evt_write->len == WEIGHT_SENSOR_CALIBRATION_MAX_LEN)
        )
     {
+        float referenceMass = WEIGHT_SENSOR_CALIBRATION_DEFAULT_MASS;
+        bool referenceMassReceived = (p_evt_write->len == WEIGHT_SENSOR_CALIBRATION_MAX_LEN);
+
+        if (referenceMassReceived)
+        {
+            memcpy(&referenceMass, &p_evt_write->data[1], sizeof(referenceMass));
+        }
+
         switch (p_evt_write->data[0])
         {
-        case 1:
+        case WEIGHT_SENSOR_CALIBRATION_SPAN:
+        case WEIGHT_SENSOR_CALIBRATION_ADD_POINT:
         {
-            NRF_LOG_INFO("Message Received from Calibration 1.");
+            NRF_LOG_INFO("Message Received from Calibration %d.", p_evt_write->data[0]);
 
-            if (mCalibrationCallback != NULL)
+            if (p_evt_write->data[0] == WEIGHT_SENSOR_CALIBRATION_ADD_POINT && !referenceMassReceived)
             {
-                mCalibrationCallback();
+                NRF_LOG_INFO("Calibration point without a reference mass ignored");
+            }
+            else if (mCalibrationCallback != NULL)
+            {
+                mCalibrationCallback(p_evt_write->data[0], referenceMass);
             }
             else
             {
@@ -783,7 +1036,7 @@ static void ble_weight_sensor_on_write(ble_weight_sensor_service_t * p_weight_se
             NRF_LOG_FLUSH();
             break;
         }
-        case 2:
+        case WEIGHT_SENSOR_CALIBRATION_START_TIMER:
         {
             NRF_LOG_INFO("Message Received from Calibration 2.");
             NRF_LOG_FLUSH();
@@ -907,6 +1160,15 @@ uint32_t ble_weight_sensor_service_sensor_data_update(uint8_t *custom_value, uin
     return err_code;
 }
 
+uint32_t ble_weight_sensor_service_sensor_data_milligrams_update(int32_t milligrams)
+{
+    // The characteristic carries float grams at 0.1g resolution, rounded in integer math
+    int32_t tenths = (milligrams >= 0 ? milligrams + 50 : milligrams - 50) / 100;
+    float weight = tenths / 10.0f;
+
+    return ble_weight_sensor_service_sensor_data_update((uint8_t*)&weight, sizeof(float));
+}
+
 uint32_t ble_weight_sensor_service_tare_update(uint8_t *custom_value, uint8_t custom_value_length)
 {
     uint32_t err_code = NRF_SUCCESS;
@@ -1083,6 +1345,138 @@ uint32_t ble_weight_sensor_service_water_weight_update(float weight)
     return err_code;
 }
 
+uint32_t ble_weight_sensor_service_pour_stop_update(uint8_t stop)
+{
+    uint32_t err_code = NRF_SUCCESS;
+    ble_gatts_value_t gatts_value;
+
+    // Initialize value struct.
+    memset(&gatts_value, 0, sizeof(gatts_value));
+
+    gatts_value.len     = 1*sizeof(uint8_t);
+    gatts_value.offset  = 0;
+    gatts_value.p_value = &stop;   
+
+    // Update database.
+    err_code= sd_ble_gatts_value_set(m_weight_sensor.conn_handle,
+                                        m_weight_sensor.weight_sensor_pour_stop_handles.value_handle,
+                                        &gatts_value);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Send value if connected and notifying.
+    if ((m_weight_sensor.conn_handle != BLE_CONN_HANDLE_INVALID)) 
+    {
+        ble_gatts_hvx_params_t hvx_params;
+
+        memset(&hvx_params, 0, sizeof(hvx_params));
+
+        hvx_params.handle = m_weight_sensor.weight_sensor_pour_stop_handles.value_handle;
+        hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+        hvx_params.offset = gatts_value.offset;
+        hvx_params.p_len  = &gatts_value.len;
+        hvx_params.p_data = gatts_value.p_value;
+
+        err_code = sd_ble_gatts_hvx(m_weight_sensor.conn_handle, &hvx_params);
+    }
+    else
+    {
+        err_code = NRF_ERROR_INVALID_STATE;
+    }
+
+    return err_code;
+}
+
+uint32_t ble_weight_sensor_service_brew_phase_update(uint8_t *summary, uint8_t summary_length)
+{
+    uint32_t err_code = NRF_SUCCESS;
+    ble_gatts_value_t gatts_value;
+
+    // Initialize value struct.
+    memset(&gatts_value, 0, sizeof(gatts_value));
+
+    gatts_value.len     = summary_length*sizeof(uint8_t);
+    gatts_value.offset  = 0;
+    gatts_value.p_value = summary;   
+
+    // Update database.
+    err_code= sd_ble_gatts_value_set(m_weight_sensor.conn_handle,
+                                        m_weight_sensor.weight_sensor_brew_phase_handles.value_handle,
+                                        &gatts_value);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Send value if connected and notifying.
+    if ((m_weight_sensor.conn_handle != BLE_CONN_HANDLE_INVALID)) 
+    {
+        ble_gatts_hvx_params_t hvx_params;
+
+        memset(&hvx_params, 0, sizeof(hvx_params));
+
+        hvx_params.handle = m_weight_sensor.weight_sensor_brew_phase_handles.value_handle;
+        hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+        hvx_params.offset = gatts_value.offset;
+        hvx_params.p_len  = &gatts_value.len;
+        hvx_params.p_data = gatts_value.p_value;
+
+        err_code = sd_ble_gatts_hvx(m_weight_sensor.conn_handle, &hvx_params);
+    }
+    else
+    {
+        err_code = NRF_ERROR_INVALID_STATE;
+    }
+
+    return err_code;
+}
+
+uint32_t ble_weight_sensor_service_shot_result_update(uint8_t *result, uint8_t result_length)
+{
+    uint32_t err_code = NRF_SUCCESS;
+    ble_gatts_value_t gatts_value;
+
+    // Initialize value struct.
+    memset(&gatts_value, 0, sizeof(gatts_value));
+
+    gatts_value.len     = result_length*sizeof(uint8_t);
+    gatts_value.offset  = 0;
+    gatts_value.p_value = result;   
+
+    // Update database.
+    err_code= sd_ble_gatts_value_set(m_weight_sensor.conn_handle,
+                                        m_weight_sensor.weight_sensor_shot_result_handles.value_handle,
+                                        &gatts_value);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Send value if connected and notifying.
+    if ((m_weight_sensor.conn_handle != BLE_CONN_HANDLE_INVALID)) 
+    {
+        ble_gatts_hvx_params_t hvx_params;
+
+        memset(&hvx_params, 0, sizeof(hvx_params));
+
+        hvx_params.handle = m_weight_sensor.weight_sensor_shot_result_handles.value_handle;
+        hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+        hvx_params.offset = gatts_value.offset;
+        hvx_params.p_len  = &gatts_value.len;
+        hvx_params.p_data = gatts_value.p_value;
+
+        err_code = sd_ble_gatts_hvx(m_weight_sensor.conn_handle, &hvx_params);
+    }
+    else
+    {
+        err_code = NRF_ERROR_INVALID_STATE;
+    }
+
+    return err_code;
+}
+
 /**@brief Function for handling the Accelerometer Service Service events.
  *
  * @details This function will be called for all Accelerometer Service events which are passed to
@@ -1120,7 +1514,7 @@ void ble_weight_sensor_set_tare_callback(void (*func)(void))
     mTareCallback = func;
 }
 
-void ble_weight_sensor_set_calibration_callback(void (*func)(void))
+void ble_weight_sensor_set_calibration_callback(void (*func)(uint8_t command, float referenceMass))
 {
     mCalibrationCallback = func;
 }
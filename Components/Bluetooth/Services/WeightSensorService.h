@@ -33,6 +33,23 @@
 #define WEIGHT_SENSOR_WEIGH_MODE_CHAR_UUID              0x1405
 #define WEIGHT_SENSOR_COFFEE_WEIGHT_CHAR_UUID           0x1406
 #define WEIGHT_SENSOR_WATER_WEIGHT_CHAR_UUID            0x1407
+#define WEIGHT_SENSOR_POUR_STOP_CHAR_UUID               0x1408
+#define WEIGHT_SENSOR_BREW_PHASE_CHAR_UUID              0x1409
+#define WEIGHT_SENSOR_SHOT_RESULT_CHAR_UUID             0x140A
+
+// Brew phase summary: phase, index, start and end in ms since the brew started and grams gained, little endian
+#define WEIGHT_SENSOR_BREW_PHASE_LENGTH                 14
+
+// Espresso shot result: float yield in grams, shot time in ms and trigger to display latency in ms, little endian
+#define WEIGHT_SENSOR_SHOT_RESULT_LENGTH                10
+
+// Calibration characteristic writes are a command byte, optionally followed by the little endian float
+// reference mass in grams
+#define WEIGHT_SENSOR_CALIBRATION_SPAN                  1   // span calibration, 50 g if no mass is given
+#define WEIGHT_SENSOR_CALIBRATION_START_TIMER           2
+#define WEIGHT_SENSOR_CALIBRATION_ADD_POINT             3   // nonlinearity correction point, mass required
+#define WEIGHT_SENSOR_CALIBRATION_DEFAULT_MASS          50.0f
+#define WEIGHT_SENSOR_CALIBRATION_MAX_LEN               (sizeof(uint8_t) + sizeof(float))
 
 
 /**@brief   Macro for defining a ble_weight_sensor instance.
@@ -93,6 +110,9 @@ struct ble_weight_sensor_service_s
     ble_gatts_char_handles_t        weight_sensor_weigh_mode_handles;
     ble_gatts_char_handles_t        weight_sensor_set_coffee_weight_handles;
     ble_gatts_char_handles_t        weight_sensor_water_weight_handles;
+    ble_gatts_char_handles_t        weight_sensor_pour_stop_handles;
+    ble_gatts_char_handles_t        weight_sensor_brew_phase_handles;
+    ble_gatts_char_handles_t        weight_sensor_shot_result_handles;
     uint16_t                      conn_handle;                    /**< Handle of the current connection (as provided by the BLE stack, is BLE_CONN_HANDLE_INVALID if not in a connection). */
     uint8_t                       uuid_type; 
 };
@@ -140,6 +160,8 @@ static void ble_weight_sensor_on_write(ble_weight_sensor_service_t * p_weight_se
  */
 uint32_t ble_weight_sensor_service_sensor_data_update(uint8_t *custom_value, uint8_t custom_value_length);
 
+uint32_t ble_weight_sensor_service_sensor_data_milligrams_update(int32_t milligrams);
+
 uint32_t ble_weight_sensor_service_tare_update(uint8_t *custom_value, uint8_t custom_value_length);
 
 uint32_t ble_weight_sensor_service_coffee_to_water_ratio_update(uint8_t *custom_value, uint8_t custom_value_length);
@@ -148,13 +170,22 @@ uint32_t ble_weight_sensor_service_weigh_mode_update(uint8_t *custom_value, uint
 
 uint32_t ble_weight_sensor_service_water_weight_update(float weight);
 
+// 1 once the pour should be stopped to land on the water weight, 0 while pouring should carry on
+uint32_t ble_weight_sensor_service_pour_stop_update(uint8_t stop);
+
+// Notify the summary of a brew phase that just ended
+uint32_t ble_weight_sensor_service_brew_phase_update(uint8_t *summary, uint8_t summary_length);
+
+// Notify the yield and time of an espresso shot that just stopped
+uint32_t ble_weight_sensor_service_shot_result_update(uint8_t *result, uint8_t result_length);
+
 void ble_weight_sensor_on_weight_sensor_evt(ble_weight_sensor_service_t * p_weight_sensor_service, ble_weight_sensor_evt_t * p_evt);
 
 uint32_t ble_weight_sensor_service_sensor_data_set(uint8_t *custom_value, uint8_t custom_value_length);
 
 void ble_weight_sensor_set_tare_callback(void (*func)(void));
 
-void ble_weight_sensor_set_calibration_callback(void (*func)(void));
+void ble_weight_sensor_set_calibration_callback(void (*func)(uint8_t command, float referenceMass));
 
 void ble_weight_sensor_set_coffee_to_water_ratio_callback(void (*func)(uint16_t requestValue ));
 
@@ -0,0 +1,210 @@
+#include "brew_phase.h"
+
+#include <math.h>
+#include <string.h>
+
+#define BREW_POUR_START_FLOW        1.0f    // g/s
+#define BREW_POUR_END_FLOW          0.3f    // g/s
+#define BREW_MAX_POUR_FLOW          30.0f   // g/s, faster is something being put on the scale
+#define BREW_CONFIRM_TIME           0.5f    // s across a threshold before the phase changes
+#define BREW_TARGET_FRACTION        0.95f   // of the target poured before a pause is the drawdown
+#define BREW_REMOVED_FRACTION       0.5f    // of the peak weight left once the dripper is lifted off
+#define BREW_REARM_WEIGHT           1.0f    // g, scale emptied or tared
+
+void brew_phase_init(brew_phase_tracker_t *tracker)
+{
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->phase = BREW_PHASE_IDLE;
+}
+
+void brew_phase_set_target(brew_phase_tracker_t *tracker, float target)
+{
+    tracker->target = fmaxf(target, 0.0f);
+}
+
+static void brew_phase_candidate_reset(brew_phase_tracker_t *tracker)
+{
+    tracker->candidate_duration = 0.0f;
+}
+
+// Track how long the flow has been across a threshold, remembering where it first crossed
+static bool brew_phase_candidate_confirmed(brew_phase_tracker_t *tracker, bool crossed, float grams, float dt)
+{
+    if (!crossed)
+    {
+        brew_phase_candidate_reset(tracker);
+        return false;
+    }
+
+    if (tracker->candidate_duration == 0.0f)
+    {
+        tracker->candidate_time = tracker->elapsed - dt;
+        tracker->candidate_grams = grams;
+    }
+
+    tracker->candidate_duration += dt;
+
+    return tracker->candidate_duration >= BREW_CONFIRM_TIME;
+}
+
+// Close the current phase at time/grams and start the next one from there
+static void brew_phase_change(brew_phase_tracker_t *tracker, brew_phase_t next, float time, float grams)
+{
+    brew_phase_summary_t *summary = &tracker->last_summary;
+
+    summary->phase = (uint8_t)tracker->phase;
+    summary->index = tracker->index;
+    summary->start_ms = (uint32_t)lroundf(tracker->phase_start * 1000.0f);
+    summary->end_ms = (uint32_t)lroundf(fmaxf(time, tracker->phase_start) * 1000.0f);
+    summary->grams = grams - tracker->phase_start_grams;
+
+    tracker->index++;
+    tracker->phase = next;
+    tracker->phase_start = time;
+    tracker->phase_start_grams = grams;
+
+    brew_phase_candidate_reset(tracker);
+}
+
+brew_phase_event_t brew_phase_update(brew_phase_tracker_t *tracker, float grams, float gramsPerSecond, float dt)
+{
+    bool pouring = gramsPerSecond > BREW_POUR_START_FLOW && gramsPerSecond < BREW_MAX_POUR_FLOW;
+    bool stopped = gramsPerSecond < BREW_POUR_END_FLOW;
+
+    tracker->elapsed += dt;
+
+    switch (tracker->phase)
+    {
+        case BREW_PHASE_IDLE:
+        {
+            if (!brew_phase_candidate_confirmed(tracker, pouring, grams, dt))
+            {
+                tracker->elapsed = tracker->candidate_duration;
+                break;
+            }
+
+            // The brew starts where the flow first picked up
+            tracker->elapsed = tracker->candidate_duration;
+            tracker->phase = BREW_PHASE_BLOOM;
+            tracker->bloom_rested = false;
+            tracker->index = 0;
+            tracker->phase_start = 0.0f;
+            tracker->phase_start_grams = tracker->candidate_grams;
+            tracker->peak_grams = grams;
+
+            brew_phase_candidate_reset(tracker);
+
+            return BREW_PHASE_EVENT_STARTED;
+        }
+
+        case BREW_PHASE_DONE:
+        {
+            if (grams < BREW_REARM_WEIGHT)
+            {
+                float target = tracker->target;
+
+                brew_phase_init(tracker);
+                tracker->target = target;
+            }
+
+            break;
+        }
+
+        default:
+        {
+            tracker->peak_grams = fmaxf(tracker->peak_grams, grams);
+
+            if (grams < tracker->peak_grams * BREW_REMOVED_FRACTION)
+            {
+                // Lifted off, the weight before the drop is the end of the brew
+                brew_phase_change(tracker, BREW_PHASE_DONE, tracker->elapsed, tracker->peak_grams);
+                return BREW_PHASE_EVENT_FINISHED;
+            }
+
+            break;
+        }
+    }
+
+    switch (tracker->phase)
+    {
+        case BREW_PHASE_BLOOM:
+        {
+            // The bloom pour and the rest after it, until the next pour
+            if (!tracker->bloom_rested)
+            {
+                tracker->bloom_rested = brew_phase_candidate_confirmed(tracker, stopped, grams, dt);
+
+                if (tracker->bloom_rested)
+                {
+                    brew_phase_candidate_reset(tracker);
+                }
+            }
+            else if (brew_phase_candidate_confirmed(tracker, pouring, grams, dt))
+            {
+                brew_phase_change(tracker, BREW_PHASE_POUR, tracker->candidate_time, tracker->candidate_grams);
+                return BREW_PHASE_EVENT_PHASE_ENDED;
+            }
+
+            break;
+        }
+
+        case BREW_PHASE_POUR:
+        {
+            if (brew_phase_candidate_confirmed(tracker, stopped, grams, dt))
+            {
+                brew_phase_change(tracker, BREW_PHASE_PAUSE, tracker->candidate_time, tracker->candidate_grams);
+                return BREW_PHASE_EVENT_PHASE_ENDED;
+            }
+
+            break;
+        }
+
+        case BREW_PHASE_PAUSE:
+        {
+            if (brew_phase_candidate_confirmed(tracker, pouring, grams, dt))
+            {
+                brew_phase_change(tracker, BREW_PHASE_POUR, tracker->candidate_time, tracker->candidate_grams);
+                return BREW_PHASE_EVENT_PHASE_ENDED;
+            }
+
+            bool targetPoured = tracker->target > 0.0f && grams >= tracker->target * BREW_TARGET_FRACTION;
+
+            if (targetPoured || tracker->elapsed - tracker->phase_start >= BREW_PHASE_DRAWDOWN_TIME)
+            {
+                // Nothing more is coming, the pause was the start of the drawdown
+                tracker->phase = BREW_PHASE_DRAWDOWN;
+            }
+
+            break;
+        }
+
+        case BREW_PHASE_DRAWDOWN:
+        {
+            // Topped up after all
+            if (brew_phase_candidate_confirmed(tracker, pouring, grams, dt))
+            {
+                brew_phase_change(tracker, BREW_PHASE_POUR, tracker->candidate_time, tracker->candidate_grams);
+                return BREW_PHASE_EVENT_PHASE_ENDED;
+            }
+
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return BREW_PHASE_EVENT_NONE;
+}
+
+bool brew_phase_stop(brew_phase_tracker_t *tracker, float grams)
+{
+    if (tracker->phase == BREW_PHASE_IDLE || tracker->phase == BREW_PHASE_DONE)
+    {
+        return false;
+    }
+
+    brew_phase_change(tracker, BREW_PHASE_DONE, tracker->elapsed, grams);
+
+    return true;
+}
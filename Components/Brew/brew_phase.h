@@ -0,0 +1,77 @@
+#ifndef BREW_PHASE_h
+#define BREW_PHASE_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Online segmentation of a pour over brew from the flow into the cup.
+//
+// The brew starts with the first pour. That pour and the rest after it are the bloom, then pours and pauses
+// alternate. A pause becomes the drawdown once the target weight has been poured or it lasts longer than
+// BREW_PHASE_DRAWDOWN_TIME, and the brew is finished when the dripper is lifted off. Phase changes are
+// backdated to where the flow first crossed its threshold, so the hysteresis doesn't skew the timings.
+// Each sample is an O(1) update with no history kept.
+
+#define BREW_PHASE_DRAWDOWN_TIME    20.0f   // s of pause after the bloom
+
+typedef enum
+{
+    BREW_PHASE_IDLE,
+    BREW_PHASE_BLOOM,
+    BREW_PHASE_POUR,
+    BREW_PHASE_PAUSE,
+    BREW_PHASE_DRAWDOWN,
+    BREW_PHASE_DONE
+} brew_phase_t;
+
+typedef enum
+{
+    BREW_PHASE_EVENT_NONE,
+    BREW_PHASE_EVENT_STARTED,       // first pour of a brew
+    BREW_PHASE_EVENT_PHASE_ENDED,   // last_summary holds the phase that just ended
+    BREW_PHASE_EVENT_FINISHED       // the brew is over, last_summary holds its final phase
+} brew_phase_event_t;
+
+// Summary of one phase as published over BLE, little endian
+typedef struct __attribute__((packed))
+{
+    uint8_t phase;          // brew_phase_t
+    uint8_t index;          // count of phases before this one in the brew
+    uint32_t start_ms;      // since the brew started
+    uint32_t end_ms;
+    float grams;            // weight gained during the phase
+} brew_phase_summary_t;
+
+typedef struct
+{
+    brew_phase_t phase;
+    uint8_t index;
+    float target;           // g, 0 if not known
+
+    float elapsed;          // s since the brew started
+    float phase_start;
+    float phase_start_grams;
+
+    // Candidate transition, confirmed once the flow stays across the threshold long enough
+    float candidate_time;
+    float candidate_grams;
+    float candidate_duration;
+
+    float peak_grams;
+    bool bloom_rested;      // the bloom pour has stopped
+
+    brew_phase_summary_t last_summary;
+} brew_phase_tracker_t;
+
+void brew_phase_init(brew_phase_tracker_t *tracker);
+
+// Weight the brew is aiming for in grams, 0 if not known
+void brew_phase_set_target(brew_phase_tracker_t *tracker, float target);
+
+// Call with every filtered weight and flow, dt seconds after the previous one
+brew_phase_event_t brew_phase_update(brew_phase_tracker_t *tracker, float grams, float gramsPerSecond, float dt);
+
+// Ends the brew from outside, e.g. the timer was stopped. Returns true if a phase ended
+bool brew_phase_stop(brew_phase_tracker_t *tracker, float grams);
+
+#endif
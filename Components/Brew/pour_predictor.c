@@ -0,0 +1,126 @@
+#include "pour_predictor.h"
+
+#include <math.h>
+#include <string.h>
+
+#define POUR_MIN_FLOW               0.5f    // g/s, below this nobody is pouring
+#define POUR_SETTLED_FLOW           0.1f    // g/s
+#define POUR_SETTLE_TIME            1.5f    // s the flow has to stay settled after a stop
+#define POUR_SETTLE_TIMEOUT         10.0f   // s, pouring carried on past the stop signal
+#define POUR_REARM_WEIGHT           1.0f    // g, cup emptied or tared
+#define POUR_MAX_IN_FLIGHT_TIME     3.0f    // s
+#define POUR_LEARNING_RATE          0.25f
+
+void pour_predictor_init(pour_predictor_t *predictor, float inFlightTime)
+{
+    memset(predictor, 0, sizeof(*predictor));
+
+    if (inFlightTime >= 0.0f && inFlightTime <= POUR_MAX_IN_FLIGHT_TIME)
+    {
+        predictor->in_flight_time = inFlightTime;
+    }
+    else
+    {
+        predictor->in_flight_time = POUR_PREDICTOR_DEFAULT_IN_FLIGHT_TIME;
+    }
+
+    predictor->state = POUR_PREDICTOR_IDLE;
+}
+
+void pour_predictor_set_target(pour_predictor_t *predictor, float target)
+{
+    predictor->target = target;
+    predictor->time_to_target = 0.0f;
+    predictor->state = (target > 0.0f) ? POUR_PREDICTOR_ARMED : POUR_PREDICTOR_IDLE;
+}
+
+void pour_predictor_set_latency(pour_predictor_t *predictor, float latency)
+{
+    predictor->latency = fmaxf(latency, 0.0f);
+}
+
+pour_predictor_event_t pour_predictor_update(pour_predictor_t *predictor, float grams, float gramsPerSecond, float dt)
+{
+    switch (predictor->state)
+    {
+        case POUR_PREDICTOR_ARMED:
+        {
+            float lead = predictor->in_flight_time + predictor->latency;
+            float remaining = predictor->target - grams;
+
+            if (gramsPerSecond < POUR_MIN_FLOW)
+            {
+                predictor->time_to_target = 0.0f;
+                break;
+            }
+
+            predictor->time_to_target = fmaxf(remaining / gramsPerSecond - lead, 0.0f);
+
+            if (remaining > gramsPerSecond * lead)
+            {
+                break;
+            }
+
+            predictor->weight_at_stop = grams;
+            predictor->flow_at_stop = gramsPerSecond;
+            predictor->settle_time = 0.0f;
+            predictor->elapsed_since_stop = 0.0f;
+            predictor->state = POUR_PREDICTOR_SETTLING;
+
+            return POUR_PREDICTOR_EVENT_STOP_NOW;
+        }
+
+        case POUR_PREDICTOR_SETTLING:
+        {
+            predictor->elapsed_since_stop += dt;
+
+            if (predictor->elapsed_since_stop > POUR_SETTLE_TIMEOUT)
+            {
+                // Carried on pouring, nothing to learn from this one
+                predictor->state = POUR_PREDICTOR_IDLE;
+                break;
+            }
+
+            if (fabsf(gramsPerSecond) > POUR_SETTLED_FLOW)
+            {
+                predictor->settle_time = 0.0f;
+                break;
+            }
+
+            predictor->settle_time += dt;
+
+            if (predictor->settle_time < POUR_SETTLE_TIME)
+            {
+                break;
+            }
+
+            predictor->state = POUR_PREDICTOR_IDLE;
+
+            // What arrived after the stop signal, as time at the flow the stop was signalled at
+            float observed = (grams - predictor->weight_at_stop) / predictor->flow_at_stop - predictor->latency;
+
+            if (observed < 0.0f || observed > POUR_MAX_IN_FLIGHT_TIME)
+            {
+                break;
+            }
+
+            predictor->in_flight_time += (observed - predictor->in_flight_time) * POUR_LEARNING_RATE;
+
+            return POUR_PREDICTOR_EVENT_LEARNED;
+        }
+
+        case POUR_PREDICTOR_IDLE:
+        default:
+        {
+            if (predictor->target > 0.0f && grams < POUR_REARM_WEIGHT)
+            {
+                predictor->state = POUR_PREDICTOR_ARMED;
+                return POUR_PREDICTOR_EVENT_REARMED;
+            }
+
+            break;
+        }
+    }
+
+    return POUR_PREDICTOR_EVENT_NONE;
+}
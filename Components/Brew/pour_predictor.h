@@ -0,0 +1,60 @@
+#ifndef POUR_PREDICTOR_h
+#define POUR_PREDICTOR_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Predicts when to stop pouring to land on the target weight.
+//
+// Once the pour is stopped the cup still gains what is in flight between the spout and the cup, plus what
+// flows during the reaction time of whoever is pouring. Both are taken as flow * in_flight_time, learned from
+// the overshoot of each pour. The filtered weight and the display lag the cup by latency seconds on top of that.
+// "Stop now" is signalled as soon as
+//
+//   weight + flow * (in_flight_time + latency) >= target
+
+#define POUR_PREDICTOR_DEFAULT_IN_FLIGHT_TIME   0.5f    // s
+
+typedef enum
+{
+    POUR_PREDICTOR_IDLE,        // no target, or the pour for the target is done
+    POUR_PREDICTOR_ARMED,       // waiting for the predicted weight to reach the target
+    POUR_PREDICTOR_SETTLING     // stop signalled, waiting for the flow to end to learn the overshoot
+} pour_predictor_state_t;
+
+typedef enum
+{
+    POUR_PREDICTOR_EVENT_NONE,
+    POUR_PREDICTOR_EVENT_STOP_NOW,
+    POUR_PREDICTOR_EVENT_LEARNED,   // in_flight_time was updated from the pour that just ended
+    POUR_PREDICTOR_EVENT_REARMED    // the cup was emptied or tared, the stop signal is cleared
+} pour_predictor_event_t;
+
+typedef struct
+{
+    pour_predictor_state_t state;
+
+    float target;               // g
+    float in_flight_time;       // s
+    float latency;              // s
+
+    float weight_at_stop;
+    float flow_at_stop;
+    float settle_time;
+    float elapsed_since_stop;
+
+    float time_to_target;       // s until the stop signal at the current flow, 0 once signalled
+} pour_predictor_t;
+
+void pour_predictor_init(pour_predictor_t *predictor, float inFlightTime);
+
+// target weight in grams, 0 disables the predictor
+void pour_predictor_set_target(pour_predictor_t *predictor, float target);
+
+// filter and display lag in seconds
+void pour_predictor_set_latency(pour_predictor_t *predictor, float latency);
+
+// Call with every filtered weight and flow, dt seconds after the previous one
+pour_predictor_event_t pour_predictor_update(pour_predictor_t *predictor, float grams, float gramsPerSecond, float dt);
+
+#endif
@@ -0,0 +1,145 @@
+#include "shot_timer.h"
+
+#include <string.h>
+
+#include "Components/WeightSensor/SampleClock/sample_clock.h"
+
+#define SHOT_MAX_START_FLOW     10.0f   // g/s, faster than this the cup was put down rather than dripped into
+#define TICKS_PER_MS            (SAMPLE_CLOCK_TICKS_PER_SECOND / 1000)
+
+void shot_timer_init(shot_timer_t *timer)
+{
+    memset(timer, 0, sizeof(*timer));
+
+    timer->state = SHOT_TIMER_IDLE;
+}
+
+void shot_timer_set_target(shot_timer_t *timer, float target)
+{
+    timer->target = (target > 0.0f) ? target : 0.0f;
+}
+
+void shot_timer_reset(shot_timer_t *timer)
+{
+    timer->state = SHOT_TIMER_IDLE;
+    timer->previous_valid = false;
+    memset(&timer->result, 0, sizeof(timer->result));
+}
+
+// Time the weight passed threshold between the previous conversion and this one
+static uint32_t shot_timer_crossing(const shot_timer_t *timer, float grams, uint32_t timestamp, float threshold, float delay)
+{
+    float fraction = 1.0f;
+    float rise = grams - timer->previous_grams;
+
+    if (rise > 0.0f)
+    {
+        fraction = (threshold - timer->previous_grams) / rise;
+        fraction = (fraction < 0.0f) ? 0.0f : ((fraction > 1.0f) ? 1.0f : fraction);
+    }
+
+    uint32_t crossing = timer->previous_timestamp + (uint32_t)(fraction * (float)(timestamp - timer->previous_timestamp));
+
+    return crossing - (uint32_t)(delay * (float)SAMPLE_CLOCK_TICKS_PER_SECOND);
+}
+
+static void shot_timer_finish(shot_timer_t *timer, float grams, uint32_t stopTime)
+{
+    // The delay correction can't take the stop before the start
+    if ((int32_t)(stopTime - timer->start_time) < 0)
+    {
+        stopTime = timer->start_time;
+    }
+
+    timer->event_time = stopTime;
+    timer->result.yield = grams;
+    timer->result.time_ms = (stopTime - timer->start_time) / TICKS_PER_MS;
+    timer->result.latency_ms = 0;
+    timer->state = SHOT_TIMER_DONE;
+}
+
+shot_timer_event_t shot_timer_update(shot_timer_t *timer, float grams, uint32_t timestamp, float delay)
+{
+    shot_timer_event_t event = SHOT_TIMER_EVENT_NONE;
+
+    switch (timer->state)
+    {
+        case SHOT_TIMER_IDLE:
+        {
+            if (!timer->previous_valid)
+            {
+                break;
+            }
+
+            bool crossed = timer->previous_grams < SHOT_TIMER_START_GRAMS && grams >= SHOT_TIMER_START_GRAMS;
+
+            float period = (float)(timestamp - timer->previous_timestamp) / (float)SAMPLE_CLOCK_TICKS_PER_SECOND;
+
+            if (crossed && period > 0.0f && (grams - timer->previous_grams) / period <= SHOT_MAX_START_FLOW)
+            {
+                timer->start_time = shot_timer_crossing(timer, grams, timestamp, SHOT_TIMER_START_GRAMS, delay);
+                timer->event_time = timer->start_time;
+                timer->state = SHOT_TIMER_RUNNING;
+                event = SHOT_TIMER_EVENT_STARTED;
+            }
+            break;
+        }
+        case SHOT_TIMER_RUNNING:
+        {
+            if (timer->target > 0.0f && grams >= timer->target)
+            {
+                uint32_t stopTime = timer->previous_valid ?
+                    shot_timer_crossing(timer, grams, timestamp, timer->target, delay) : timestamp;
+
+                shot_timer_finish(timer, grams, stopTime);
+                event = SHOT_TIMER_EVENT_STOPPED;
+            }
+            break;
+        }
+        case SHOT_TIMER_DONE:
+        {
+            // Cup lifted off or tared, ready for the next shot
+            if (grams < SHOT_TIMER_START_GRAMS)
+            {
+                timer->state = SHOT_TIMER_IDLE;
+            }
+            break;
+        }
+    }
+
+    timer->previous_grams = grams;
+    timer->previous_timestamp = timestamp;
+    timer->previous_valid = true;
+
+    return event;
+}
+
+bool shot_timer_stop(shot_timer_t *timer, float grams, uint32_t timestamp)
+{
+    if (timer->state != SHOT_TIMER_RUNNING)
+    {
+        return false;
+    }
+
+    shot_timer_finish(timer, grams, timestamp);
+    return true;
+}
+
+uint32_t shot_timer_elapsed_ms(const shot_timer_t *timer, uint32_t now)
+{
+    switch (timer->state)
+    {
+        case SHOT_TIMER_RUNNING:
+            if ((int32_t)(now - timer->start_time) < 0)
+            {
+                return 0;
+            }
+            return (now - timer->start_time) / TICKS_PER_MS;
+
+        case SHOT_TIMER_DONE:
+            return timer->result.time_ms;
+
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef SHOT_TIMER_h
+#define SHOT_TIMER_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Espresso shot timer driven by the conversion timestamps rather than an app_timer tick.
+//
+// The shot starts when the weight in the cup first rises through SHOT_TIMER_START_GRAMS and stops when it
+// reaches the target yield. Both times are interpolated between the two conversions either side of the
+// threshold and moved back by the filter delay, so they are not quantised to the sample period or late by
+// the filter lag. Timestamps are sample clock ticks.
+
+#define SHOT_TIMER_START_GRAMS      0.3f    // g, first drips in the cup
+#define SHOT_TIMER_MAX_LATENCY_MS   100     // trigger to display budget
+
+typedef enum
+{
+    SHOT_TIMER_IDLE,
+    SHOT_TIMER_RUNNING,
+    SHOT_TIMER_DONE
+} shot_timer_state_t;
+
+typedef enum
+{
+    SHOT_TIMER_EVENT_NONE,
+    SHOT_TIMER_EVENT_STARTED,
+    SHOT_TIMER_EVENT_STOPPED        // result holds the yield and shot time
+} shot_timer_event_t;
+
+// Shot result as published over BLE, little endian
+typedef struct __attribute__((packed))
+{
+    float yield;            // g
+    uint32_t time_ms;
+    uint16_t latency_ms;    // from the yield being reached to the time being shown
+} shot_timer_result_t;
+
+typedef struct
+{
+    shot_timer_state_t state;
+    float target;           // g, 0 to run until stopped
+
+    bool previous_valid;
+    float previous_grams;
+    uint32_t previous_timestamp;
+
+    uint32_t start_time;
+    uint32_t event_time;    // interpolated time of the last start or stop
+
+    shot_timer_result_t result;
+} shot_timer_t;
+
+void shot_timer_init(shot_timer_t *timer);
+
+// Target yield in grams, 0 if not known
+void shot_timer_set_target(shot_timer_t *timer, float target);
+
+// Arms the timer for the next shot
+void shot_timer_reset(shot_timer_t *timer);
+
+// Call with every filtered weight, the timestamp of its conversion and the filter delay in seconds
+shot_timer_event_t shot_timer_update(shot_timer_t *timer, float grams, uint32_t timestamp, float delay);
+
+// Ends a running shot from outside, e.g. the timer button. Returns true if a shot was running
+bool shot_timer_stop(shot_timer_t *timer, float grams, uint32_t timestamp);
+
+// ms since the shot started, the final shot time once it has stopped
+uint32_t shot_timer_elapsed_ms(const shot_timer_t *timer, uint32_t now);
+
+#endif
@@ -0,0 +1,127 @@
+#include "weigh_mode.h"
+
+#include "Components/SavedParameters/SavedParameters.h"
+#include "nrf_log.h"
+
+static const weigh_mode_profile_t mProfiles[WEIGH_MODE_COUNT] =
+{
+    // Follows pours smoothly and drops to 10 SPS between them
+    [WEIGH_MODE_POUR_OVER] =
+    {
+        .rate_mode = WEIGHT_SENSOR_RATE_ADAPTIVE,
+        .pipeline = WEIGHT_SENSOR_PIPELINE_BIQUAD,
+        .filter_cutoff = 0.0f,
+        .flow_source = WEIGHT_SENSOR_FLOW_DIFFERENCE,
+        .flow_fit_window = WEIGHT_SENSOR_FLOW_FIT_WINDOW,
+        .notch = false,
+        .stability_tolerance = 0.05f,
+        .display_interval = 0.0f,
+        .ble_interval = 0.0f,
+    },
+    // Low latency for the yield, always at 80 SPS with a short flow fit. The cup sits on the drip tray, so
+    // the notch takes out the pump
+    [WEIGH_MODE_ESPRESSO] =
+    {
+        .rate_mode = WEIGHT_SENSOR_RATE_FAST,
+        .pipeline = WEIGHT_SENSOR_PIPELINE_BIQUAD,
+        .filter_cutoff = 8.0f,
+        .flow_source = WEIGHT_SENSOR_FLOW_LEAST_SQUARES,
+        .flow_fit_window = 0.3f,
+        .notch = true,
+        .stability_tolerance = 0.1f,
+        .display_interval = 0.0f,
+        .ble_interval = 0.0f,
+    },
+    // Low noise readings, the display and notifications don't need every conversion
+    [WEIGH_MODE_SCALE] =
+    {
+        .rate_mode = WEIGHT_SENSOR_RATE_ADAPTIVE,
+        .pipeline = WEIGHT_SENSOR_PIPELINE_BIQUAD,
+        .filter_cutoff = 2.0f,
+        .flow_source = WEIGHT_SENSOR_FLOW_DIFFERENCE,
+        .flow_fit_window = WEIGHT_SENSOR_FLOW_FIT_WINDOW,
+        .notch = false,
+        .stability_tolerance = 0.02f,
+        .display_interval = 0.1f,
+        .ble_interval = 0.2f,
+    },
+};
+
+static weigh_mode_t mMode = WEIGH_MODE_POUR_OVER;
+static float mDisplayElapsed = 0.0f;
+static float mBleElapsed = 0.0f;
+
+bool weigh_mode_apply(uint8_t mode)
+{
+    if (mode >= WEIGH_MODE_COUNT)
+    {
+        NRF_LOG_WARNING("Unknown weigh mode %d", mode);
+        return false;
+    }
+
+    const weigh_mode_profile_t *profile = &mProfiles[mode];
+
+    mMode = (weigh_mode_t)mode;
+
+    // Every setter hands the current estimates over, so switching doesn't step the weight or flow
+    weight_sensor_set_rate_mode(profile->rate_mode);
+    weight_sensor_set_pipeline(profile->pipeline);
+
+    // A profile without its own cutoff uses the saved one. Should that be rejected, the last mode's cutoff would
+    // stay on, so the default takes its place
+    float cutoff = profile->filter_cutoff > 0.0f ? profile->filter_cutoff : saved_parameters_getWeightFilterCutoff();
+
+    if (!weight_sensor_set_weight_filter_cutoff(cutoff))
+    {
+        NRF_LOG_WARNING("Weight filter cutoff " NRF_LOG_FLOAT_MARKER " Hz rejected, using the default",
+                        NRF_LOG_FLOAT(cutoff));
+        weight_sensor_set_weight_filter_cutoff(WEIGHT_SENSOR_DEFAULT_FILTER_CUTOFF_HZ);
+    }
+
+    weight_sensor_set_flow_fit_window(profile->flow_fit_window);
+    weight_sensor_set_flow_source(profile->flow_source);
+    weight_sensor_set_notch_enabled(profile->notch);
+    weight_sensor_set_stability_tolerance(profile->stability_tolerance);
+
+    mDisplayElapsed = 0.0f;
+    mBleElapsed = 0.0f;
+
+    NRF_LOG_INFO("Weigh mode %d", mode);
+
+    return true;
+}
+
+weigh_mode_t weigh_mode_get()
+{
+    return mMode;
+}
+
+const weigh_mode_profile_t *weigh_mode_get_profile()
+{
+    return &mProfiles[mMode];
+}
+
+static bool weigh_mode_update_due(float *elapsed, float interval, float dt)
+{
+    *elapsed += dt;
+
+    if (*elapsed < interval)
+    {
+        return false;
+    }
+
+    // Keep the remainder so the updates keep to the interval, unless a gap left them far behind
+    *elapsed = *elapsed < 2.0f * interval ? *elapsed - interval : 0.0f;
+
+    return true;
+}
+
+bool weigh_mode_display_update_due(float dt)
+{
+    return weigh_mode_update_due(&mDisplayElapsed, mProfiles[mMode].display_interval, dt);
+}
+
+bool weigh_mode_ble_update_due(float dt)
+{
+    return weigh_mode_update_due(&mBleElapsed, mProfiles[mMode].ble_interval, dt);
+}
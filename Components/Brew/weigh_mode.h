@@ -0,0 +1,43 @@
+#ifndef WEIGH_MODE_h
+#define WEIGH_MODE_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Components/WeightSensor/WeightSensor.h"
+
+// Weigh modes as written to the weigh mode characteristic and saved
+typedef enum
+{
+    WEIGH_MODE_POUR_OVER,
+    WEIGH_MODE_ESPRESSO,
+    WEIGH_MODE_SCALE,
+    WEIGH_MODE_COUNT
+} weigh_mode_t;
+
+// Weight sensor pipeline and update rates used in a weigh mode
+typedef struct
+{
+    weight_sensor_rate_mode_t rate_mode;
+    weight_sensor_pipeline_t pipeline;
+    float filter_cutoff;                    // Hz, 0 for the saved cutoff
+    weight_sensor_flow_source_t flow_source;
+    float flow_fit_window;                  // s, for the least squares flow
+    bool notch;                             // follow and notch out pump or grinder vibration
+    float stability_tolerance;              // g
+    float display_interval;                 // s between display updates, 0 for every conversion
+    float ble_interval;                     // s between weight notifications, 0 for every conversion
+} weigh_mode_profile_t;
+
+// Switch the weight sensor to the profile of mode, keeping its filters running. Returns false and keeps the
+// current mode if mode is unknown
+bool weigh_mode_apply(uint8_t mode);
+
+weigh_mode_t weigh_mode_get();
+const weigh_mode_profile_t *weigh_mode_get_profile();
+
+// Called with the time since the previous conversion, true when the display or weight notification is due
+bool weigh_mode_display_update_due(float dt);
+bool weigh_mode_ble_update_due(float dt);
+
+#endif
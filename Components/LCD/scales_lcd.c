@@ -76,6 +76,7 @@ bool mGramsPerSecondUpdated = false;
 bool mSamplingRateUpdated = false;
 bool mResetDefaults = false;
 bool mIndicateTare = true;
+bool mPourStop = false;
 
 bool mWeightSensorTareAttemptsUpdated = false;
 
@@ -83,6 +84,7 @@ float mWeight = 0.0;
 float mCoffeeWeight = 0.0;
 float mWaterWeight = 0.0;
 uint32_t mTimerValue = 0;
+static bool mTimerValueTenths = false;
 static float mGramsPerSecond = 0;
 
 // Battery Related
@@ -97,7 +99,7 @@ float mBatteryRemainingCapacity = 0;
 
 // Weight Sensor Diagnostic Values
 uint32_t mWeightSensorTareAttempts = 0;
-uint16_t mWeightSensorSamplingRate = 0;
+float mWeightSensorSamplingRate = 0;
 
 #define LVGL_TIMER_INTERVAL_MS              5   // 5ms
 #define LVGL_TIMER_INTERVAL_TICKS           APP_TIMER_TICKS(LVGL_TIMER_INTERVAL_MS)
@@ -226,31 +228,35 @@ void display_driver_init()
 
 void display_update_weight_label(float weight)
 {
-    mWeight = weight;
-    char buffer[5]; // Make sure this buffer is large enough to hold the formatted string
-
-    // Convert float to string
-    sprintf(buffer, "%0.1f", weight);
-
-    // Find the position of the decimal point
-    char *decimalPointPosition = strchr(buffer, '.');
-
-    if (decimalPointPosition != NULL) {
-        // Split the buffer into two parts
-        *decimalPointPosition = '\0'; // Terminate the first part
+    display_update_weight_label_milligrams((int32_t)lroundf(weight * 1000.0f));
+}
 
-        // First buffer contains the whole numbers before the decimal place
-        strcpy(wholeNumbers, buffer);
+void display_update_weight_label_milligrams(int32_t milligrams)
+{
+    // Round to the nearest 0.1g without going through float
+    int32_t tenths = (milligrams >= 0 ? milligrams + 50 : milligrams - 50) / 100;
+    int32_t whole = tenths / 10;
+    int32_t fraction = tenths % 10;
 
-        // Second buffer contains the fractional part of the value
-        strcpy(fractionalPart, decimalPointPosition + 1);
+    if (fraction < 0)
+    {
+        fraction = -fraction;
+    }
 
-        char buffer2[2];
-        sprintf(buffer2, "%s", fractionalPart);
+    if (tenths < 0 && whole == 0)
+    {
+        // -0.x has no sign on the whole number part
+        snprintf(wholeNumbers, sizeof(wholeNumbers), "-0");
+    }
+    else
+    {
+        snprintf(wholeNumbers, sizeof(wholeNumbers), "%ld", (long)whole);
+    }
 
-        mWeightUpdated = true;
+    snprintf(fractionalPart, sizeof(fractionalPart), "%ld", (long)fraction);
 
-    }
+    mWeight = milligrams / 1000.0f;
+    mWeightUpdated = true;
 }
 
 void display_update_timer_label(uint32_t seconds)
@@ -261,6 +267,19 @@ void display_update_timer_label(uint32_t seconds)
     }
 
     mTimerValue = seconds;
+    mTimerValueTenths = false;
+    mTimerValueUpdated = true;
+}
+
+void display_update_timer_label_tenths(uint32_t tenths)
+{
+    if (objects.label_timer == NULL)
+    {
+        return;
+    }
+
+    mTimerValue = tenths;
+    mTimerValueTenths = true;
     mTimerValueUpdated = true;
 }
 
@@ -345,7 +364,7 @@ void display_update_tare_attempts_label(uint32_t attempts)
     mWeightSensorTareAttemptsUpdated = true;
 }
 
-void display_update_sampling_rate_label(uint16_t samplingRate)
+void display_update_sampling_rate_label(float samplingRate)
 {
 
     mWeightSensorSamplingRate = samplingRate;
@@ -368,6 +387,14 @@ void display_indicate_tare()
     mIndicateTare = true;
 }
 
+void display_indicate_pour_stop(bool stop)
+{
+    mPourStop = stop;
+
+    // recolour the weight bar on the next loop
+    mWeightUpdated = true;
+}
+
 void display_turn_backlight_on()
 {
     nrf_gpio_pin_clear(p_scales_display1->backlight_pin);
@@ -478,7 +505,12 @@ void display_loop()
 
         lv_bar_set_value(objects.graph_bar, mWeight, LV_ANIM_ON);
 
-        if (mWeight >= mWaterWeight - 5.0 ) 
+        if (mPourStop)
+        {
+            // Stop pouring, what is in flight will make up the rest
+            lv_obj_set_style_bg_color(objects.graph_bar, lv_palette_main(LV_PALETTE_BLUE), LV_PART_INDICATOR | LV_STATE_DEFAULT);
+        }
+        else if (mWeight >= mWaterWeight - 5.0 ) 
         {
             // Set to green
             lv_obj_set_style_bg_color(objects.graph_bar, lv_palette_main(LV_PALETTE_GREEN), LV_PART_INDICATOR | LV_STATE_DEFAULT);
@@ -548,13 +580,23 @@ void display_loop()
         mCoffeeWeightUpdated = false;
     }
 
-    if (mTimerValueUpdated)
+    if (mTimerValueUpdated && mTimerValueTenths && mTimerValue < 600)
+    {
+        char buffer[9];
+        sprintf(buffer, "%02d.%01d", (int)(mTimerValue / 10), (int)(mTimerValue % 10));
+
+        lv_label_set_text( objects.label_timer, buffer);
+        mTimerValueUpdated = false;
+    }
+    else if (mTimerValueUpdated)
     {
+        // A shot timer past a minute goes back to minutes and seconds
+        uint32_t seconds = mTimerValueTenths ? mTimerValue / 10 : mTimerValue;
         int hours, minutes, remainingSeconds;
 
-        hours = mTimerValue / 3600;
-        minutes = (mTimerValue % 3600) / 60;
-        remainingSeconds = mTimerValue % 60;
+        hours = seconds / 3600;
+        minutes = (seconds % 3600) / 60;
+        remainingSeconds = seconds % 60;
 
         char buffer[9];
         sprintf(buffer, "%02d:%02d", minutes, remainingSeconds);
@@ -656,7 +698,7 @@ void display_loop()
 
     if (mSamplingRateUpdated)
     {
-        sprintf(mWeightSensorSamplingRateBuffer, "%d", mWeightSensorSamplingRate);
+        sprintf(mWeightSensorSamplingRateBuffer, "%0.2f", mWeightSensorSamplingRate);
 
         lv_label_set_text( objects.diagnostics_sampling_rate_value, mWeightSensorSamplingRateBuffer);
         mSamplingRateUpdated = false;
@@ -25,11 +25,14 @@ void display_init();
 
 void display_screen_clear(void);
 void display_update_weight_label(float weight);
+void display_update_weight_label_milligrams(int32_t milligrams);
 
 void display_update_coffee_weight_label(float weight);
 void display_update_water_weight_label(float weight);
 
 void display_update_timer_label(uint32_t seconds);
+// seconds and tenths for the espresso shot timer
+void display_update_timer_label_tenths(uint32_t tenths);
 void display_update_battery_label(uint8_t batteryLevel);
 void display_update_battery_time_to_charge_value(float timeToCharge);
 void display_update_battery_time_to_empty_value(float timeToEmpty);
@@ -40,11 +43,14 @@ void display_update_battery_full_capacity_value(float fullCapacity);
 void display_update_battery_remaining_capacity_value(float remainingCapacity);
 
 void display_update_tare_attempts_label(uint32_t attempts);
-void display_update_sampling_rate_label(uint16_t samplingRate);
+void display_update_sampling_rate_label(float samplingRate);
 void display_update_grams_per_second_bar_label(float gramsPerSecond);
 
 void display_indicate_tare();
 
+// colours the weight bar to signal the pour should stop now
+void display_indicate_pour_stop(bool stop);
+
 void display_turn_backlight_on();
 void display_turn_backlight_off();
 
@@ -11,6 +11,7 @@
 #include "nrf_fstorage_sd.h"
 #include "fds.h"
 #include "nrf_log_ctrl.h"
+#include "Components/WeightSensor/WeightSensor.h"
 
 
 /* Array to map FDS events to strings. */
@@ -42,7 +43,16 @@ typedef struct SavedParameters_t
     uint16_t button2_csense_threshold;
     uint16_t button3_csense_threshold;
     uint16_t button4_csense_threshold;
-    float weight_filter_output_coefficient;
+    float weight_filter_cutoff;     // Hz, was the unused weight filter output coefficient
+    float offset_tempco;            // g per degree C
+    float span_tempco;              // relative span change per degree C
+    float span_reference_temperature;
+    float creep_coefficient;        // fraction of the load
+    float creep_time_constant;      // s
+    uint8_t calibration_point_count;
+    float calibration_readings[SAVED_PARAMETERS_CALIBRATION_POINTS];  // g read with the span calibration
+    float calibration_masses[SAVED_PARAMETERS_CALIBRATION_POINTS];    // g reference mass
+    float pour_in_flight_time;      // s learned by the pour stop predictor
 } SavedParameters_t;
 
 static SavedParameters_t mSavedParameters = 
@@ -51,7 +61,9 @@ static SavedParameters_t mSavedParameters =
     .coffee_to_water_ratio_numerator = 1,
     .coffee_to_water_ratio_denominator = 16,
     .weighMode = 0,
-    .weight_filter_output_coefficient = 0.5
+    .weight_filter_cutoff = WEIGHT_SENSOR_DEFAULT_FILTER_CUTOFF_HZ,
+    .span_reference_temperature = 25.0,
+    .pour_in_flight_time = 0.5
 };
 
 /* A record containing dummy configuration data. */
@@ -180,14 +192,28 @@ void saved_parameters_init()
         err_code = fds_record_open(&desc, &config);
         APP_ERROR_CHECK(err_code);
 
-        /* Copy the saved parameters from flash into mSavedParameters. */
-        memcpy(&mSavedParameters, config.p_data, sizeof(SavedParameters_t));
+        /* Copy the saved parameters from flash into mSavedParameters. A record written by an older
+           firmware is shorter, the parameters it doesn't have keep their defaults. */
+        memcpy(&mSavedParameters, config.p_data,
+               MIN(config.p_header->length_words * sizeof(uint32_t), sizeof(SavedParameters_t)));
 
         NRF_LOG_INFO("Config file found");
 
         /* Close the record when done reading. */
         err_code = fds_record_close(&desc);
         APP_ERROR_CHECK(err_code);
+
+        /* Records written before the weight filter cutoff took over its slot hold the old weight filter
+           output coefficient (0.5), which is no cutoff at all. Put the default in its place for good. */
+        float cutoff = mSavedParameters.weight_filter_cutoff;
+
+        if (!(cutoff >= WEIGHT_SENSOR_MIN_FILTER_CUTOFF_HZ && cutoff <= WEIGHT_SENSOR_MAX_FILTER_CUTOFF_HZ))
+        {
+            NRF_LOG_WARNING("Saved weight filter cutoff " NRF_LOG_FLOAT_MARKER " out of range, using the default",
+                            NRF_LOG_FLOAT(cutoff));
+            mSavedParameters.weight_filter_cutoff = WEIGHT_SENSOR_DEFAULT_FILTER_CUTOFF_HZ;
+            record_update();
+        }
     }
     else
     {
@@ -313,14 +339,81 @@ void saved_parameters_setButton4CSenseThreshold(uint16_t threshold)
     record_update();
 }
 
-float saved_parameters_getWeightFilterOutputCoefficient()
+float saved_parameters_getWeightFilterCutoff()
+{
+    return mSavedParameters.weight_filter_cutoff;
+}
+
+void saved_parameters_setWeightFilterCutoff(float cutoffHz)
+{
+    mSavedParameters.weight_filter_cutoff = cutoffHz;
+    record_update();
+}
+
+float saved_parameters_getOffsetTempco()
+{
+    return mSavedParameters.offset_tempco;
+}
+
+float saved_parameters_getSpanTempco()
+{
+    return mSavedParameters.span_tempco;
+}
+
+float saved_parameters_getSpanReferenceTemperature()
+{
+    return mSavedParameters.span_reference_temperature;
+}
+
+float saved_parameters_getCreepCoefficient()
+{
+    return mSavedParameters.creep_coefficient;
+}
+
+float saved_parameters_getCreepTimeConstant()
+{
+    return mSavedParameters.creep_time_constant;
+}
+
+void saved_parameters_setLoadCellCompensation(float offsetTempco, float spanTempco, float spanReferenceTemperature,
+                                              float creepCoefficient, float creepTimeConstant)
+{
+    mSavedParameters.offset_tempco = offsetTempco;
+    mSavedParameters.span_tempco = spanTempco;
+    mSavedParameters.span_reference_temperature = spanReferenceTemperature;
+    mSavedParameters.creep_coefficient = creepCoefficient;
+    mSavedParameters.creep_time_constant = creepTimeConstant;
+    record_update();
+}
+
+float saved_parameters_getPourInFlightTime()
 {
-    return mSavedParameters.weight_filter_output_coefficient;
+    return mSavedParameters.pour_in_flight_time;
 }
 
-void saved_parameters_setWeightFilterOutputCoefficient(float coefficient)
+void saved_parameters_setPourInFlightTime(float seconds)
 {
-    mSavedParameters.weight_filter_output_coefficient = coefficient;
+    mSavedParameters.pour_in_flight_time = seconds;
+    record_update();
+}
+
+uint8_t saved_parameters_getCalibrationPoints(float *readings, float *masses, uint8_t maxPoints)
+{
+    uint8_t count = MIN(MIN(mSavedParameters.calibration_point_count, SAVED_PARAMETERS_CALIBRATION_POINTS), maxPoints);
+
+    memcpy(readings, mSavedParameters.calibration_readings, count * sizeof(float));
+    memcpy(masses, mSavedParameters.calibration_masses, count * sizeof(float));
+
+    return count;
+}
+
+void saved_parameters_setCalibrationPoints(const float *readings, const float *masses, uint8_t count)
+{
+    count = MIN(count, SAVED_PARAMETERS_CALIBRATION_POINTS);
+
+    mSavedParameters.calibration_point_count = count;
+    memcpy(mSavedParameters.calibration_readings, readings, count * sizeof(float));
+    memcpy(mSavedParameters.calibration_masses, masses, count * sizeof(float));
     record_update();
 }
 
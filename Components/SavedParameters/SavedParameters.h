@@ -9,6 +9,9 @@
 #define CONFIG_FILE     (0x8010)
 #define CONFIG_REC_KEY  (0x7010)
 
+/* Nonlinearity correction points kept with the scale factor. */
+#define SAVED_PARAMETERS_CALIBRATION_POINTS     8
+
 
 void saved_parameters_init();
 
@@ -29,8 +32,23 @@ void saved_parameters_setButton3CSenseThreshold(uint16_t threshold);
 uint16_t saved_parameters_getButton4CSenseThreshold();
 void saved_parameters_setButton4CSenseThreshold(uint16_t threshold);
 
-float saved_parameters_getWeightFilterOutputCoefficient();
-void saved_parameters_setWeightFilterOutputCoefficient(float coefficient);
+float saved_parameters_getWeightFilterCutoff();
+void saved_parameters_setWeightFilterCutoff(float cutoffHz);
+
+float saved_parameters_getOffsetTempco();
+float saved_parameters_getSpanTempco();
+float saved_parameters_getSpanReferenceTemperature();
+float saved_parameters_getCreepCoefficient();
+float saved_parameters_getCreepTimeConstant();
+void saved_parameters_setLoadCellCompensation(float offsetTempco, float spanTempco, float spanReferenceTemperature,
+                                              float creepCoefficient, float creepTimeConstant);
+
+float saved_parameters_getPourInFlightTime();
+void saved_parameters_setPourInFlightTime(float seconds);
+
+/* Copies up to maxPoints correction points into readings and masses, returns the number copied. */
+uint8_t saved_parameters_getCalibrationPoints(float *readings, float *masses, uint8_t maxPoints);
+void saved_parameters_setCalibrationPoints(const float *readings, const float *masses, uint8_t count);
 
 uint8_t saved_parameters_getWeighMode();
 void saved_parameters_setWeighMode(uint8_t mode);
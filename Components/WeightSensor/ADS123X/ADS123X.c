@@ -2,6 +2,8 @@
 #include "nrf_gpio.h"
 #include "nrf_delay.h"
 
+#include <math.h>
+
 // Initialize library
 void ADS123X_Init(ADS123X *device, uint8_t pin_DOUT, uint8_t pin_SCLK, uint8_t pin_PDWN, uint8_t pin_GAIN0, uint8_t pin_GAIN1, uint8_t pin_SPEED)
 {
@@ -15,6 +17,10 @@ void ADS123X_Init(ADS123X *device, uint8_t pin_DOUT, uint8_t pin_SCLK, uint8_t p
   device->scaleFactor = 0.0f;
   device->offset = 0.0f;
   device->calibrateOnNextConversion = false;
+
+  device->offsetCode = 0;
+  device->milligramsPerCode = 0;
+  device->maxCodeDifference = 0;
 }
 
 bool ADS123X_IsReady(ADS123X *device)
@@ -29,7 +35,7 @@ ADS123X_ERROR_t ADS123X_read(ADS123X *device, int32_t *value)
         return SENSOR_NOT_READY;
     }
 
-    int32_t readValue = 0;
+    uint32_t readValue = 0;
 
     // Read 24 bits MSB first
     for (int i = 23; i >= 0; i--) {
@@ -51,15 +57,53 @@ ADS123X_ERROR_t ADS123X_read(ADS123X *device, int32_t *value)
         device->calibrateOnNextConversion = false;
     }
 
-    // Sign extend the 24-bit two's complement value
-    if (readValue & 0x800000) {
-        readValue = (readValue << 8) >> 8; // Arithmetic shift for sign-extension
+    *value = ADS123X_signExtend(readValue);
+    return NoERROR;
+}
+
+int32_t ADS123X_signExtend(uint32_t rawValue)
+{
+    // Move bit 23 into the sign bit and arithmetic shift back down
+    return ((int32_t)(rawValue << 8)) >> 8;
+}
+
+ADS123X_ERROR_t ADS123X_convertToUnits(ADS123X *device, int32_t value, float *units)
+{
+    if (device->scaleFactor == 0)
+    {
+        return DIVIDED_by_ZERO;
     }
 
-    *value = readValue;
+    *units = ((float)value - device->offset) / device->scaleFactor;
+
     return NoERROR;
 }
 
+ADS123X_ERROR_t ADS123X_convertToMilligrams(ADS123X *device, int32_t value, int32_t *milligrams)
+{
+    if (device->milligramsPerCode == 0)
+    {
+        return DIVIDED_by_ZERO;
+    }
+
+    int64_t difference = ((int64_t)value << ADS123X_OFFSET_FRACTIONAL_BITS) - device->offsetCode;
+
+    // clamped before the multiply, which then can't overflow either
+    if (difference > device->maxCodeDifference)
+    {
+        difference = device->maxCodeDifference;
+    }
+    else if (difference < -device->maxCodeDifference)
+    {
+        difference = -device->maxCodeDifference;
+    }
+
+    int64_t product = difference * device->milligramsPerCode;
+
+    *milligrams = (int32_t)(product >> (ADS123X_MILLIGRAMS_PER_CODE_FRACTIONAL_BITS + ADS123X_OFFSET_FRACTIONAL_BITS - ADS123X_MILLIGRAM_FRACTIONAL_BITS));
+
+    return NoERROR;
+}
 
 void ADS123X_setGain(ADS123X *device, ADS123X_GAIN_t gain)
 {
@@ -114,22 +158,59 @@ void ADS123X_setSpeed(ADS123X *device, ADS123X_SPEED_t speed)
     }
 }
 
-ADS123X_ERROR_t ADS123X_readAverage(ADS123X *device, float *value, uint8_t times)
+void ADS123X_averageStart(ADS123X_average *average, uint16_t times)
+{
+  average->sum = 0;
+  average->count = 0;
+  average->times = times;
+}
+
+bool ADS123X_averageAdd(ADS123X_average *average, int32_t value)
+{
+  if (average->count < average->times)
+  {
+    average->sum += value;
+    average->count++;
+  }
+
+  return ADS123X_averageComplete(average);
+}
+
+bool ADS123X_averageComplete(ADS123X_average *average)
+{
+  return average->times > 0 && average->count >= average->times;
+}
+
+float ADS123X_averageGet(ADS123X_average *average)
+{
+  if (average->count == 0)
+  {
+    return 0.0f;
+  }
+
+  return (float)average->sum/(float)average->count;
+}
+
+ADS123X_ERROR_t ADS123X_readAverage(ADS123X *device, ADS123X_average *average, float *value)
 {
-  int32_t sum = 0;
-  
   int32_t readValue;
 
-  for(uint16_t index = 0; index < times;)
+  if (!ADS123X_averageComplete(average))
   {
-    if(ADS123X_read(device, &readValue) == NoERROR)
+    ADS123X_ERROR_t err = ADS123X_read(device, &readValue);
+
+    if (err != NoERROR)
     {
-        sum += readValue;
-        index++;
+      return err == SENSOR_NOT_READY ? WOULD_BLOCK : err;
+    }
+
+    if (!ADS123X_averageAdd(average, readValue))
+    {
+      return WOULD_BLOCK;
     }
   }
 
-  *value = (float)sum/(float)times;
+  *value = ADS123X_averageGet(average);
 
   return NoERROR;
 }
@@ -161,37 +242,63 @@ void ADS123X_PowerOff(ADS123X *device)
   nrf_gpio_cfg_default(device->pin_SPEED);
 }
 
-ADS123X_ERROR_t ADS123X_tare(ADS123X *device, uint8_t times)
+ADS123X_ERROR_t ADS123X_tare(ADS123X *device, ADS123X_average *average)
 {
-  int32_t readValue = 0;
+  float value;
+  ADS123X_ERROR_t err = ADS123X_readAverage(device, average, &value);
 
-  int32_t sum = 0;
+  if (err != NoERROR) return err;
 
-  for( uint32_t index = 0; index < times; )
-  {
-    if(ADS123X_read(device, &readValue) == NoERROR)
-    {
-        sum += readValue;
-        index++;
-    }
-  }
-
-  ADS123X_setOffset(device, sum/times);
+  ADS123X_setOffset(device, value);
   return NoERROR;
 }
 
 void ADS123X_setOffset(ADS123X *device, float offset)
 {
   device->offset = offset;
+  device->offsetCode = llroundf(offset * (float)(1UL << ADS123X_OFFSET_FRACTIONAL_BITS));
 }
 
 float ADS123X_getOffset(ADS123X *device) {
   return device->offset;
 }
 
+void ADS123X_setOffsetCode(ADS123X *device, int64_t offsetCode)
+{
+  device->offsetCode = offsetCode;
+  device->offset = (float)offsetCode / (float)(1UL << ADS123X_OFFSET_FRACTIONAL_BITS);
+}
+
+int64_t ADS123X_getOffsetCode(ADS123X *device) {
+  return device->offsetCode;
+}
+
 void ADS123X_setScaleFactor(ADS123X *device, float scaleFactor)
 {
   device->scaleFactor = scaleFactor;
+
+  device->milligramsPerCode = 0;
+  device->maxCodeDifference = 0;
+
+  if (scaleFactor == 0)
+  {
+    return;
+  }
+
+  // scale factors too small to represent leave the fixed point conversion disabled
+  float milligramsPerCode = 1000.0f / scaleFactor * (float)(1UL << ADS123X_MILLIGRAMS_PER_CODE_FRACTIONAL_BITS);
+
+  if (fabsf(milligramsPerCode) < (float)INT32_MAX)
+  {
+    device->milligramsPerCode = (int32_t)lroundf(milligramsPerCode);
+  }
+
+  if (device->milligramsPerCode != 0)
+  {
+    int64_t milligramsPerCodeMagnitude = device->milligramsPerCode < 0 ? -(int64_t)device->milligramsPerCode : device->milligramsPerCode;
+
+    device->maxCodeDifference = ((int64_t)ADS123X_MILLIGRAMS_MAX << (ADS123X_MILLIGRAMS_PER_CODE_FRACTIONAL_BITS + ADS123X_OFFSET_FRACTIONAL_BITS)) / milligramsPerCodeMagnitude;
+  }
 }
 
 float ADS123X_getScaleFactor(ADS123X *device)
@@ -199,12 +306,12 @@ float ADS123X_getScaleFactor(ADS123X *device)
   return device->scaleFactor;
 }
 
-ADS123X_ERROR_t ADS123X_getUnits(ADS123X *device, float *value, uint8_t times)
+ADS123X_ERROR_t ADS123X_getUnits(ADS123X *device, ADS123X_average *average, float *value)
 {
   float val = 0;
   ADS123X_ERROR_t err;
   
-  err = ADS123X_getValue(device, &val, times);
+  err = ADS123X_getValue(device, average, &val);
 
   if(err!=NoERROR) return err;
   
@@ -216,20 +323,12 @@ ADS123X_ERROR_t ADS123X_getUnits(ADS123X *device, float *value, uint8_t times)
   return err;
 }
 
-ADS123X_ERROR_t ADS123X_getValue(ADS123X *device, float *value, uint8_t times)
+ADS123X_ERROR_t ADS123X_getValue(ADS123X *device, ADS123X_average *average, float *value)
 {
   float readValue = 0.0;
-  ADS123X_ERROR_t err;
-  if (times == 1)
-  {
-    uint32_t val;
-    err = ADS123X_read(device, &val);
-    readValue = (float)val;
-  }
-  else
-  {
-    err = ADS123X_readAverage(device, &readValue, times);
-  }
+  ADS123X_ERROR_t err = ADS123X_readAverage(device, average, &readValue);
+
+  if(err!=NoERROR) return err;
 
   *value = readValue - ADS123X_getOffset(device);
 
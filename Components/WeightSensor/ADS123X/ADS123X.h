@@ -16,6 +16,19 @@ typedef enum ADS123X_ERROR_t {
   SENSOR_NOT_READY,    
 } ADS123X_ERROR_t;
 
+// fractional bits of the fixed point weight returned by ADS123X_convertToMilligrams. 7 leaves int32 room for
+// +-16.7 kg, headroom over ADS123X_MILLIGRAMS_MAX for the filters to overshoot into
+#define ADS123X_MILLIGRAM_FRACTIONAL_BITS   7
+
+// fixed point weights saturate at +-12 kg, above the heaviest calibration mass of 10 kg
+#define ADS123X_MILLIGRAMS_MAX              12000000L
+
+// fractional bits of offsetCode, so zero tracking can move the offset by less than a code
+#define ADS123X_OFFSET_FRACTIONAL_BITS      8
+
+// fractional bits of milligramsPerCode
+#define ADS123X_MILLIGRAMS_PER_CODE_FRACTIONAL_BITS 24
+
 typedef enum ADS123X_SPEED_t 
 {
     SPEED_10SPS,
@@ -45,8 +58,23 @@ typedef struct ADS123X
   float offset;
   bool calibrateOnNextConversion;
 
+  // integer copies of offset and 1/scaleFactor for the fixed point conversion, and the distance from the
+  // offset (same format as offsetCode) at which the weight reaches ADS123X_MILLIGRAMS_MAX
+  int64_t offsetCode;
+  int32_t milligramsPerCode;
+  int64_t maxCodeDifference;
+
 } ADS123X;
 
+// running average of conversions, filled one DRDY at a time
+typedef struct ADS123X_average
+{
+  int64_t sum;
+  uint16_t count;
+  uint16_t times;
+
+} ADS123X_average;
+
 // Initialize library
 void ADS123X_Init(ADS123X *device, uint8_t pin_DOUT, uint8_t pin_SCLK, uint8_t pin_PDWN, uint8_t pin_GAIN0, uint8_t pin_GAIN1, uint8_t pin_SPEED);
 
@@ -58,22 +86,44 @@ bool ADS123X_IsReady(ADS123X *device);
 // waits for the chip to be ready and returns a reading
 ADS123X_ERROR_t ADS123X_read(ADS123X *device, int32_t *value);
 
+// sign extend a 24-bit two's complement conversion word
+int32_t ADS123X_signExtend(uint32_t rawValue);
+
+// returns (value - OFFSET) divided by scaleFactor for a conversion that has already been read
+ADS123X_ERROR_t ADS123X_convertToUnits(ADS123X *device, int32_t value, float *units);
+
+// returns (value - OFFSET) in milligrams with ADS123X_MILLIGRAM_FRACTIONAL_BITS fractional bits, using integer math only.
+// Saturates at +-ADS123X_MILLIGRAMS_MAX
+ADS123X_ERROR_t ADS123X_convertToMilligrams(ADS123X *device, int32_t value, int32_t *milligrams);
+
 void ADS123X_setGain(ADS123X *device, ADS123X_GAIN_t gain);
 
 void ADS123X_setSpeed(ADS123X *device, ADS123X_SPEED_t speed);
 
-// returns an average reading; times = how many times to read
-ADS123X_ERROR_t ADS123X_readAverage(ADS123X *device, float *value, uint8_t times);
+// start a new average; times = how many conversions to average
+void ADS123X_averageStart(ADS123X_average *average, uint16_t times);
+
+// add a conversion that has already been read, returns true once the average is complete
+bool ADS123X_averageAdd(ADS123X_average *average, int32_t value);
+
+bool ADS123X_averageComplete(ADS123X_average *average);
+
+float ADS123X_averageGet(ADS123X_average *average);
 
-// returns (read_average() - OFFSET), that is the current value without the tare weight; times = how many readings to do
-ADS123X_ERROR_t ADS123X_getValue(ADS123X *device, float *value, uint8_t times);
+// none of the following wait for the chip. Each call reads a conversion if one is ready and returns
+// WOULD_BLOCK until the average started with ADS123X_averageStart is complete, so call them on DRDY
+
+// returns an average reading
+ADS123X_ERROR_t ADS123X_readAverage(ADS123X *device, ADS123X_average *average, float *value);
+
+// returns (read_average() - OFFSET), that is the current value without the tare weight
+ADS123X_ERROR_t ADS123X_getValue(ADS123X *device, ADS123X_average *average, float *value);
 
 // returns getValue() divided by scaleFactor, that is the raw value divided by a value obtained via calibration
-// times = how many readings to do
-ADS123X_ERROR_t ADS123X_getUnits(ADS123X *device, float *value, uint8_t times);
+ADS123X_ERROR_t ADS123X_getUnits(ADS123X *device, ADS123X_average *average, float *value);
 
-// set the OFFSET value for tare weight; times = how many times to read the tare value
-ADS123X_ERROR_t ADS123X_tare(ADS123X *device, uint8_t times);
+// set the OFFSET value for tare weight once the average is complete
+ADS123X_ERROR_t ADS123X_tare(ADS123X *device, ADS123X_average *average);
 
 // set the scaleFactor value; this value is used to convert the raw data to "human readable" data (measure units)
 void ADS123X_setScaleFactor(ADS123X *device, float scaleFactor);
@@ -85,6 +135,12 @@ void ADS123X_setOffset(ADS123X *device, float offset);
 
 float ADS123X_getOffset(ADS123X *device);
 
+// OFFSET with ADS123X_OFFSET_FRACTIONAL_BITS fractional bits. Keeps fractions of a code at offsets too large for
+// the float OFFSET to hold them
+void ADS123X_setOffsetCode(ADS123X *device, int64_t offsetCode);
+
+int64_t ADS123X_getOffsetCode(ADS123X *device);
+
 // puts the chip into power down mode
 void ADS123X_PowerOff(ADS123X *device);
 
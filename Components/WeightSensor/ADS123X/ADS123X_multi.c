@@ -0,0 +1,162 @@
+#include "ADS123X_multi.h"
+#include "nrf_delay.h"
+
+#include <math.h>
+
+bool ADS123X_multi_Init(ADS123X_multi *multi, ADS123X *device, const uint8_t *pin_DOUT, uint8_t channelCount)
+{
+    if (channelCount == 0 || channelCount > ADS123X_MULTI_MAX_CHANNELS || pin_DOUT[0] != device->pin_DOUT)
+    {
+        return false;
+    }
+
+    multi->device = device;
+    multi->channelCount = channelCount;
+    multi->doutMask = 0;
+
+    for (uint8_t i = 0; i < channelCount; i++)
+    {
+        uint32_t pin = pin_DOUT[i];
+        NRF_GPIO_Type *port = nrf_gpio_pin_port_decode(&pin);
+
+        if (i == 0)
+        {
+            multi->port = port;
+        }
+        else if (port != multi->port)
+        {
+            return false;
+        }
+
+        multi->pin_DOUT[i] = pin_DOUT[i];
+        multi->doutBit[i] = (uint8_t)pin;
+        multi->doutMask |= (1UL << pin);
+
+        multi->channelOffset[i] = 0.0f;
+        multi->channelScale[i] = 1.0f;
+        multi->lastChannelValues[i] = 0;
+    }
+
+    return true;
+}
+
+bool ADS123X_multi_IsReady(ADS123X_multi *multi)
+{
+    return (nrf_gpio_port_in_read(multi->port) & multi->doutMask) == 0U;
+}
+
+ADS123X_ERROR_t ADS123X_multi_read(ADS123X_multi *multi, int32_t *value)
+{
+    if (!ADS123X_multi_IsReady(multi))
+    {
+        return SENSOR_NOT_READY;
+    }
+
+    ADS123X *device = multi->device;
+    uint32_t readValues[ADS123X_MULTI_MAX_CHANNELS] = {0};
+
+    // Read 24 bits MSB first, one port read per bit for every channel
+    for (int i = 23; i >= 0; i--) {
+        nrf_gpio_pin_set(device->pin_SCLK);
+        uint32_t in = nrf_gpio_port_in_read(multi->port);
+        nrf_delay_us(2);
+        nrf_gpio_pin_clear(device->pin_SCLK);
+
+        for (uint8_t channel = 0; channel < multi->channelCount; channel++)
+        {
+            readValues[channel] = (readValues[channel] << 1) | ((in >> multi->doutBit[channel]) & 1U);
+        }
+    }
+
+    // Extra clock pulse to complete transmission
+    nrf_gpio_pin_set(device->pin_SCLK);
+    nrf_gpio_pin_clear(device->pin_SCLK);
+
+    // Optional self-calibration trigger
+    if (device->calibrateOnNextConversion)
+    {
+        nrf_gpio_pin_set(device->pin_SCLK);
+        nrf_gpio_pin_clear(device->pin_SCLK);
+        device->calibrateOnNextConversion = false;
+    }
+
+    float sum = 0.0f;
+
+    for (uint8_t channel = 0; channel < multi->channelCount; channel++)
+    {
+        int32_t channelValue = ADS123X_signExtend(readValues[channel]);
+
+        multi->lastChannelValues[channel] = channelValue;
+        sum += ((float)channelValue - multi->channelOffset[channel]) * multi->channelScale[channel];
+    }
+
+    *value = (int32_t)lroundf(sum);
+
+    return NoERROR;
+}
+
+int32_t ADS123X_multi_getChannelValue(ADS123X_multi *multi, uint8_t channel)
+{
+    if (channel >= multi->channelCount)
+    {
+        return 0;
+    }
+
+    return multi->lastChannelValues[channel];
+}
+
+void ADS123X_multi_setChannelOffset(ADS123X_multi *multi, uint8_t channel, float offset)
+{
+    if (channel < multi->channelCount)
+    {
+        multi->channelOffset[channel] = offset;
+    }
+}
+
+float ADS123X_multi_getChannelOffset(ADS123X_multi *multi, uint8_t channel)
+{
+    if (channel >= multi->channelCount)
+    {
+        return 0.0f;
+    }
+
+    return multi->channelOffset[channel];
+}
+
+void ADS123X_multi_setChannelScale(ADS123X_multi *multi, uint8_t channel, float scale)
+{
+    if (channel < multi->channelCount)
+    {
+        multi->channelScale[channel] = scale;
+    }
+}
+
+float ADS123X_multi_getChannelScale(ADS123X_multi *multi, uint8_t channel)
+{
+    if (channel >= multi->channelCount)
+    {
+        return 0.0f;
+    }
+
+    return multi->channelScale[channel];
+}
+
+void ADS123X_multi_PowerOn(ADS123X_multi *multi)
+{
+    for (uint8_t channel = 1; channel < multi->channelCount; channel++)
+    {
+        nrf_gpio_cfg_input(multi->pin_DOUT[channel], NRF_GPIO_PIN_NOPULL);
+    }
+
+    ADS123X_PowerOn(multi->device);
+}
+
+void ADS123X_multi_PowerOff(ADS123X_multi *multi)
+{
+    ADS123X_PowerOff(multi->device);
+
+    for (uint8_t channel = 1; channel < multi->channelCount; channel++)
+    {
+        nrf_gpio_cfg_default(multi->pin_DOUT[channel]);
+    }
+}
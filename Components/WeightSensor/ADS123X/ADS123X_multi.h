@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nrf_gpio.h"
+#include "ADS123X.h"
+
+#ifndef ADS123X_MULTI_h
+#define ADS123X_MULTI_h
+
+#define ADS123X_MULTI_MAX_CHANNELS  4
+
+/*
+ * Parallel readout of several ADS123X converters sharing SCLK, PDWN, GAIN and SPEED.
+ *
+ * The shared control pins and the DOUT of the first channel come from device, so the existing single
+ * device API (power, gain, speed, offset and scale factor of the combined weight) still applies. Every
+ * DOUT line must be on the same GPIO port so each data bit of all channels is taken from one port read.
+ *
+ * The converters must be clocked from a common CLKIN so their conversions complete together.
+ */
+typedef struct ADS123X_multi
+{
+  ADS123X *device;
+
+  NRF_GPIO_Type *port;
+  uint8_t channelCount;
+  uint8_t pin_DOUT[ADS123X_MULTI_MAX_CHANNELS];
+  uint8_t doutBit[ADS123X_MULTI_MAX_CHANNELS];   // DOUT pin number within port
+  uint32_t doutMask;                             // all DOUT lines within port
+
+  // per channel zero and relative gain applied before the channels are summed
+  float channelOffset[ADS123X_MULTI_MAX_CHANNELS];
+  float channelScale[ADS123X_MULTI_MAX_CHANNELS];
+
+  int32_t lastChannelValues[ADS123X_MULTI_MAX_CHANNELS];
+
+} ADS123X_multi;
+
+// pin_DOUT[0] must be the DOUT pin of device. returns false if the channels don't fit or aren't on one port
+bool ADS123X_multi_Init(ADS123X_multi *multi, ADS123X *device, const uint8_t *pin_DOUT, uint8_t channelCount);
+
+// true once every channel has a conversion ready
+bool ADS123X_multi_IsReady(ADS123X_multi *multi);
+
+// clock out all channels together and return the sum of the trimmed channel codes
+ADS123X_ERROR_t ADS123X_multi_read(ADS123X_multi *multi, int32_t *value);
+
+// raw code of a channel from the last ADS123X_multi_read
+int32_t ADS123X_multi_getChannelValue(ADS123X_multi *multi, uint8_t channel);
+
+void ADS123X_multi_setChannelOffset(ADS123X_multi *multi, uint8_t channel, float offset);
+
+float ADS123X_multi_getChannelOffset(ADS123X_multi *multi, uint8_t channel);
+
+// relative gain of a channel, used to match the sensitivity of the load cells (1.0 by default)
+void ADS123X_multi_setChannelScale(ADS123X_multi *multi, uint8_t channel, float scale);
+
+float ADS123X_multi_getChannelScale(ADS123X_multi *multi, uint8_t channel);
+
+// powers the shared device and configures the DOUT inputs of the other channels
+void ADS123X_multi_PowerOn(ADS123X_multi *multi);
+
+void ADS123X_multi_PowerOff(ADS123X_multi *multi);
+
+#endif /* #ifndef ADS123X_MULTI_h */
@@ -0,0 +1,146 @@
+#include "ADS123X_spim.h"
+#include "sdk_common.h"
+#include "app_error.h"
+#include "nrf_gpio.h"
+#include "nrf_delay.h"
+#include "nrf_spim.h"
+#include "nrf_drv_gpiote.h"
+
+static ret_code_t ADS123X_spim_arm(ADS123X_spim *reader)
+{
+    nrfx_spim_xfer_desc_t xfer = NRFX_SPIM_XFER_RX(reader->rxBuffer, ADS123X_SPIM_DATA_BYTES);
+
+    // Set up the transfer but leave it for the DRDY event to start over PPI
+    return nrfx_spim_xfer(&reader->spim, &xfer, NRFX_SPIM_FLAG_HOLD_XFER);
+}
+
+// Apply the 25th SCLK pulse (and 26th if a self calibration is pending) once the data bits have been clocked out.
+// The SPIM is disabled for the duration so SCLK falls back to its GPIO configuration.
+static void ADS123X_spim_complete_conversion(ADS123X_spim *reader)
+{
+    ADS123X *device = reader->device;
+
+    nrf_spim_disable(reader->spim.p_reg);
+
+    // The ADS123X needs SCLK held high and low for at least 100 ns each
+    nrf_gpio_pin_set(device->pin_SCLK);
+    nrf_delay_us(1);
+    nrf_gpio_pin_clear(device->pin_SCLK);
+    nrf_delay_us(1);
+
+    if (device->calibrateOnNextConversion)
+    {
+        nrf_gpio_pin_set(device->pin_SCLK);
+        nrf_delay_us(1);
+        nrf_gpio_pin_clear(device->pin_SCLK);
+        nrf_delay_us(1);
+        device->calibrateOnNextConversion = false;
+    }
+
+    nrf_spim_enable(reader->spim.p_reg);
+}
+
+static void ADS123X_spim_event_handler(nrfx_spim_evt_t const * p_event, void * p_context)
+{
+    ADS123X_spim *reader = (ADS123X_spim *)p_context;
+
+    if (p_event->type != NRFX_SPIM_EVENT_DONE || !reader->enabled)
+    {
+        return;
+    }
+
+    ADS123X_spim_complete_conversion(reader);
+
+    uint32_t rawValue = ((uint32_t)reader->rxBuffer[0] << 16) |
+                        ((uint32_t)reader->rxBuffer[1] << 8) |
+                        (uint32_t)reader->rxBuffer[2];
+
+    int32_t value = ADS123X_signExtend(rawValue);
+
+    // Re-arm before handing the value on so the next DRDY edge is never missed
+    ret_code_t err_code = ADS123X_spim_arm(reader);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrfx_ppi_group_enable(reader->ppi_group);
+    APP_ERROR_CHECK(err_code);
+
+    if (reader->dataHandler != NULL)
+    {
+        reader->dataHandler(value);
+    }
+}
+
+ret_code_t ADS123X_spim_init(ADS123X_spim *reader, ADS123X *device, nrfx_spim_t spim, ADS123X_spim_data_handler_t dataHandler)
+{
+    ret_code_t err_code;
+
+    reader->device = device;
+    reader->spim = spim;
+    reader->dataHandler = dataHandler;
+    reader->enabled = false;
+
+    err_code = nrfx_ppi_channel_alloc(&reader->ppi_channel);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrfx_ppi_group_alloc(&reader->ppi_group);
+    VERIFY_SUCCESS(err_code);
+
+    // DRDY -> SPIM START, forked to disable the group so the data bits on DOUT can't retrigger the transfer
+    err_code = nrfx_ppi_channel_assign(reader->ppi_channel,
+                                       nrf_drv_gpiote_in_event_addr_get(device->pin_DOUT),
+                                       nrfx_spim_start_task_get(&reader->spim));
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrfx_ppi_channel_fork_assign(reader->ppi_channel, nrfx_ppi_task_addr_group_disable_get(reader->ppi_group));
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrfx_ppi_channel_include_in_group(reader->ppi_channel, reader->ppi_group);
+    VERIFY_SUCCESS(err_code);
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t ADS123X_spim_enable(ADS123X_spim *reader)
+{
+    ret_code_t err_code;
+
+    nrfx_spim_config_t spi_config = NRFX_SPIM_DEFAULT_CONFIG;
+
+    spi_config.sck_pin   = reader->device->pin_SCLK;
+    spi_config.miso_pin  = reader->device->pin_DOUT;
+    spi_config.mosi_pin  = NRFX_SPIM_PIN_NOT_USED;
+    spi_config.ss_pin    = NRFX_SPIM_PIN_NOT_USED;
+    spi_config.frequency = ADS123X_SPIM_FREQUENCY;
+    // ADS123X shifts data out on the SCLK rising edge, so sample on the falling edge
+    spi_config.mode      = NRF_SPIM_MODE_1;
+    spi_config.bit_order = NRF_SPIM_BIT_ORDER_MSB_FIRST;
+
+    err_code = nrfx_spim_init(&reader->spim, &spi_config, ADS123X_spim_event_handler, reader);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = ADS123X_spim_arm(reader);
+    VERIFY_SUCCESS(err_code);
+
+    reader->enabled = true;
+
+    err_code = nrfx_ppi_channel_enable(reader->ppi_channel);
+    VERIFY_SUCCESS(err_code);
+
+    return nrfx_ppi_group_enable(reader->ppi_group);
+}
+
+void ADS123X_spim_disable(ADS123X_spim *reader)
+{
+    reader->enabled = false;
+
+    UNUSED_RETURN_VALUE(nrfx_ppi_group_disable(reader->ppi_group));
+    UNUSED_RETURN_VALUE(nrfx_ppi_channel_disable(reader->ppi_channel));
+
+    nrfx_spim_abort(&reader->spim);
+    nrfx_spim_uninit(&reader->spim);
+}
+
+uint32_t ADS123X_spim_readout_started_event_get(ADS123X_spim *reader)
+{
+    return nrf_spim_event_address_get(reader->spim.p_reg, NRF_SPIM_EVENT_STARTED);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nrfx_spim.h"
+#include "nrfx_ppi.h"
+#include "ADS123X.h"
+
+#ifndef ADS123X_SPIM_h
+#define ADS123X_SPIM_h
+
+// number of bytes clocked out of the ADS123X per conversion (24 data bits)
+#define ADS123X_SPIM_DATA_BYTES     3
+
+// SCLK frequency used for the hardware readout. The ADS123X allows SCLK high/low times down to 100ns
+#define ADS123X_SPIM_FREQUENCY      NRF_SPIM_FREQ_1M
+
+typedef void (*ADS123X_spim_data_handler_t)(int32_t value);
+
+/*
+ * Hardware clocked ADS123X readout.
+ *
+ * The DRDY (DOUT falling edge) GPIOTE event starts a SPIM transfer over PPI so the 24 data bits are
+ * clocked by the peripheral instead of being bit-banged in the interrupt. The same PPI event disables
+ * the PPI channel group so the data bits toggling DOUT can't restart the transfer. The CPU is only
+ * woken by the SPIM END event, once the conversion word is in RAM, to apply the 25th (and optional
+ * 26th calibration) clock and re-arm the chain.
+ *
+ * The GPIOTE input for device->pin_DOUT must be initialised before ADS123X_spim_init is called.
+ */
+typedef struct ADS123X_spim
+{
+  ADS123X *device;
+  nrfx_spim_t spim;
+
+  nrf_ppi_channel_t ppi_channel;
+  nrf_ppi_channel_group_t ppi_group;
+
+  uint8_t rxBuffer[ADS123X_SPIM_DATA_BYTES];
+
+  ADS123X_spim_data_handler_t dataHandler;
+  bool enabled;
+
+} ADS123X_spim;
+
+// allocate the PPI resources for the readout. The SPIM instance is only initialised by ADS123X_spim_enable
+ret_code_t ADS123X_spim_init(ADS123X_spim *reader, ADS123X *device, nrfx_spim_t spim, ADS123X_spim_data_handler_t dataHandler);
+
+// take ownership of SCLK/DOUT, arm the transfer and enable the DRDY -> SPIM START chain
+ret_code_t ADS123X_spim_enable(ADS123X_spim *reader);
+
+// disable the DRDY -> SPIM START chain and release the SPIM instance
+void ADS123X_spim_disable(ADS123X_spim *reader);
+
+// address of the event generated when a conversion readout starts, for timestamping over PPI
+uint32_t ADS123X_spim_readout_started_event_get(ADS123X_spim *reader);
+
+#endif /* #ifndef ADS123X_SPIM_h */
@@ -0,0 +1,77 @@
+#include "calibration_table.h"
+
+#include <math.h>
+#include <string.h>
+
+void calibration_table_reset(calibration_table_t *table)
+{
+    memset(table, 0, sizeof(*table));
+}
+
+bool calibration_table_add(calibration_table_t *table, float reading, float mass)
+{
+    uint8_t i;
+
+    if (!(reading > 0.0f) || !(mass > 0.0f))
+    {
+        return false;
+    }
+
+    // A repeat of an existing point replaces it
+    for (i = 0; i < table->count; i++)
+    {
+        if (fabsf(table->reading[i] - reading) < CALIBRATION_TABLE_MIN_SPACING)
+        {
+            table->reading[i] = reading;
+            table->mass[i] = mass;
+            return true;
+        }
+    }
+
+    if (table->count >= CALIBRATION_TABLE_MAX_POINTS)
+    {
+        return false;
+    }
+
+    // Insertion keeps the readings ascending
+    for (i = table->count; i > 0 && table->reading[i - 1] > reading; i--)
+    {
+        table->reading[i] = table->reading[i - 1];
+        table->mass[i] = table->mass[i - 1];
+    }
+
+    table->reading[i] = reading;
+    table->mass[i] = mass;
+    table->count++;
+
+    return true;
+}
+
+float calibration_table_apply(const calibration_table_t *table, float grams)
+{
+    uint8_t count = table->count;
+
+    if (count == 0)
+    {
+        return grams;
+    }
+
+    // Below the first point the error scales down to zero at zero, negative readings included
+    if (grams <= table->reading[0])
+    {
+        return grams * table->mass[0] / table->reading[0];
+    }
+
+    for (uint8_t i = 1; i < count; i++)
+    {
+        if (grams <= table->reading[i])
+        {
+            float t = (grams - table->reading[i - 1]) / (table->reading[i] - table->reading[i - 1]);
+            float error = (table->mass[i - 1] - table->reading[i - 1]) + t * ((table->mass[i] - table->reading[i]) - (table->mass[i - 1] - table->reading[i - 1]));
+
+            return grams + error;
+        }
+    }
+
+    return grams * table->mass[count - 1] / table->reading[count - 1];
+}
@@ -0,0 +1,31 @@
+#ifndef CALIBRATION_TABLE_h
+#define CALIBRATION_TABLE_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CALIBRATION_TABLE_MAX_POINTS    8
+
+// Minimum spacing of the points in grams, a point closer than this to an existing one replaces it
+#define CALIBRATION_TABLE_MIN_SPACING   1.0f
+
+// Piecewise linear nonlinearity correction of a span calibrated reading.
+//
+// Each point maps the reading taken with the span calibration to the reference mass that was on the platform.
+// The error between them is interpolated linearly between points, through zero below the first point and in
+// proportion to the reading above the last one. An empty table leaves the reading untouched.
+typedef struct
+{
+    uint8_t count;
+    float reading[CALIBRATION_TABLE_MAX_POINTS];    // g, ascending
+    float mass[CALIBRATION_TABLE_MAX_POINTS];       // g
+} calibration_table_t;
+
+void calibration_table_reset(calibration_table_t *table);
+
+// Returns false if the reading isn't positive or the table is full
+bool calibration_table_add(calibration_table_t *table, float reading, float mass);
+
+float calibration_table_apply(const calibration_table_t *table, float grams);
+
+#endif
@@ -0,0 +1,131 @@
+#include "load_cell_compensation.h"
+
+#include <math.h>
+#include <string.h>
+
+void load_cell_compensation_init(load_cell_compensation_t *compensation, const load_cell_compensation_coefficients_t *coefficients)
+{
+    memset(compensation, 0, sizeof(*compensation));
+    compensation->coefficients = *coefficients;
+    compensation->enabled = true;
+}
+
+void load_cell_compensation_set_temperature(load_cell_compensation_t *compensation, float temperature)
+{
+    if (!compensation->temperature_valid)
+    {
+        compensation->tare_temperature = temperature;
+        compensation->temperature_valid = true;
+    }
+
+    compensation->temperature = temperature;
+}
+
+void load_cell_compensation_tare(load_cell_compensation_t *compensation)
+{
+    compensation->tare_temperature = compensation->temperature;
+    compensation->creep = 0.0f;
+}
+
+float load_cell_compensation_apply(load_cell_compensation_t *compensation, float grams, float dt)
+{
+    const load_cell_compensation_coefficients_t *c = &compensation->coefficients;
+
+    if (!compensation->enabled)
+    {
+        return grams;
+    }
+
+    if (compensation->temperature_valid)
+    {
+        grams -= c->offset_tempco * (compensation->temperature - compensation->tare_temperature);
+
+        float span = 1.0f + c->span_tempco * (compensation->temperature - c->span_reference_temperature);
+        if (span > 0.0f)
+        {
+            grams /= span;
+        }
+    }
+
+    if (c->creep_coefficient != 0.0f && c->creep_time_constant > 0.0f && dt > 0.0f)
+    {
+        float alpha = fminf(dt / c->creep_time_constant, 1.0f);
+        compensation->creep += (c->creep_coefficient * grams - compensation->creep) * alpha;
+        grams -= compensation->creep;
+    }
+
+    return grams;
+}
+
+void load_cell_temperature_fit_reset(load_cell_temperature_fit_t *fit)
+{
+    memset(fit, 0, sizeof(*fit));
+}
+
+void load_cell_temperature_fit_add(load_cell_temperature_fit_t *fit, float temperature, float grams)
+{
+    if (fit->count == 0)
+    {
+        // Sums relative to the first temperature so they stay well conditioned in float
+        fit->temperature_reference = temperature;
+        fit->min_temperature = temperature;
+        fit->max_temperature = temperature;
+    }
+
+    float t = temperature - fit->temperature_reference;
+
+    fit->sum_t += t;
+    fit->sum_y += grams;
+    fit->sum_tt += t * t;
+    fit->sum_ty += t * grams;
+    fit->min_temperature = fminf(fit->min_temperature, temperature);
+    fit->max_temperature = fmaxf(fit->max_temperature, temperature);
+    fit->count++;
+}
+
+bool load_cell_temperature_fit_get(load_cell_temperature_fit_t *fit, float minRange, float *slope, float *mean, float *meanTemperature)
+{
+    if (fit->count < 3 || (fit->max_temperature - fit->min_temperature) < minRange)
+    {
+        return false;
+    }
+
+    float n = (float)fit->count;
+    float denominator = n * fit->sum_tt - fit->sum_t * fit->sum_t;
+
+    if (denominator <= 0.0f)
+    {
+        return false;
+    }
+
+    *slope = (n * fit->sum_ty - fit->sum_t * fit->sum_y) / denominator;
+    *mean = fit->sum_y / n;
+    *meanTemperature = fit->temperature_reference + fit->sum_t / n;
+
+    return true;
+}
+
+bool load_cell_creep_fit(float first, float second, float third, float interval, float *coefficient, float *timeConstant)
+{
+    float firstRise = second - first;
+    float secondRise = third - second;
+
+    // A first order creep rises by the same ratio every interval
+    if (first == 0.0f || interval <= 0.0f || firstRise == 0.0f)
+    {
+        return false;
+    }
+
+    float ratio = secondRise / firstRise;
+
+    if (!(ratio > 0.0f && ratio < 1.0f))
+    {
+        return false;
+    }
+
+    *timeConstant = -interval / logf(ratio);
+    // Creep still to come at the first reading, relative to the load
+    *coefficient = firstRise / (1.0f - ratio) / first;
+
+    return true;
+}
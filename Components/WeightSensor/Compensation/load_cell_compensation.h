@@ -0,0 +1,67 @@
+#ifndef LOAD_CELL_COMPENSATION_h
+#define LOAD_CELL_COMPENSATION_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Temperature and creep compensation of a load cell reading.
+//
+//   reading = true * (1 + span_tempco * (T - T_calibration)) + offset_tempco * (T - T_tare) + creep
+//
+// where creep follows creep_coefficient * load with a first order lag of creep_time_constant, both as the
+// load is applied and as it is removed. All zero coefficients leave the reading untouched.
+
+typedef struct
+{
+    float offset_tempco;                // g per degree C of zero drift
+    float span_tempco;                  // fractional change in span per degree C
+    float span_reference_temperature;   // degrees C the scale factor was calibrated at
+    float creep_coefficient;            // creep as a fraction of the load
+    float creep_time_constant;          // s
+} load_cell_compensation_coefficients_t;
+
+typedef struct
+{
+    load_cell_compensation_coefficients_t coefficients;
+    bool enabled;
+
+    bool temperature_valid;
+    float temperature;
+    float tare_temperature;
+
+    float creep;                        // g currently included in the reading
+} load_cell_compensation_t;
+
+void load_cell_compensation_init(load_cell_compensation_t *compensation, const load_cell_compensation_coefficients_t *coefficients);
+
+// Latest load cell temperature. The first one also becomes the tare temperature if there has been no tare since
+void load_cell_compensation_set_temperature(load_cell_compensation_t *compensation, float temperature);
+
+// The zero was just taken, offset drift and creep restart from here
+void load_cell_compensation_tare(load_cell_compensation_t *compensation);
+
+// Compensate a reading in grams taken dt seconds after the previous one
+float load_cell_compensation_apply(load_cell_compensation_t *compensation, float grams, float dt);
+
+
+// Least squares fit of reading against temperature, used to learn the temperature coefficients
+typedef struct
+{
+    uint16_t count;
+    float temperature_reference;
+    float sum_t, sum_y, sum_tt, sum_ty;
+    float min_temperature, max_temperature;
+} load_cell_temperature_fit_t;
+
+void load_cell_temperature_fit_reset(load_cell_temperature_fit_t *fit);
+
+void load_cell_temperature_fit_add(load_cell_temperature_fit_t *fit, float temperature, float grams);
+
+// Slope in g per degree C and the mean reading. Returns false without enough points or temperature range
+bool load_cell_temperature_fit_get(load_cell_temperature_fit_t *fit, float minRange, float *slope, float *mean, float *meanTemperature);
+
+// Creep from three readings of a constant load taken interval seconds apart, the first after the load settled.
+// Returns false if the readings don't follow a first order creep
+bool load_cell_creep_fit(float first, float second, float third, float interval, float *coefficient, float *timeConstant);
+
+#endif
@@ -0,0 +1,145 @@
+#include "sample_clock.h"
+#include "sdk_common.h"
+#include "app_error.h"
+#include "app_util_platform.h"
+#include "nrfx_rtc.h"
+#include "nrfx_timer.h"
+#include "nrfx_ppi.h"
+
+// CC[0] holds the time since the capture event, read by the readout interrupt
+#define SAMPLE_CLOCK_SINCE_EVENT_CHANNEL    NRF_TIMER_CC_CHANNEL0
+
+#define SAMPLE_CLOCK_RTC_FREQUENCY          32768ULL
+#define SAMPLE_CLOCK_RTC_COUNTER_BITS       24
+
+static const nrfx_rtc_t mSampleRtc = NRFX_RTC_INSTANCE(SAMPLE_CLOCK_RTC_INSTANCE);
+static const nrfx_timer_t mSampleTimer = NRFX_TIMER_INSTANCE(SAMPLE_CLOCK_TIMER_INSTANCE);
+static nrf_ppi_channel_t mCapturePpiChannel;
+static bool mRunning = false;
+
+// Wraps of the 24 bit RTC counter, every 512 s
+static volatile uint32_t mRtcOverflows = 0;
+
+static void sample_clock_rtc_event_handler(nrfx_rtc_int_type_t int_type)
+{
+    if (int_type == NRFX_RTC_INT_OVERFLOW)
+    {
+        mRtcOverflows++;
+    }
+}
+
+static void sample_clock_timer_event_handler(nrf_timer_event_t event_type, void * p_context)
+{
+    // No compare events are used
+}
+
+// Halts the TIMER and clears it for the next capture event to start it from 0
+static void sample_clock_timer_reset()
+{
+    // SHUTDOWN rather than STOP, which would keep the clock requested
+    nrf_timer_task_trigger(mSampleTimer.p_reg, NRF_TIMER_TASK_SHUTDOWN);
+    nrf_timer_task_trigger(mSampleTimer.p_reg, NRF_TIMER_TASK_CLEAR);
+}
+
+ret_code_t sample_clock_init(uint32_t captureEventAddress)
+{
+    ret_code_t err_code;
+
+    nrfx_rtc_config_t rtc_config = NRFX_RTC_DEFAULT_CONFIG;
+    rtc_config.prescaler = RTC_FREQ_TO_PRESCALER(SAMPLE_CLOCK_RTC_FREQUENCY);
+
+    err_code = nrfx_rtc_init(&mSampleRtc, &rtc_config, sample_clock_rtc_event_handler);
+    VERIFY_SUCCESS(err_code);
+
+    nrfx_rtc_overflow_enable(&mSampleRtc, true);
+
+    nrfx_timer_config_t timer_config = NRFX_TIMER_DEFAULT_CONFIG;
+    timer_config.frequency = NRF_TIMER_FREQ_1MHz;
+    timer_config.mode      = NRF_TIMER_MODE_TIMER;
+    timer_config.bit_width = NRF_TIMER_BIT_WIDTH_32;
+
+    err_code = nrfx_timer_init(&mSampleTimer, &timer_config, sample_clock_timer_event_handler);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrfx_ppi_channel_alloc(&mCapturePpiChannel);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrfx_ppi_channel_assign(mCapturePpiChannel,
+                                       captureEventAddress,
+                                       nrfx_timer_task_address_get(&mSampleTimer, NRF_TIMER_TASK_START));
+    VERIFY_SUCCESS(err_code);
+
+    return NRF_SUCCESS;
+}
+
+void sample_clock_start()
+{
+    if (mRunning)
+    {
+        return;
+    }
+
+    nrfx_rtc_counter_clear(&mSampleRtc);
+    mRtcOverflows = 0;
+    nrfx_rtc_enable(&mSampleRtc);
+
+    sample_clock_timer_reset();
+
+    ret_code_t err_code = nrfx_ppi_channel_enable(mCapturePpiChannel);
+    APP_ERROR_CHECK(err_code);
+
+    mRunning = true;
+}
+
+void sample_clock_stop()
+{
+    if (!mRunning)
+    {
+        return;
+    }
+
+    ret_code_t err_code = nrfx_ppi_channel_disable(mCapturePpiChannel);
+    APP_ERROR_CHECK(err_code);
+
+    sample_clock_timer_reset();
+    nrfx_rtc_disable(&mSampleRtc);
+
+    mRunning = false;
+}
+
+uint32_t sample_clock_get_capture()
+{
+    uint32_t now = sample_clock_now();
+
+    nrf_timer_task_trigger(mSampleTimer.p_reg, nrf_timer_capture_task_get(SAMPLE_CLOCK_SINCE_EVENT_CHANNEL));
+    uint32_t sinceEvent = nrf_timer_cc_read(mSampleTimer.p_reg, SAMPLE_CLOCK_SINCE_EVENT_CHANNEL);
+
+    sample_clock_timer_reset();
+
+    return now - sinceEvent;
+}
+
+uint32_t sample_clock_now()
+{
+    uint32_t overflows;
+    uint32_t counter;
+
+    CRITICAL_REGION_ENTER();
+
+    overflows = mRtcOverflows;
+    counter = nrfx_rtc_counter_get(&mSampleRtc);
+
+    // Wrapped since the overflow interrupt last ran, read the counter again now it is past the wrap
+    if (nrf_rtc_event_pending(mSampleRtc.p_reg, NRF_RTC_EVENT_OVERFLOW))
+    {
+        overflows++;
+        counter = nrfx_rtc_counter_get(&mSampleRtc);
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    uint64_t ticks = ((uint64_t)overflows << SAMPLE_CLOCK_RTC_COUNTER_BITS) | counter;
+
+    // Wraps at 2^32 us like the TIMER it replaces, differences of timestamps stay valid across the wrap
+    return (uint32_t)((ticks * SAMPLE_CLOCK_TICKS_PER_SECOND) / SAMPLE_CLOCK_RTC_FREQUENCY);
+}
@@ -0,0 +1,39 @@
+#ifndef SAMPLE_CLOCK_h
+#define SAMPLE_CLOCK_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdk_errors.h"
+
+// Microsecond clock used to timestamp ADC conversions, counted by an RTC from the 32.768 kHz clock.
+// The RTC has no capture task, so the conversion start event starts a TIMER over PPI instead. The readout
+// interrupt reads the RTC and takes off the time the TIMER has counted since the event, which leaves the
+// timestamp unaffected by interrupt latency and SoftDevice preemption. The TIMER is shut down again straight
+// away, so the high frequency clock is only requested for the readout instead of for as long as the sensor is
+// awake. Timestamps have the RTC resolution of 1/32768 s (30.5 us).
+
+#ifndef SAMPLE_CLOCK_RTC_INSTANCE
+#define SAMPLE_CLOCK_RTC_INSTANCE   2   // RTC0 is reserved by the SoftDevice, RTC1 runs app_timer
+#endif
+
+#ifndef SAMPLE_CLOCK_TIMER_INSTANCE
+#define SAMPLE_CLOCK_TIMER_INSTANCE 1   // TIMER0 is reserved by the SoftDevice
+#endif
+
+#define SAMPLE_CLOCK_TICKS_PER_SECOND 1000000UL
+
+// captureEventAddress is the event that marks the start of a conversion readout
+ret_code_t sample_clock_init(uint32_t captureEventAddress);
+
+void sample_clock_start();
+void sample_clock_stop();
+
+// timestamp in microseconds of the last capture event. Call once per conversion from its readout interrupt,
+// it stops the TIMER until the next event
+uint32_t sample_clock_get_capture();
+
+// current time in microseconds
+uint32_t sample_clock_now();
+
+#endif
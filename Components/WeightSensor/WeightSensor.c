@@ -1,149 +1,1294 @@
 #include "ADS123X/ADS123X.h"
+#include "ADS123X/ADS123X_spim.h"
+#include "ADS123X/ADS123X_multi.h"
+#include "SampleClock/sample_clock.h"
 #include "WeightSensor.h"
 #include "nrf_log.h"
 #include "app_timer.h"
 #include "nrf_gpio.h"
 #include "nrf_drv_gpiote.h"
 #include "libraries/biquad/biquad.h"
+#include "libraries/kalman/kalman.h"
+#include "libraries/hampel/hampel.h"
+#include "libraries/stability/stability.h"
+#include "libraries/sample_ring/sample_ring.h"
+#include "libraries/linear_fit/linear_fit.h"
+#include "libraries/vibration/vibration.h"
 
 #include <math.h>
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
 ADS123X scale;
 
-uint32_t mTimeMS = 0;
-uint32_t mThisTimePeriodStart = 0;
-uint32_t mLastTimePeriodStart = 0;
-uint32_t mSamplesLastTimePeriod = 0;
-uint32_t mSamplesThisTimePeriod = 0;
-uint16_t mSamplesPerSecond = 0;
-uint32_t MIN_SAMPLE_WINDOW_MS = 15*20;
+uint32_t first_sample = 1;
+
+// Time between conversions measured from the hardware captured sample timestamps
+static bool mLastSampleTimestampValid = false;
+static uint32_t mLastSampleTimestamp = 0;
+static float mSamplePeriodUs = 0.0f;        // smoothed sample period
+static float mSamplePeriodSeconds = 0.0f;   // period of the sample currently being processed
+
+// Smoothing applied to the sample period for the reported sampling rate
+#define SAMPLE_PERIOD_SMOOTHING 0.05f
+
+// Gaps longer than this (sleep, missed DRDY) restart the sample period measurement
+#define MAX_SAMPLE_PERIOD_US 500000UL
+
+
+static float mGramsPerSecond = 0.0;
+static float mGramsPerSecondFiltered = 0.0;
+float mGramsLastTimePeriod = 0.0;
+float mGramsThisTimePeriod = 0.0;
+
+float mScaleValue;
+float prev_filtered_weight = 0;
+float mFilteredScaleValue = 0.0;
+float mRoundedValue;
+float mSenseThresholdValue = 0.0;
+
+static ADS123X_average mTaringAverage;
+static ADS123X_average mCalibrationAverage;
+
+// A tare takes the mean of the recent conversions when they are already settled, otherwise it averages enough
+// new conversions to bring the standard error down to TARE_TARGET_ERROR, bounded by the time the tare may take
+#define TARE_HISTORY_SAMPLES    32
+#define TARE_HISTORY_MAX_DRIFT  0.02f       // g over the history
+#define TARE_HISTORY_RESTART    0.5f        // g from the start of the history, the load moved
+#define TARE_TARGET_ERROR       0.005f      // g
+#define TARE_NOISE_MIN_SAMPLES  8           // history needed for a noise estimate
+#define TARE_SAMPLES            20          // without a noise estimate
+#define TARE_MIN_SAMPLES        8
+#define TARE_MAX_SAMPLES        160
+#define TARE_VERIFY_TOLERANCE   0.02f       // g, widened to TARE_VERIFY_SIGMAS of a single conversion
+#define TARE_VERIFY_SIGMAS      4.0f
+#define TARE_MAX_VERIFY_TOLERANCE 0.1f      // g
+
+static StabilityWindow mTareHistory;
+static float mTareVerifyTolerance = TARE_VERIFY_TOLERANCE;
+static uint32_t mTareStartTime = 0;
+static uint32_t mTareLatencyMs = 0;
+
+// Calibration averages enough conversions to bring the standard error of the mean down to CALIBRATION_TARGET_ERROR,
+// from the noise measured over the first CALIBRATION_NOISE_SAMPLES conversions with the reference mass on
+#define CALIBRATION_NOISE_SAMPLES       16
+#define CALIBRATION_MIN_SAMPLES         32
+#define CALIBRATION_MAX_SAMPLES         320
+#define CALIBRATION_TARGET_ERROR        0.002f      // g
+#define CALIBRATION_VERIFY_TOLERANCE    0.02f       // g, widened to CALIBRATION_VERIFY_SIGMAS of a single conversion
+#define CALIBRATION_VERIFY_SIGMAS       4.0f
+#define CALIBRATION_MIN_MASS            1.0f        // g
+#define CALIBRATION_MAX_MASS            10000.0f    // g
+#define CALIBRATION_MIN_COUNTS_PER_GRAM 100.0f      // less means the reference mass isn't on the platform
+
+static StabilityWindow mCalibrationNoiseWindow;
+static float mCalibrationMass = 0.0f;
+static bool mCalibrationAddingPoint = false;
+static float mCalibrationVerifyTolerance = CALIBRATION_VERIFY_TOLERANCE;
+
+// Nonlinearity correction applied after the span calibration
+static calibration_table_t mCalibrationTable;
+
+uint16_t mTaringAttempts = 0;
+static uint16_t mLastTareAttempts = 0;
+
+// The tare, calibration or wakeup request in progress. Requests complete from weight_sensor_process,
+// either when the state machine settles or when the request timer expires
+static weight_sensor_request_t mPendingRequest = WEIGHT_SENSOR_REQUEST_NONE;
+static void (*mRequestCompleteCallback)(weight_sensor_result_t result) = NULL;
+static uint8_t mRequestAttempts = 0;
+static volatile bool mRequestTimedOut = false;
+
+// values restored if a tare or calibration fails
+static int64_t mRequestPreviousOffsetCode = 0;   // with the fraction zero tracking added
+static float mRequestPreviousScaleFactor = 0.0f;
+static calibration_table_t mRequestPreviousCalibrationTable;
+
+APP_TIMER_DEF(m_weight_sensor_request_timer_id);
+
+#define WEIGHT_SENSOR_WAKEUP_TIMEOUT_MS         3000
+#define WEIGHT_SENSOR_TARE_TIMEOUT_MS           3000
+#define WEIGHT_SENSOR_CALIBRATION_TIMEOUT_MS    15000
+
+#define TARE_MAX_ATTEMPTS           5
+#define CALIBRATION_MAX_ATTEMPTS    3
+
+weight_sensor_state_t mWeightSensorCurrentState = NORMAL;
+weight_sensor_sense_state_t mWeightSensorSenseState = NOT_SENSING;
+
+// Stable weight request, fed with the filtered weight in NORMAL
+#define STABILITY_DEFAULT_TOLERANCE     0.05f       // g
+#define STABILITY_DEFAULT_MIN_DURATION  0.5f        // s
+#define STABILITY_DEFAULT_TIMEOUT_MS    5000
+#define STABILITY_MIN_WINDOW            4
+
+static weight_sensor_stability_config_t mStabilityDefaultConfig =
+{
+    .tolerance = STABILITY_DEFAULT_TOLERANCE,
+    .minDuration = STABILITY_DEFAULT_MIN_DURATION,
+    .timeoutMs = STABILITY_DEFAULT_TIMEOUT_MS,
+};
+
+static StabilityWindow mStabilityWindow;
+static weight_sensor_stability_config_t mStabilityConfig;
+static void (*mStableWeightCallback)(weight_sensor_result_t result, float weight, float confidence) = NULL;
+static volatile bool mStabilityTimedOut = false;
+
+APP_TIMER_DEF(m_weight_sensor_stability_timer_id);
+
+const uint8_t pin_DOUT = 33;
+const uint8_t pin_SCLK = 35;
+const uint8_t pin_PWDN = 37;
+const uint8_t pin_GAIN0 = 36;
+const uint8_t pin_GAIN1 = 38;
+const uint8_t pin_SPEED = 39;
+const uint8_t pin_APWR = 4; // analogue power pin
+
+#if WEIGHT_SENSOR_SPIM_READOUT_ENABLED
+static ADS123X_spim mScaleReader;
+#endif
+
+#if WEIGHT_SENSOR_LOAD_CELL_COUNT > 1
+// DOUT of each load cell converter, all on the same GPIO port. The first is the DRDY source
+static const uint8_t pin_DOUT_CELLS[ADS123X_MULTI_MAX_CHANNELS] = { 33, 40, 41, 42 };
+static ADS123X_multi mScaleCells;
+#endif
+
+// Conversions queued by the DRDY/SPIM interrupt for weight_sensor_process to filter in main context
+static sample_ring_t mSampleRing;
+static uint32_t mReportedSampleOverruns = 0;
+
+// Maximum number of queued samples drained from the ring at a time
+#define SAMPLE_BATCH_SIZE 16
+
+// Outlier rejection on the raw codes, ahead of everything but the raw capture
+static Hampel mOutlierFilter;
+
+void (*mCalibrationCompleteCallback)(weight_sensor_result_t result, float scaleFactor) = NULL;
+void (*mWeightMovedFromZeroCallback)() = NULL;
+void (*mConversionCompleteCallback)() = NULL;
+void (*mNewWeightValueReceivedCallback)(float weight) = NULL;
+void (*mNewWeightFilteredValueReceivedCallback)(float weight) = NULL;
+void (*mNewWeightFilteredMilligramsReceivedCallback)(int32_t milligrams) = NULL;
+void (*mRawSampleReceivedCallback)(int32_t rawValue) = NULL;
+
+// Butterworth order of the weight and flow filters, designed at runtime for the measured sample rate
+#define FILTER_ORDER 4
+#define NUM_SECTIONS ((FILTER_ORDER + 1) / 2)
+
+Biquad weight_filter[NUM_SECTIONS];
+Biquad flow_filter[NUM_SECTIONS];
+
+#if WEIGHT_SENSOR_FIXED_POINT
+static BiquadQ weight_filter_q[NUM_SECTIONS];
+static BiquadQ flow_filter_q[NUM_SECTIONS];
+
+static int32_t mPrevFilteredMilligramsQ = 0;
+static uint32_t mPrevFilteredTimestamp = 0;
+static int32_t mMilligramsPerSecondQ = 0;
+static int32_t mFilteredMilligramsPerSecondQ = 0;
+
+#define WEIGHT_Q_ONE_MILLIGRAM          (1L << ADS123X_MILLIGRAM_FRACTIONAL_BITS)
+#define WEIGHT_Q_MAX                    (ADS123X_MILLIGRAMS_MAX * WEIGHT_Q_ONE_MILLIGRAM)
+#define WEIGHT_Q_TO_MILLIGRAMS(q)       (((q) + (WEIGHT_Q_ONE_MILLIGRAM / 2)) >> ADS123X_MILLIGRAM_FRACTIONAL_BITS)
+#define WEIGHT_Q_TO_GRAMS(q)            ((float)(q) / (1000.0f * WEIGHT_Q_ONE_MILLIGRAM))
+#define GRAMS_TO_WEIGHT_Q(g)            weight_q_from_grams(g)
+
+// Weights and flows saturate at the range of ADS123X_convertToMilligrams, int32 has headroom above it
+static int32_t weight_q_saturate(int64_t q)
+{
+    if (q > WEIGHT_Q_MAX)
+    {
+        return WEIGHT_Q_MAX;
+    }
+
+    if (q < -WEIGHT_Q_MAX)
+    {
+        return -WEIGHT_Q_MAX;
+    }
+
+    return (int32_t)q;
+}
+
+static int32_t weight_q_from_grams(float grams)
+{
+    float q = grams * 1000.0f * WEIGHT_Q_ONE_MILLIGRAM;
+
+    // Checked in float, the conversion of an out of range value to an integer is undefined
+    if (!(fabsf(q) < (float)WEIGHT_Q_MAX))
+    {
+        return q < 0.0f ? -WEIGHT_Q_MAX : WEIGHT_Q_MAX;
+    }
+
+    return (int32_t)lroundf(q);
+}
+#endif
+
+// Alternative to the biquads, estimates weight and flow together from each timestamped conversion
+#define KALMAN_DEFAULT_PROCESS_NOISE        10.0f       // (g/s^2)^2/Hz
+#define KALMAN_DEFAULT_MEASUREMENT_NOISE    0.0025f     // g^2, 0.05 g RMS conversion noise
+
+static weight_sensor_pipeline_t mPipeline = WEIGHT_SENSOR_DEFAULT_PIPELINE;
+static Kalman mKalman;
+
+// Least squares flow, in place of the difference and flow filter of the biquad pipeline
+static weight_sensor_flow_source_t mFlowSource = WEIGHT_SENSOR_DEFAULT_FLOW_SOURCE;
+static LinearFitWindow mFlowFit;
+static float mFlowFitQuality = 0.0f;
+
+// Vibration notch ahead of the weight filter, following the scan of the unfiltered weight
+static bool mNotchEnabled = WEIGHT_SENSOR_DEFAULT_NOTCH_ENABLED;
+static VibrationDetector mVibration;
+static Biquad mNotch;
+#if WEIGHT_SENSOR_FIXED_POINT
+static BiquadQ mNotchQ;
+#endif
+static float mNotchFrequency = 0.0f;        // Hz, 0 while the notch is out of the path
+
+// Filtered weight handed to the display and BLE, rounded to whole milligrams
+static int32_t mFilteredMilligrams = 0;
+
+// Weight filter cutoff, limited to a fraction of the sample rate so it stays well below Nyquist at 10 SPS.
+// The flow filter cutoff follows it
+#define MAX_CUTOFF_SAMPLE_RATE_FRACTION     0.15f
+#define FLOW_FILTER_CUTOFF_RATIO            0.5f
+
+static float mWeightFilterCutoffHz = WEIGHT_SENSOR_DEFAULT_FILTER_CUTOFF_HZ;
+
+// Sample rate the current coefficients were designed for. Once enough periods have been measured the filters
+// are redesigned if the measured rate has drifted from it
+#define FILTER_RETUNE_MIN_PERIODS           64
+#define FILTER_RETUNE_RATE_TOLERANCE        0.02f
+
+static float mFilterDesignSampleRate = 0.0f;
+static float mWeightFilterDelay = 0.0f;     // s, low frequency group delay of the weight filter
+static uint32_t mSamplePeriodsMeasured = 0;
+
+static float weight_sensor_nominal_sample_rate(ADS123X_SPEED_t speed)
+{
+    return speed == SPEED_10SPS ? 10.0f : 80.0f;
+}
+
+// Put the notch on frequencyHz at the design rate, or take it out of the path with 0. It starts settled on
+// the filtered weight so switching it in doesn't step the weight
+static void weight_sensor_notch_tune(float frequencyHz)
+{
+    Biquad coefficients;
+
+    if (frequencyHz <= 0.0f ||
+        biquad_design_notch(&coefficients, frequencyHz, WEIGHT_SENSOR_NOTCH_BANDWIDTH, mFilterDesignSampleRate) == 0)
+    {
+        mNotchFrequency = 0.0f;
+        return;
+    }
+
+    filter_swap_coefficients(&mNotch, &coefficients, 1, mFilteredScaleValue);
+
+#if WEIGHT_SENSOR_FIXED_POINT
+    filter_q_set_coefficients(&mNotchQ, &coefficients, 1);
+    filter_q_preload(&mNotchQ, 1, GRAMS_TO_WEIGHT_Q(mFilteredScaleValue));
+#endif
+
+    mNotchFrequency = frequencyHz;
+}
+
+// Scan the unfiltered weight and move the notch to follow the vibration, small moves stay inside its width
+static void weight_sensor_vibration_update(float grams)
+{
+    if (!mNotchEnabled || !vibration_detector_add(&mVibration, grams, mFilterDesignSampleRate))
+    {
+        return;
+    }
+
+    if (!mVibration.detected)
+    {
+        if (mNotchFrequency > 0.0f)
+        {
+            NRF_LOG_INFO("Vibration gone, notch off");
+            weight_sensor_notch_tune(0.0f);
+        }
+        return;
+    }
+
+    if (fabsf(mVibration.frequency - mNotchFrequency) > 0.25f * WEIGHT_SENSOR_NOTCH_BANDWIDTH)
+    {
+        weight_sensor_notch_tune(mVibration.frequency);
+        NRF_LOG_INFO("Vibration notch at " NRF_LOG_FLOAT_MARKER " Hz, " NRF_LOG_FLOAT_MARKER " g",
+                     NRF_LOG_FLOAT(mNotchFrequency), NRF_LOG_FLOAT(mVibration.amplitude));
+    }
+}
+
+static float weight_sensor_notch_process(float grams)
+{
+    weight_sensor_vibration_update(grams);
+
+    return mNotchFrequency > 0.0f ? biquad_process(&mNotch, grams) : grams;
+}
+
+#if WEIGHT_SENSOR_FIXED_POINT
+static int32_t weight_sensor_notch_process_q(int32_t milligramsQ)
+{
+    weight_sensor_vibration_update(WEIGHT_Q_TO_GRAMS(milligramsQ));
+
+    return mNotchFrequency > 0.0f ? biquad_q_process(&mNotchQ, milligramsQ) : milligramsQ;
+}
+#endif
+
+static void weight_sensor_design_filters(float sampleRate)
+{
+    Biquad weightCoefficients[NUM_SECTIONS];
+    Biquad flowCoefficients[NUM_SECTIONS];
+
+    float weightCutoff = fminf(mWeightFilterCutoffHz, MAX_CUTOFF_SAMPLE_RATE_FRACTION * sampleRate);
+    float flowCutoff = weightCutoff * FLOW_FILTER_CUTOFF_RATIO;
+
+    if (biquad_design_butterworth_lowpass(weightCoefficients, NUM_SECTIONS, FILTER_ORDER, weightCutoff, sampleRate) == 0 ||
+        biquad_design_butterworth_lowpass(flowCoefficients, NUM_SECTIONS, FILTER_ORDER, flowCutoff, sampleRate) == 0)
+    {
+        return;
+    }
+
+    // Carry the current outputs across so the swap doesn't step the filters
+    filter_swap_coefficients(weight_filter, weightCoefficients, NUM_SECTIONS, mFilteredScaleValue);
+    filter_swap_coefficients(flow_filter, flowCoefficients, NUM_SECTIONS, mGramsPerSecondFiltered);
+
+#if WEIGHT_SENSOR_FIXED_POINT
+    filter_q_set_coefficients(weight_filter_q, weightCoefficients, NUM_SECTIONS);
+    filter_q_set_coefficients(flow_filter_q, flowCoefficients, NUM_SECTIONS);
+
+    filter_q_preload(weight_filter_q, NUM_SECTIONS, GRAMS_TO_WEIGHT_Q(mFilteredScaleValue));
+    filter_q_preload(flow_filter_q, NUM_SECTIONS, mFilteredMilligramsPerSecondQ);
+#endif
+
+    // The scan window is counted in samples, restart it at a new rate and move the notch over
+    if (sampleRate != mFilterDesignSampleRate)
+    {
+        vibration_detector_reset(&mVibration);
+    }
+
+    mFilterDesignSampleRate = sampleRate;
+
+    if (mNotchFrequency > 0.0f)
+    {
+        weight_sensor_notch_tune(mNotchFrequency);
+    }
+
+    // Butterworth group delay at DC is the sum of sin((2k - 1)pi / 2n) over its poles divided by the cutoff in rad/s
+    float poleSum = 0.0f;
+
+    for (int k = 1; k <= FILTER_ORDER; k++)
+    {
+        poleSum += sinf((2 * k - 1) * (float)M_PI / (2 * FILTER_ORDER));
+    }
+
+    mWeightFilterDelay = poleSum / (2.0f * (float)M_PI * weightCutoff);
+}
+
+// Redesign the filters for the measured rate once it has settled, the ADS123X oscillator isn't exact
+static void weight_sensor_retune_filters()
+{
+    if (mSamplePeriodsMeasured < FILTER_RETUNE_MIN_PERIODS || mFilterDesignSampleRate == 0.0f)
+    {
+        return;
+    }
+
+    float sampleRate = weight_sensor_get_sampling_rate();
+
+    if (fabsf(sampleRate - mFilterDesignSampleRate) > FILTER_RETUNE_RATE_TOLERANCE * mFilterDesignSampleRate)
+    {
+        NRF_LOG_INFO("Filters retuned for " NRF_LOG_FLOAT_MARKER " SPS", NRF_LOG_FLOAT(sampleRate));
+        weight_sensor_design_filters(sampleRate);
+    }
+}
+
+// Restart the weight and flow estimates of every pipeline as if they had settled on grams and gramsPerSecond
+static void weight_sensor_filters_preload(float grams, float gramsPerSecond)
+{
+    filter_preload(weight_filter, NUM_SECTIONS, grams);
+    filter_preload(flow_filter, NUM_SECTIONS, gramsPerSecond);
+    kalman_reset(&mKalman, grams, gramsPerSecond);
+    linear_fit_window_reset(&mFlowFit);
+    mFlowFitQuality = 0.0f;
+
+    // A step would show up in every bin of the scan
+    filter_preload(&mNotch, 1, grams);
+    vibration_detector_reset(&mVibration);
+
+    mScaleValue = grams;
+    mFilteredScaleValue = grams;
+    prev_filtered_weight = grams;
+    mGramsPerSecond = gramsPerSecond;
+    mGramsPerSecondFiltered = gramsPerSecond;
+    mFilteredMilligrams = (int32_t)lroundf(grams * 1000.0f);
+    first_sample = 0;
+
+#if WEIGHT_SENSOR_FIXED_POINT
+    int32_t milligramsQ = GRAMS_TO_WEIGHT_Q(grams);
+
+    filter_q_preload(weight_filter_q, NUM_SECTIONS, milligramsQ);
+    filter_q_preload(flow_filter_q, NUM_SECTIONS, GRAMS_TO_WEIGHT_Q(gramsPerSecond));
+    filter_q_preload(&mNotchQ, 1, milligramsQ);
+
+    mPrevFilteredMilligramsQ = milligramsQ;
+    mMilligramsPerSecondQ = GRAMS_TO_WEIGHT_Q(gramsPerSecond);
+    mFilteredMilligramsPerSecondQ = mMilligramsPerSecondQ;
+#endif
+}
+
+// Size the window for the minimum duration at the current rate. Called when the request starts and whenever
+// the rate changes, since the window is counted in samples
+static void weight_sensor_stability_restart()
+{
+    float sampleRate = weight_sensor_get_sampling_rate();
+
+    if (sampleRate <= 0.0f)
+    {
+        sampleRate = weight_sensor_nominal_sample_rate(scale.speed);
+    }
+
+    float size = roundf(mStabilityConfig.minDuration * sampleRate);
+    size = fmaxf(STABILITY_MIN_WINDOW, fminf(size, STABILITY_MAX_WINDOW));
+
+    stability_window_init(&mStabilityWindow, (uint16_t)size);
+}
+
+static void weight_sensor_stability_complete(weight_sensor_result_t result, float weight, float confidence)
+{
+    void (*callback)(weight_sensor_result_t result, float weight, float confidence) = mStableWeightCallback;
+
+    if (callback == NULL)
+    {
+        return;
+    }
+
+    mStableWeightCallback = NULL;
+    mStabilityTimedOut = false;
+    UNUSED_RETURN_VALUE(app_timer_stop(m_weight_sensor_stability_timer_id));
+
+    callback(result, weight, confidence);
+}
+
+static void weight_sensor_stability_update()
+{
+    if (mStableWeightCallback == NULL)
+    {
+        return;
+    }
+
+    stability_window_add(&mStabilityWindow, mFilteredScaleValue);
+
+    if (!stability_window_full(&mStabilityWindow))
+    {
+        return;
+    }
+
+    float deviation = sqrtf(stability_window_variance(&mStabilityWindow));
+    float drift = fabsf(stability_window_slope(&mStabilityWindow)) * (float)(mStabilityWindow.size - 1);
+    float error = fmaxf(deviation, drift);
+
+    if (error <= mStabilityConfig.tolerance)
+    {
+        weight_sensor_stability_complete(WEIGHT_SENSOR_SUCCESS,
+                                         stability_window_mean(&mStabilityWindow),
+                                         1.0f - error / mStabilityConfig.tolerance);
+    }
+}
+
+// Runs in the app_timer interrupt, the request is failed from main context by weight_sensor_process
+static void weight_sensor_stability_timeout_handler(void * p_context)
+{
+    mStabilityTimedOut = true;
+}
+
+// Zero tracking. Once the weight has sat within ZERO_TRACKING_BAND of zero with no flow for ZERO_TRACKING_HOLD_TIME
+// the offset is moved toward it at no more than ZERO_TRACKING_RATE, up to ZERO_TRACKING_MAX_CORRECTION in total
+#define ZERO_TRACKING_BAND              0.3f        // g
+#define ZERO_TRACKING_MAX_FLOW          0.05f       // g/s
+#define ZERO_TRACKING_HOLD_TIME         2.0f        // s
+#define ZERO_TRACKING_RATE              0.02f       // g/s
+#define ZERO_TRACKING_MAX_CORRECTION    2.0f        // g
+
+static bool mBrewActive = false;
+static float mZeroTrackingHoldTime = 0.0f;
+static float mZeroTrackingCorrection = 0.0f;   // g added to the tared zero
+
+// The offset set by the last tare and the correction added to it, in ADS123X offset codes
+static int64_t mZeroTrackingBaseOffsetCode = 0;
+static int64_t mZeroTrackingCorrectionCode = 0;
+
+// Called when a tare sets a new offset, the correction is relative to it
+static void weight_sensor_zero_tracking_reset()
+{
+    mZeroTrackingBaseOffsetCode = ADS123X_getOffsetCode(&scale);
+    mZeroTrackingCorrectionCode = 0;
+    mZeroTrackingCorrection = 0.0f;
+    mZeroTrackingHoldTime = 0.0f;
+}
+
+static void weight_sensor_zero_tracking_update()
+{
+#if WEIGHT_SENSOR_ZERO_TRACKING_ENABLED
+    if (mBrewActive || mSamplePeriodSeconds <= 0.0f ||
+        fabsf(mFilteredScaleValue) > ZERO_TRACKING_BAND || fabsf(mGramsPerSecondFiltered) > ZERO_TRACKING_MAX_FLOW)
+    {
+        mZeroTrackingHoldTime = 0.0f;
+        return;
+    }
+
+    if (mZeroTrackingHoldTime < ZERO_TRACKING_HOLD_TIME)
+    {
+        mZeroTrackingHoldTime += mSamplePeriodSeconds;
+        return;
+    }
+
+    float offsetCodesPerGram = ADS123X_getScaleFactor(&scale) * (float)(1UL << ADS123X_OFFSET_FRACTIONAL_BITS);
+
+    if (offsetCodesPerGram == 0.0f)
+    {
+        return;
+    }
+
+    float maxStep = ZERO_TRACKING_RATE * mSamplePeriodSeconds;
+    int64_t maxCorrection = llroundf(ZERO_TRACKING_MAX_CORRECTION * fabsf(offsetCodesPerGram));
+
+    int64_t correction = mZeroTrackingCorrectionCode +
+                         llroundf(fmaxf(-maxStep, fminf(mFilteredScaleValue, maxStep)) * offsetCodesPerGram);
+
+    if (correction > maxCorrection)
+    {
+        correction = maxCorrection;
+    }
+    else if (correction < -maxCorrection)
+    {
+        correction = -maxCorrection;
+    }
+
+    if (correction == mZeroTrackingCorrectionCode)
+    {
+        return;
+    }
+
+    // Added to the tared offset as integers, a float offset of a million codes can't hold the fraction of a code
+    // each step moves it by
+    mZeroTrackingCorrectionCode = correction;
+    mZeroTrackingCorrection = (float)correction / offsetCodesPerGram;
+    ADS123X_setOffsetCode(&scale, mZeroTrackingBaseOffsetCode + correction);
+#endif
+}
+
+// Step detection. A raw weight this far from the filtered weight for STEP_DETECT_SAMPLES conversions in a row
+// is a load being placed or removed rather than a pour, and the filters follow the raw weight until it settles
+#define STEP_DETECT_THRESHOLD           2.0f        // g
+#define STEP_DETECT_SAMPLES             2
+#define STEP_SETTLE_BAND                0.3f        // g between consecutive raw weights
+#define STEP_SETTLE_SAMPLES             6
+#define STEP_MAX_TRACKING_SAMPLES       80          // give up following a load that never settles
+#define STEP_FLOW_SAMPLES               STEP_SETTLE_SAMPLES     // raw weights the flow is taken across while tracking
+
+static bool mStepTracking = false;
+static uint8_t mStepDetectCount = 0;
+
+#if WEIGHT_SENSOR_STEP_DETECTION_ENABLED
+static uint8_t mStepSettleCount = 0;
+static uint16_t mStepTrackingSamples = 0;
+static float mStepLastGrams = 0.0f;
+
+// Raw weights since tracking started, the last STEP_FLOW_SAMPLES of them
+static float mStepHistory[STEP_FLOW_SAMPLES];
+static uint8_t mStepHistoryCount = 0;
+static uint8_t mStepHistoryNext = 0;
+
+static void weight_sensor_step_history_add(float grams)
+{
+    mStepHistory[mStepHistoryNext] = grams;
+    mStepHistoryNext = (mStepHistoryNext + 1) % STEP_FLOW_SAMPLES;
+
+    if (mStepHistoryCount < STEP_FLOW_SAMPLES)
+    {
+        mStepHistoryCount++;
+    }
+}
+
+// Flow while the filters follow the raw weight, across the recent raw weights. A pour fast enough to be
+// tracked keeps its flow this way instead of reading 0 until it slows, a load that has settled reads 0
+static float weight_sensor_step_tracking_flow()
+{
+    if (mStepHistoryCount < 2 || mSamplePeriodSeconds <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    float newest = mStepHistory[(mStepHistoryNext + STEP_FLOW_SAMPLES - 1) % STEP_FLOW_SAMPLES];
+    float oldest = mStepHistory[(mStepHistoryNext + STEP_FLOW_SAMPLES - mStepHistoryCount) % STEP_FLOW_SAMPLES];
+
+    return (newest - oldest) / ((mStepHistoryCount - 1) * mSamplePeriodSeconds);
+}
+#else
+static float weight_sensor_step_tracking_flow()
+{
+    return 0.0f;
+}
+#endif
+
+// Returns true while the filters should be bypassed for grams, the newest raw weight
+static bool weight_sensor_step_tracking(float grams)
+{
+#if WEIGHT_SENSOR_STEP_DETECTION_ENABLED
+    if (!mStepTracking)
+    {
+        if (fabsf(grams - mFilteredScaleValue) <= STEP_DETECT_THRESHOLD)
+        {
+            mStepDetectCount = 0;
+            return false;
+        }
+
+        if (++mStepDetectCount < STEP_DETECT_SAMPLES)
+        {
+            return false;
+        }
+
+        mStepTracking = true;
+        mStepSettleCount = 0;
+        mStepTrackingSamples = 0;
+        mStepHistoryCount = 0;
+        mStepHistoryNext = 0;
+    }
+    else
+    {
+        if (fabsf(grams - mStepLastGrams) < STEP_SETTLE_BAND)
+        {
+            mStepSettleCount++;
+        }
+        else
+        {
+            mStepSettleCount = 0;
+        }
+
+        mStepTrackingSamples++;
+
+        // The filters already sit at the new weight so smoothing resumes without a jump
+        if (mStepSettleCount >= STEP_SETTLE_SAMPLES || mStepTrackingSamples >= STEP_MAX_TRACKING_SAMPLES)
+        {
+            mStepTracking = false;
+            mStepDetectCount = 0;
+            return false;
+        }
+    }
+
+    mStepLastGrams = grams;
+    weight_sensor_step_history_add(grams);
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Temperature and creep compensation of the converted weight, ahead of the filters
+static load_cell_compensation_t mCompensation;
+
+// Learning the compensation coefficients. Temperature steps take a point each time the temperature is updated
+// while the weight is at rest, creep takes the weight three times CREEP_LEARNING_INTERVAL apart
+#define TEMPERATURE_LEARNING_MIN_RANGE  3.0f        // degrees C the readings have to cover
+#define LEARNING_MAX_FLOW               0.05f       // g/s
+#define SPAN_LEARNING_MIN_LOAD          20.0f       // g
+#define CREEP_LEARNING_MIN_LOAD         20.0f       // g
+#define CREEP_LEARNING_SETTLE_TIME      5.0f        // s after the load is placed
+#define CREEP_LEARNING_INTERVAL         300.0f      // s
+
+static weight_sensor_learning_t mLearningStep = WEIGHT_SENSOR_LEARNING_NONE;
+static void (*mLearningCompleteCallback)(weight_sensor_result_t result, const load_cell_compensation_coefficients_t *coefficients) = NULL;
+static load_cell_temperature_fit_t mTemperatureFit;
+static float mCreepLearningTime = 0.0f;
+static float mCreepReadings[3];
+static uint8_t mCreepReadingCount = 0;
+
+static void weight_sensor_learning_complete(weight_sensor_result_t result)
+{
+    void (*callback)(weight_sensor_result_t result, const load_cell_compensation_coefficients_t *coefficients) = mLearningCompleteCallback;
+
+    if (mLearningStep == WEIGHT_SENSOR_LEARNING_NONE)
+    {
+        return;
+    }
+
+    mLearningStep = WEIGHT_SENSOR_LEARNING_NONE;
+    mLearningCompleteCallback = NULL;
+    mCompensation.enabled = true;
+
+    if (callback != NULL)
+    {
+        callback(result, &mCompensation.coefficients);
+    }
+}
+
+static bool weight_sensor_learning_at_rest()
+{
+    return mWeightSensorCurrentState == NORMAL && !mStepTracking && fabsf(mGramsPerSecondFiltered) < LEARNING_MAX_FLOW;
+}
+
+// Creep learning, run on every filtered weight
+static void weight_sensor_learning_update()
+{
+    if (mLearningStep != WEIGHT_SENSOR_LEARNING_CREEP)
+    {
+        return;
+    }
+
+    if (mCreepReadingCount == 0)
+    {
+        // Wait for the load to be placed and settle before the first reading
+        if (fabsf(mFilteredScaleValue) < CREEP_LEARNING_MIN_LOAD || !weight_sensor_learning_at_rest())
+        {
+            mCreepLearningTime = 0.0f;
+            return;
+        }
+
+        mCreepLearningTime += mSamplePeriodSeconds;
+
+        if (mCreepLearningTime >= CREEP_LEARNING_SETTLE_TIME)
+        {
+            mCreepReadings[mCreepReadingCount++] = mFilteredScaleValue;
+            mCreepLearningTime = 0.0f;
+        }
+
+        return;
+    }
+
+    if (fabsf(mFilteredScaleValue) < CREEP_LEARNING_MIN_LOAD / 2.0f)
+    {
+        // Load taken off part way through
+        weight_sensor_learning_complete(WEIGHT_SENSOR_ERROR_UNSTABLE);
+        return;
+    }
+
+    mCreepLearningTime += mSamplePeriodSeconds;
+
+    if (mCreepLearningTime < CREEP_LEARNING_INTERVAL)
+    {
+        return;
+    }
+
+    mCreepReadings[mCreepReadingCount++] = mFilteredScaleValue;
+    mCreepLearningTime = 0.0f;
+
+    if (mCreepReadingCount < 3)
+    {
+        return;
+    }
+
+    float coefficient;
+    float timeConstant;
+
+    if (!load_cell_creep_fit(mCreepReadings[0], mCreepReadings[1], mCreepReadings[2], CREEP_LEARNING_INTERVAL, &coefficient, &timeConstant))
+    {
+        weight_sensor_learning_complete(WEIGHT_SENSOR_ERROR_UNSTABLE);
+        return;
+    }
+
+    NRF_LOG_INFO("Creep learned, " NRF_LOG_FLOAT_MARKER " ppm over " NRF_LOG_FLOAT_MARKER " s",
+                 NRF_LOG_FLOAT(coefficient * 1e6f), NRF_LOG_FLOAT(timeConstant));
+
+    mCompensation.coefficients.creep_coefficient = coefficient;
+    mCompensation.coefficients.creep_time_constant = timeConstant;
+    mCompensation.creep = 0.0f;
+
+    weight_sensor_learning_complete(WEIGHT_SENSOR_SUCCESS);
+}
+
+// Nonlinearity and then temperature and creep correction of a converted weight
+static float weight_sensor_correct(float grams)
+{
+    grams = calibration_table_apply(&mCalibrationTable, grams);
+
+    return load_cell_compensation_apply(&mCompensation, grams, mSamplePeriodSeconds);
+}
+
+// Conversion rate control. The sensor runs at 10 SPS (50/60 Hz rejection, lower noise) while the load is at rest
+// and at 80 SPS while the weight is changing
+#define RATE_UP_WEIGHT_DEVIATION        0.3f        // g between the raw and filtered weight
+#define RATE_UP_FLOW                    0.5f        // g/s
+#define RATE_DOWN_WEIGHT_DEVIATION      0.1f        // g
+#define RATE_DOWN_FLOW                  0.1f        // g/s
+#define RATE_DOWN_QUIET_TIME            3.0f        // seconds at rest before dropping to 10 SPS
+
+// Conversions thrown away after a rate change while the ADS123X digital filter settles
+#define RATE_SWITCH_SETTLING_SAMPLES    4
+
+static uint8_t mRateSwitchDiscardSamples = 0;
+static float mRateQuietTime = 0.0f;
+static weight_sensor_rate_mode_t mRateMode = WEIGHT_SENSOR_RATE_ADAPTIVE;
+
+static void weight_sensor_set_conversion_rate(ADS123X_SPEED_t speed)
+{
+    ADS123X_setSpeed(&scale, speed);
+
+    // Nominal rate until the real one has been measured
+    weight_sensor_design_filters(weight_sensor_nominal_sample_rate(speed));
+
+    // Samples already queued were converted at the old rate, so restart the period measurement too
+    mRateSwitchDiscardSamples = RATE_SWITCH_SETTLING_SAMPLES;
+    mLastSampleTimestampValid = false;
+    mSamplePeriodUs = 0.0f;
+    mSamplePeriodsMeasured = 0;
+    mRateQuietTime = 0.0f;
+
+    if (mStableWeightCallback != NULL)
+    {
+        weight_sensor_stability_restart();
+    }
+}
+
+static void weight_sensor_update_conversion_rate()
+{
+    if (mRateMode != WEIGHT_SENSOR_RATE_ADAPTIVE || !WEIGHT_SENSOR_ADAPTIVE_RATE_ENABLED)
+    {
+        ADS123X_SPEED_t speed = mRateMode == WEIGHT_SENSOR_RATE_SLOW ? SPEED_10SPS : SPEED_80SPS;
+
+        if (scale.speed != speed)
+        {
+            weight_sensor_set_conversion_rate(speed);
+        }
+        return;
+    }
+
+#if WEIGHT_SENSOR_ADAPTIVE_RATE_ENABLED
+    float deviation = fabsf(mScaleValue - mFilteredScaleValue);
+    float flow = fabsf(mGramsPerSecondFiltered);
+
+    if (scale.speed == SPEED_10SPS)
+    {
+        // The filters are bypassed while a step is followed, so the deviation doesn't show it
+        if (mStepTracking || deviation > RATE_UP_WEIGHT_DEVIATION || flow > RATE_UP_FLOW)
+        {
+            weight_sensor_set_conversion_rate(SPEED_80SPS);
+        }
+    }
+    else
+    {
+        if (!mStepTracking && deviation < RATE_DOWN_WEIGHT_DEVIATION && flow < RATE_DOWN_FLOW)
+        {
+            mRateQuietTime += mSamplePeriodSeconds;
+        }
+        else
+        {
+            mRateQuietTime = 0.0f;
+        }
+
+        if (mRateQuietTime >= RATE_DOWN_QUIET_TIME)
+        {
+            weight_sensor_set_conversion_rate(SPEED_10SPS);
+        }
+    }
+#endif
+}
+
+static void weight_sensor_update_sample_period(uint32_t timestamp)
+{
+    uint32_t periodUs = timestamp - mLastSampleTimestamp;
 
-uint32_t first_sample = 1;
+    if (!mLastSampleTimestampValid || periodUs == 0 || periodUs > MAX_SAMPLE_PERIOD_US)
+    {
+        mSamplePeriodSeconds = 0.0f;
+    }
+    else
+    {
+        mSamplePeriodSeconds = (float)periodUs / (float)SAMPLE_CLOCK_TICKS_PER_SECOND;
 
+        if (mSamplePeriodUs == 0.0f)
+        {
+            mSamplePeriodUs = (float)periodUs;
+        }
+        else
+        {
+            mSamplePeriodUs += SAMPLE_PERIOD_SMOOTHING * ((float)periodUs - mSamplePeriodUs);
+        }
 
-static float mGramsPerSecond = 0.0;
-static float mGramsPerSecondFiltered = 0.0;
-float mGramsLastTimePeriod = 0.0;
-float mGramsThisTimePeriod = 0.0;
+        mSamplePeriodsMeasured++;
+    }
 
-float mScaleValue;
-float prev_filtered_weight = 0;
-float mFilteredScaleValue = 0.0;
-float mLastFilteredScaleValue = 0.0;
-float mRoundedValue;
-float mSenseThresholdValue = 0.0;
+    mLastSampleTimestamp = timestamp;
+    mLastSampleTimestampValid = true;
+}
 
-float mWeightFilterInputCoefficient = 0.4;
-float mWeightFilterOutputCoefficient = 0.6;
+// Runs in the app_timer interrupt, the request is failed from main context by weight_sensor_process
+static void weight_sensor_request_timeout_handler(void * p_context)
+{
+    mRequestTimedOut = true;
+}
 
-int32_t mTaringSum = 0;
-int32_t mTaringReadCount = 0;
-int32_t mCalibrationSum = 0;
-int32_t mCalibrationReadCount = 0;
+static bool weight_sensor_request_start(weight_sensor_request_t request, uint32_t timeoutMs)
+{
+    if (mPendingRequest != WEIGHT_SENSOR_REQUEST_NONE)
+    {
+        return false;
+    }
 
-uint16_t mTaringAttempts = 0;
+    mPendingRequest = request;
+    mRequestAttempts = 0;
+    mRequestTimedOut = false;
+    mRequestPreviousOffsetCode = ADS123X_getOffsetCode(&scale);
+    mRequestPreviousScaleFactor = ADS123X_getScaleFactor(&scale);
+    mRequestPreviousCalibrationTable = mCalibrationTable;
 
-weight_sensor_state_t mWeightSensorCurrentState = NORMAL;
-weight_sensor_sense_state_t mWeightSensorSenseState = NOT_SENSING;
+    ret_code_t err_code = app_timer_start(m_weight_sensor_request_timer_id, APP_TIMER_TICKS(timeoutMs), NULL);
+    APP_ERROR_CHECK(err_code);
 
-bool mStableWeightRequested = false;
+    return true;
+}
 
-const uint8_t pin_DOUT = 33;
-const uint8_t pin_SCLK = 35;
-const uint8_t pin_PWDN = 37;
-const uint8_t pin_GAIN0 = 36;
-const uint8_t pin_GAIN1 = 38;
-const uint8_t pin_SPEED = 39;
-const uint8_t pin_APWR = 4; // analogue power pin
+static void weight_sensor_request_complete(weight_sensor_result_t result)
+{
+    weight_sensor_request_t request = mPendingRequest;
 
-void (*mCalibrationCompleteCallback)(float scaleFactor) = NULL;
-void (*mWeightMovedFromZeroCallback)() = NULL;
-void (*mStableWeightAcheivedCallback)() = NULL;
-void (*mConversionCompleteCallback)() = NULL;
-void (*mNewWeightValueReceivedCallback)(float weight) = NULL;
-void (*mNewWeightFilteredValueReceivedCallback)(float weight) = NULL;
+    if (request == WEIGHT_SENSOR_REQUEST_NONE)
+    {
+        return;
+    }
 
-APP_TIMER_DEF(m_weight_sensor_tick_timer_id);
+    ret_code_t err_code = app_timer_stop(m_weight_sensor_request_timer_id);
+    APP_ERROR_CHECK(err_code);
 
-const uint32_t READ_WEIGHT_SENSOR_TICKS_INTERVAL_MS =   (uint32_t)5;
-#define READ_WEIGHT_SENSOR_TICKS_INTERVAL       APP_TIMER_TICKS(READ_WEIGHT_SENSOR_TICKS_INTERVAL_MS)    
+    mPendingRequest = WEIGHT_SENSOR_REQUEST_NONE;
+    mRequestTimedOut = false;
 
-// Define filter order and sections (4th order = 2 biquads)
-#define NUM_SECTIONS 2
+    if (result != WEIGHT_SENSOR_SUCCESS)
+    {
+        NRF_LOG_WARNING("Weight sensor request %d failed: %d", request, result);
 
-Biquad weight_filter[NUM_SECTIONS] = {
-    // Section 1 coefficients (b0,b1,b2,a1,a2)
-    {0.06745527, 0.13491055, 0.06745527, -1.1429805, 0.4128016, 0, 0},
-    // Section 2 coefficients
-    {0.06745527, 0.13491055, 0.06745527, -1.1429805, 0.4128016, 0, 0}
-};
+        // Don't leave a half finished tare or calibration applied
+        ADS123X_setOffsetCode(&scale, mRequestPreviousOffsetCode);
+        ADS123X_setScaleFactor(&scale, mRequestPreviousScaleFactor);
+        mCalibrationTable = mRequestPreviousCalibrationTable;
+        mWeightSensorCurrentState = NORMAL;
+    }
 
-Biquad flow_filter[NUM_SECTIONS] = {
-    // Example coeffs for 4th order Butterworth low-pass 10 Hz @ 80 Hz sampling
-    {0.02008337, 0.04016673, 0.02008337, -1.5610181, 0.6413515, 0, 0},
-    {0.02008337, 0.04016673, 0.02008337, -1.5610181, 0.6413515, 0, 0}
-};
+    if (request == WEIGHT_SENSOR_REQUEST_CALIBRATION)
+    {
+        if (mCalibrationCompleteCallback != NULL)
+        {
+            mCalibrationCompleteCallback(result, ADS123X_getScaleFactor(&scale));
+        }
+    }
+    else if (mRequestCompleteCallback != NULL)
+    {
+        mRequestCompleteCallback(result);
+    }
+}
 
-static void ads123x_timeout_handler(void * p_context)
+// Least squares flow from the filtered weight at its conversion time. Returns false, leaving the flow as it
+// was, until the fit has two samples to draw a line through
+static bool weight_sensor_flow_fit_update(float grams, uint32_t timestamp)
 {
-    nrf_drv_gpiote_in_event_disable(pin_DOUT);
+    linear_fit_window_add(&mFlowFit, timestamp, grams);
 
-    uint32_t elapsedMs = mTimeMS - mThisTimePeriodStart;
-    if (elapsedMs >= MIN_SAMPLE_WINDOW_MS) // e.g. 100 or 250 ms
+    if (mFlowFit.count < 2)
     {
-        mLastTimePeriodStart = mThisTimePeriodStart;
-        mThisTimePeriodStart = mTimeMS;
+        return false;
+    }
 
-        mSamplesLastTimePeriod = mSamplesThisTimePeriod;
-        mSamplesThisTimePeriod = 0;
+    mFlowFitQuality = linear_fit_window_r_squared(&mFlowFit);
 
-        // mGramsLastTimePeriod = mGramsThisTimePeriod;
-        // mGramsThisTimePeriod = mFilteredScaleValue;
+    return true;
+}
 
-        // mGramsPerSecond = ((mFilteredScaleValue-mGramsLastTimePeriod) * 1000.0) / (float)elapsedMs;
+#if WEIGHT_SENSOR_FIXED_POINT
+// Offset, scaling, filtering and the flow derivative in integer math. Weights are milligrams with
+// ADS123X_MILLIGRAM_FRACTIONAL_BITS fractional bits, flows are the same per second
+static bool weight_sensor_filter_fixed_point(int32_t rawValue, uint32_t timestamp)
+{
+    int32_t milligramsQ;
 
-        mSamplesPerSecond = (mSamplesLastTimePeriod * 1000) / elapsedMs;
+    if (ADS123X_convertToMilligrams(&scale, rawValue, &milligramsQ) != NoERROR)
+    {
+        return false;
     }
 
-    mSamplesThisTimePeriod++;
+    // The corrections are small, so working them out in float costs no precision
+    float grams = WEIGHT_Q_TO_GRAMS(milligramsQ);
+    milligramsQ = weight_q_saturate((int64_t)milligramsQ + GRAMS_TO_WEIGHT_Q(weight_sensor_correct(grams) - grams));
 
+    if (weight_sensor_step_tracking(WEIGHT_Q_TO_GRAMS(milligramsQ)))
+    {
+        // Follow the new weight and its flow directly until it settles
+        weight_sensor_filters_preload(WEIGHT_Q_TO_GRAMS(milligramsQ), weight_sensor_step_tracking_flow());
+        mPrevFilteredTimestamp = timestamp;
+        return true;
+    }
 
-    switch (mWeightSensorCurrentState)
+    int32_t filteredMilligramsQ = filter_q_process(weight_filter_q, NUM_SECTIONS, weight_sensor_notch_process_q(milligramsQ));
+
+    if (mFlowSource == WEIGHT_SENSOR_FLOW_LEAST_SQUARES)
     {
-        case NORMAL:
+        // The fit is already smooth, it replaces the flow filter too
+        if (weight_sensor_flow_fit_update(WEIGHT_Q_TO_GRAMS(filteredMilligramsQ), timestamp))
         {
-            ADS123X_ERROR_t err = ADS123X_getUnits(&scale, &mScaleValue, 1);
+            mMilligramsPerSecondQ = GRAMS_TO_WEIGHT_Q(linear_fit_window_slope(&mFlowFit));
+            mFilteredMilligramsPerSecondQ = mMilligramsPerSecondQ;
+        }
+        first_sample = 0;
+    }
+    else
+    {
+        uint32_t periodUs = timestamp - mPrevFilteredTimestamp;
 
-            if (err != NoERROR)
+        if (!first_sample) {
+            if (mSamplePeriodSeconds > 0.0f && periodUs > 0)
             {
-                break;
+                int64_t change = (int64_t)(filteredMilligramsQ - mPrevFilteredMilligramsQ) * SAMPLE_CLOCK_TICKS_PER_SECOND;
+                mMilligramsPerSecondQ = weight_q_saturate(change / (int64_t)periodUs);
             }
+        } else {
+            first_sample = 0;
+        }
+
+        // Filter the flow rate
+        mFilteredMilligramsPerSecondQ = filter_q_process(flow_filter_q, NUM_SECTIONS, mMilligramsPerSecondQ);
+    }
+    mPrevFilteredMilligramsQ = filteredMilligramsQ;
+    mPrevFilteredTimestamp = timestamp;
+
+    mFilteredMilligrams = WEIGHT_Q_TO_MILLIGRAMS(filteredMilligramsQ);
+
+    // Float copies for the rest of the module and its getters
+    mScaleValue = WEIGHT_Q_TO_GRAMS(milligramsQ);
+    mFilteredScaleValue = WEIGHT_Q_TO_GRAMS(filteredMilligramsQ);
+    prev_filtered_weight = mFilteredScaleValue;
+    mGramsPerSecond = WEIGHT_Q_TO_GRAMS(mMilligramsPerSecondQ);
+    mGramsPerSecondFiltered = WEIGHT_Q_TO_GRAMS(mFilteredMilligramsPerSecondQ);
+
+    return true;
+}
+#else
+static bool weight_sensor_filter_float(int32_t rawValue, uint32_t timestamp)
+{
+    ADS123X_ERROR_t err = ADS123X_convertToUnits(&scale, rawValue, &mScaleValue);
+
+    if (err != NoERROR)
+    {
+        return false;
+    }
+
+    mScaleValue = weight_sensor_correct(mScaleValue);
+
+    if (weight_sensor_step_tracking(mScaleValue))
+    {
+        // Follow the new weight and its flow directly until it settles
+        weight_sensor_filters_preload(mScaleValue, weight_sensor_step_tracking_flow());
+        return true;
+    }
 
+    // One sample at a time rather than filter_process_block over the batch: step tracking, the notch and the
+    // request in progress act on each filtered weight before the next sample goes in
+    mFilteredScaleValue = filter_process(weight_filter, NUM_SECTIONS, weight_sensor_notch_process(mScaleValue));
 
-            if (mStableWeightRequested)
+    if (mFlowSource == WEIGHT_SENSOR_FLOW_LEAST_SQUARES)
+    {
+        // The fit is already smooth, it replaces the flow filter too
+        if (weight_sensor_flow_fit_update(mFilteredScaleValue, timestamp))
+        {
+            mGramsPerSecond = linear_fit_window_slope(&mFlowFit);
+            mGramsPerSecondFiltered = mGramsPerSecond;
+        }
+        first_sample = 0;
+    }
+    else
+    {
+        if (!first_sample) {
+            if (mSamplePeriodSeconds > 0.0f)
             {
-                mLastFilteredScaleValue = mFilteredScaleValue;
+                mGramsPerSecond = (mFilteredScaleValue - prev_filtered_weight) / mSamplePeriodSeconds;
             }
+        } else {
+            first_sample = 0;
+        }
 
-            mFilteredScaleValue = filter_process(weight_filter, NUM_SECTIONS, mScaleValue); //mWeightFilterOutputCoefficient * mFilteredScaleValue + mWeightFilterInputCoefficient * mScaleValue;
+        // Filter the flow rate
+        mGramsPerSecondFiltered = filter_process(flow_filter, NUM_SECTIONS, mGramsPerSecond);
+    }
+    prev_filtered_weight = mFilteredScaleValue;
 
-            if (!first_sample) {
-                mGramsPerSecond = (mFilteredScaleValue - prev_filtered_weight) / (1.0/mSamplesPerSecond);
-            } else {
-                first_sample = 0;
-            }
-            prev_filtered_weight = mFilteredScaleValue;
+    mFilteredMilligrams = (int32_t)lroundf(mFilteredScaleValue * 1000.0f);
+
+    return true;
+}
+#endif
+
+// Weight and flow in one step, the flow comes from the state rather than a difference of filtered weights
+static bool weight_sensor_filter_kalman(int32_t rawValue, uint32_t timestamp)
+{
+    if (ADS123X_convertToUnits(&scale, rawValue, &mScaleValue) != NoERROR)
+    {
+        return false;
+    }
+
+    mScaleValue = weight_sensor_correct(mScaleValue);
+
+    if (weight_sensor_step_tracking(mScaleValue))
+    {
+        weight_sensor_filters_preload(mScaleValue, weight_sensor_step_tracking_flow());
+        return true;
+    }
+
+    // The first period after a gap or rate change isn't measured, assume the nominal one
+    float dt = mSamplePeriodSeconds > 0.0f ? mSamplePeriodSeconds : 1.0f / weight_sensor_nominal_sample_rate(scale.speed);
+
+    kalman_update(&mKalman, weight_sensor_notch_process(mScaleValue), dt);
+
+    mFilteredScaleValue = mKalman.value;
+    prev_filtered_weight = mFilteredScaleValue;
+    mGramsPerSecond = mKalman.rate;
+    mGramsPerSecondFiltered = mKalman.rate;
+    mFilteredMilligrams = (int32_t)lroundf(mFilteredScaleValue * 1000.0f);
+    first_sample = 0;
+
+#if WEIGHT_SENSOR_FIXED_POINT
+    // Keep the integer pipeline's history current so switching back to it doesn't step the flow
+    mPrevFilteredMilligramsQ = GRAMS_TO_WEIGHT_Q(mFilteredScaleValue);
+    mPrevFilteredTimestamp = timestamp;
+    mMilligramsPerSecondQ = GRAMS_TO_WEIGHT_Q(mGramsPerSecondFiltered);
+    mFilteredMilligramsPerSecondQ = mMilligramsPerSecondQ;
+#endif
+
+    return true;
+}
+
+static bool weight_sensor_filter(int32_t rawValue, uint32_t timestamp)
+{
+    if (mPipeline == WEIGHT_SENSOR_PIPELINE_KALMAN)
+    {
+        return weight_sensor_filter_kalman(rawValue, timestamp);
+    }
+
+#if WEIGHT_SENSOR_FIXED_POINT
+    return weight_sensor_filter_fixed_point(rawValue, timestamp);
+#else
+    return weight_sensor_filter_float(rawValue, timestamp);
+#endif
+}
+
+// Every conversion goes into the tare history, which restarts when the load moves away from where it started
+static void weight_sensor_tare_history_add(int32_t rawValue)
+{
+    float scaleFactor = fabsf(ADS123X_getScaleFactor(&scale));
+
+    if (mTareHistory.count > 0 && scaleFactor > 0.0f &&
+        fabsf((float)rawValue - mTareHistory.reference) > TARE_HISTORY_RESTART * scaleFactor)
+    {
+        stability_window_reset(&mTareHistory);
+    }
+
+    stability_window_add(&mTareHistory, (float)rawValue);
+}
+
+// Noise of a single conversion in grams from the tare history, 0 if there isn't enough history
+static float weight_sensor_tare_history_noise()
+{
+    float scaleFactor = fabsf(ADS123X_getScaleFactor(&scale));
+
+    if (mTareHistory.count < TARE_NOISE_MIN_SAMPLES || scaleFactor == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    return sqrtf(stability_window_variance(&mTareHistory)) / scaleFactor;
+}
+
+// True if the mean of the history is as good as a fresh average: settled and quiet enough
+static bool weight_sensor_tare_history_settled()
+{
+    float scaleFactor = fabsf(ADS123X_getScaleFactor(&scale));
+
+    if (!stability_window_full(&mTareHistory) || scaleFactor == 0.0f)
+    {
+        return false;
+    }
+
+    float drift = fabsf(stability_window_slope(&mTareHistory)) * (TARE_HISTORY_SAMPLES - 1) / scaleFactor;
+    float standardError = weight_sensor_tare_history_noise() / sqrtf((float)TARE_HISTORY_SAMPLES);
+
+    return drift <= TARE_HISTORY_MAX_DRIFT && standardError <= TARE_TARGET_ERROR;
+}
+
+// Conversions to average for the tare from the noise in the history, limited to half the tare timeout
+static uint16_t weight_sensor_tare_samples()
+{
+    float noise = weight_sensor_tare_history_noise();
+
+    mTareVerifyTolerance = fminf(fmaxf(TARE_VERIFY_TOLERANCE, TARE_VERIFY_SIGMAS * noise), TARE_MAX_VERIFY_TOLERANCE);
+
+    if (noise == 0.0f)
+    {
+        return TARE_SAMPLES;
+    }
+
+    float maxSamples = fminf(TARE_MAX_SAMPLES, weight_sensor_nominal_sample_rate(scale.speed) * WEIGHT_SENSOR_TARE_TIMEOUT_MS / 2000.0f);
+    float samples = ceilf((noise / TARE_TARGET_ERROR) * (noise / TARE_TARGET_ERROR));
+
+    return (uint16_t)fmaxf(fminf(samples, maxSamples), TARE_MIN_SAMPLES);
+}
+
+static void weight_sensor_tare_complete()
+{
+    mWeightSensorCurrentState = NORMAL;
+
+    // Start from zero rather than filtering down from the weight before the tare
+    weight_sensor_filters_preload(0.0f, 0.0f);
+    mStepTracking = false;
+    mStepDetectCount = 0;
+    weight_sensor_zero_tracking_reset();
+    load_cell_compensation_tare(&mCompensation);
+
+    mTareLatencyMs = (sample_clock_now() - mTareStartTime) / (SAMPLE_CLOCK_TICKS_PER_SECOND / 1000);
+    mLastTareAttempts = mRequestAttempts;
+    NRF_LOG_INFO("Tare took %d ms, %d attempts", mTareLatencyMs, mLastTareAttempts);
+
+    weight_sensor_request_complete(WEIGHT_SENSOR_SUCCESS);
+}
+
+static void weight_sensor_process_sample(int32_t rawValue, uint32_t timestamp)
+{
+    if (mRateSwitchDiscardSamples > 0)
+    {
+        mRateSwitchDiscardSamples--;
+        return;
+    }
+
+    weight_sensor_update_sample_period(timestamp);
+
+#if WEIGHT_SENSOR_OUTLIER_REJECTION_ENABLED
+    rawValue = hampel_process(&mOutlierFilter, rawValue);
+#endif
+
+    weight_sensor_tare_history_add(rawValue);
 
-            // Filter the flow rate
-            mGramsPerSecondFiltered = filter_process(flow_filter, NUM_SECTIONS, mGramsPerSecond);
+    // Already settled, the history is the tare average and there's no need to change rate for it
+    if (mWeightSensorCurrentState == START_TARING && weight_sensor_tare_history_settled())
+    {
+        ADS123X_setOffset(&scale, stability_window_mean(&mTareHistory));
+        weight_sensor_tare_complete();
+        return;
+    }
 
+    // Taring and calibration always run at the fast rate
+    if (mWeightSensorCurrentState != NORMAL && scale.speed != SPEED_80SPS)
+    {
+        weight_sensor_set_conversion_rate(SPEED_80SPS);
+        return;
+    }
 
-            if (mStableWeightRequested && fabs(mFilteredScaleValue - mLastFilteredScaleValue) <= 0.01)
+    switch (mWeightSensorCurrentState)
+    {
+        case NORMAL:
+        {
+            if (!weight_sensor_filter(rawValue, timestamp))
             {
-                mStableWeightAcheivedCallback();
-                mStableWeightRequested = false;
+                break;
             }
 
+            weight_sensor_stability_update();
+
             if (mWeightSensorSenseState == SENSING_WEIGHT_CHANGE && mFilteredScaleValue >= mSenseThresholdValue)
             {
                 mWeightMovedFromZeroCallback();
@@ -160,35 +1305,39 @@ static void ads123x_timeout_handler(void * p_context)
                 mNewWeightFilteredValueReceivedCallback(mFilteredScaleValue);
             }
 
+            if (mNewWeightFilteredMilligramsReceivedCallback != NULL)
+            {
+                mNewWeightFilteredMilligramsReceivedCallback(mFilteredMilligrams);
+            }
+
+            weight_sensor_zero_tracking_update();
+            weight_sensor_learning_update();
+            weight_sensor_update_conversion_rate();
+
             break;
         }
         case START_TARING:
         {
-            mTaringAttempts++;
-            mTaringReadCount = 0;
-            mTaringSum = 0;
-            int32_t readValue;
-            if (ADS123X_read(&scale, &readValue) == NoERROR)
+            if (mRequestAttempts >= TARE_MAX_ATTEMPTS)
             {
-                mTaringSum += readValue;
-                mTaringReadCount++;
+                weight_sensor_request_complete(WEIGHT_SENSOR_ERROR_UNSTABLE);
+                break;
             }
 
+            mTaringAttempts++;
+            mRequestAttempts++;
+
+            ADS123X_averageStart(&mTaringAverage, weight_sensor_tare_samples());
+            ADS123X_averageAdd(&mTaringAverage, rawValue);
+
             mWeightSensorCurrentState = TARING;
             break;
         }
         case TARING:
         {
-            int32_t readValue;
-            if (ADS123X_read(&scale, &readValue) == NoERROR)
-            {
-                mTaringSum += readValue;
-                mTaringReadCount++;
-            }
-
-            if (mTaringReadCount >= 20)
+            if (ADS123X_averageAdd(&mTaringAverage, rawValue))
             {
-                ADS123X_setOffset(&scale, mTaringSum/20);
+                ADS123X_setOffset(&scale, ADS123X_averageGet(&mTaringAverage));
                 mWeightSensorCurrentState = VERIFY_TARE;
             }
 
@@ -196,19 +1345,16 @@ static void ads123x_timeout_handler(void * p_context)
         }
         case VERIFY_TARE:
         {    
-            ADS123X_ERROR_t error = ADS123X_getUnits(&scale, &mScaleValue, 1);
+            ADS123X_ERROR_t error = ADS123X_convertToUnits(&scale, rawValue, &mScaleValue);
 
-            if(error == NoERROR && fabs(mScaleValue) < 0.02)
+            if(error == NoERROR && fabsf(mScaleValue) < mTareVerifyTolerance)
             {
-                mWeightSensorCurrentState = NORMAL;
-                mScaleValue = 0.0;
-                mFilteredScaleValue = 0;
-                mGramsPerSecond = 0;
-                mGramsPerSecondFiltered = 0;
+                weight_sensor_tare_complete();
             }
             else if (error != NoERROR)
             {
-                break;
+                // The tare can't be verified without a scale factor
+                weight_sensor_request_complete(WEIGHT_SENSOR_ERROR_NOT_CALIBRATED);
             }
             else
             {
@@ -219,69 +1365,204 @@ static void ads123x_timeout_handler(void * p_context)
         }
         case START_CALIBRATION :
         {
-            mCalibrationReadCount = 0;
-            mCalibrationSum = 0;
-            int32_t readValue;
-            if (ADS123X_read(&scale, &readValue) == NoERROR)
+            if (mRequestAttempts >= CALIBRATION_MAX_ATTEMPTS)
+            {
+                weight_sensor_request_complete(WEIGHT_SENSOR_ERROR_UNSTABLE);
+                break;
+            }
+
+            mRequestAttempts++;
+
+            stability_window_reset(&mCalibrationNoiseWindow);
+            stability_window_add(&mCalibrationNoiseWindow, (float)rawValue);
+
+            mWeightSensorCurrentState = MEASURING_CALIBRATION_NOISE;
+            break;
+        }
+        case MEASURING_CALIBRATION_NOISE:
+        {
+            stability_window_add(&mCalibrationNoiseWindow, (float)rawValue);
+
+            if (!stability_window_full(&mCalibrationNoiseWindow))
+            {
+                break;
+            }
+
+            float countsPerGram = fabsf(stability_window_mean(&mCalibrationNoiseWindow) - ADS123X_getOffset(&scale)) / mCalibrationMass;
+
+            if (countsPerGram < CALIBRATION_MIN_COUNTS_PER_GRAM)
             {
-                mCalibrationSum += readValue;
-                mCalibrationReadCount++;
+                weight_sensor_request_complete(WEIGHT_SENSOR_ERROR_UNSTABLE);
+                break;
             }
 
+            // Conversions needed for the target standard error, including the ones already in the noise window
+            float noiseGrams = sqrtf(stability_window_variance(&mCalibrationNoiseWindow)) / countsPerGram;
+            float samples = ceilf((noiseGrams * noiseGrams) / (CALIBRATION_TARGET_ERROR * CALIBRATION_TARGET_ERROR));
+            uint16_t totalSamples = (uint16_t)fminf(fmaxf(samples, CALIBRATION_MIN_SAMPLES), CALIBRATION_MAX_SAMPLES);
+
+            mCalibrationVerifyTolerance = fmaxf(CALIBRATION_VERIFY_TOLERANCE, CALIBRATION_VERIFY_SIGMAS * noiseGrams);
+
+            NRF_LOG_INFO("Calibration noise " NRF_LOG_FLOAT_MARKER " mg, averaging %d conversions",
+                         NRF_LOG_FLOAT(noiseGrams * 1000.0f), totalSamples);
+
+            ADS123X_averageStart(&mCalibrationAverage, totalSamples - CALIBRATION_NOISE_SAMPLES);
+
             mWeightSensorCurrentState = CALIBRATING;
             break;
         }
         case CALIBRATING:
         {
-            int32_t readValue;
-            if (ADS123X_read(&scale, &readValue) == NoERROR)
+            if (ADS123X_averageAdd(&mCalibrationAverage, rawValue))
+            {
+                // Weighted mean of the noise window and the rest of the average
+                float averageValue = ADS123X_averageGet(&mCalibrationAverage);
+                float noiseWindowWeight = (float)CALIBRATION_NOISE_SAMPLES / (float)(mCalibrationAverage.times + CALIBRATION_NOISE_SAMPLES);
+                averageValue += (stability_window_mean(&mCalibrationNoiseWindow) - averageValue) * noiseWindowWeight;
+
+                float counts = averageValue - ADS123X_getOffset(&scale);
+
+                if (mCalibrationAddingPoint)
+                {
+                    float reading = counts / ADS123X_getScaleFactor(&scale);
+
+                    NRF_LOG_INFO("Calibration point " NRF_LOG_FLOAT_MARKER " g read as " NRF_LOG_FLOAT_MARKER " g",
+                                 NRF_LOG_FLOAT(mCalibrationMass), NRF_LOG_FLOAT(reading));
+
+                    if (!calibration_table_add(&mCalibrationTable, reading, mCalibrationMass))
+                    {
+                        weight_sensor_request_complete(WEIGHT_SENSOR_ERROR_INVALID_ARGUMENT);
+                        break;
+                    }
+                }
+                else
+                {
+                    float scaleFactor = counts / mCalibrationMass;
+                    NRF_LOG_RAW_INFO("Scale Factor:%s%d.%01d\n" , NRF_LOG_FLOAT_SCALES(scaleFactor) );
+                    ADS123X_setScaleFactor(&scale, scaleFactor);
+
+                    // A new span invalidates the nonlinearity points, the span point anchors the new table
+                    calibration_table_reset(&mCalibrationTable);
+                    calibration_table_add(&mCalibrationTable, mCalibrationMass, mCalibrationMass);
+                }
+
+                mWeightSensorCurrentState = VERIFY_CALIBRATION;
+            }
+
+            break;
+        }
+        case VERIFY_CALIBRATION:
+        {    
+            ADS123X_ERROR_t error = ADS123X_convertToUnits(&scale, rawValue, &mScaleValue);
+
+            if (error == NoERROR)
+            {
+                mScaleValue = calibration_table_apply(&mCalibrationTable, mScaleValue);
+            }
+
+            if(error == NoERROR && fabsf(mScaleValue - mCalibrationMass) < mCalibrationVerifyTolerance)
+            {
+                mWeightSensorCurrentState = NORMAL;
+
+                // The span temperature coefficient is relative to the temperature of the calibration
+                if (mCompensation.temperature_valid)
+                {
+                    mCompensation.coefficients.span_reference_temperature = mCompensation.temperature;
+                }
+
+                weight_sensor_request_complete(WEIGHT_SENSOR_SUCCESS);
+            }
+            else if (error != NoERROR)
+            {
+                break;
+            }
+            else
             {
-                mCalibrationSum += readValue;
-                mCalibrationReadCount++;
+                // Retry from the table the request started with
+                mCalibrationTable = mRequestPreviousCalibrationTable;
+                mWeightSensorCurrentState = START_CALIBRATION;
             }
 
-            if (mCalibrationReadCount == 80)
+            break;
+        }
+
+        default:
+            break;
+    }
+    
+}
+
+// Runs in interrupt context, only queues the conversion and its captured start time for weight_sensor_process
+static void weight_sensor_sample_received(int32_t rawValue)
+{
+    sample_ring_push(&mSampleRing, rawValue, sample_clock_get_capture());
+}
+
+static void ads123x_timeout_handler(void * p_context)
+{
+    nrf_drv_gpiote_in_event_disable(pin_DOUT);
+
+    int32_t rawValue;
+
+#if WEIGHT_SENSOR_LOAD_CELL_COUNT > 1
+    if (ADS123X_multi_read(&mScaleCells, &rawValue) == NoERROR)
+#else
+    if (ADS123X_read(&scale, &rawValue) == NoERROR)
+#endif
+    {
+        weight_sensor_sample_received(rawValue);
+    }
+
+    nrf_drv_gpiote_in_event_enable(pin_DOUT, true);
+}
+
+void weight_sensor_process()
+{
+    ring_sample_t batch[SAMPLE_BATCH_SIZE];
+    uint32_t count;
+    bool samplesProcessed = false;
+
+    while ((count = sample_ring_pop_batch(&mSampleRing, batch, SAMPLE_BATCH_SIZE)) > 0)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (mRawSampleReceivedCallback != NULL)
             {
-                float averageValue = mCalibrationSum/80.0;
-                float scaleFactor = ((averageValue - ADS123X_getOffset(&scale))/50.0f);
-                NRF_LOG_RAW_INFO("Scale Factor:%s%d.%01d\n" , NRF_LOG_FLOAT_SCALES(scaleFactor) );
-                ADS123X_setScaleFactor(&scale, scaleFactor);
-                
-                mWeightSensorCurrentState = VERIFY_CALIBRATION;
+                mRawSampleReceivedCallback(batch[i].value);
             }
 
-            break;
+            weight_sensor_process_sample(batch[i].value, batch[i].timestamp);
         }
-        case VERIFY_CALIBRATION:
-        {    
-            ADS123X_ERROR_t error = ADS123X_getUnits(&scale, &mScaleValue, 1);
 
-            if(error == NoERROR && mScaleValue < 50.02 && mScaleValue > 49.98)
-            {
-                float scaleFactor = ADS123X_getScaleFactor(&scale);
+        samplesProcessed = true;
+    }
 
-                mCalibrationCompleteCallback(scaleFactor);
-                mWeightSensorCurrentState = NORMAL;
-            }
-            else if (error != NoERROR)
-            {
-                break;
-            }
-            else
-            {
-                mWeightSensorCurrentState = START_CALIBRATION;
-            }
+    uint32_t overruns = sample_ring_get_overruns(&mSampleRing);
+    if (overruns != mReportedSampleOverruns)
+    {
+        NRF_LOG_WARNING("Weight sensor sample ring overrun, %d samples dropped", overruns);
+        mReportedSampleOverruns = overruns;
+    }
 
-            break;
-        }
+    if (samplesProcessed)
+    {
+        weight_sensor_retune_filters();
+    }
 
-        default:
-            break;
+    if (mRequestTimedOut)
+    {
+        weight_sensor_request_complete(WEIGHT_SENSOR_ERROR_TIMEOUT);
     }
-    
-    mConversionCompleteCallback();
 
-    nrf_drv_gpiote_in_event_enable(pin_DOUT, true);
+    if (mStabilityTimedOut)
+    {
+        weight_sensor_stability_complete(WEIGHT_SENSOR_ERROR_TIMEOUT, mFilteredScaleValue, 0.0f);
+    }
+
+    if (samplesProcessed && mConversionCompleteCallback != NULL)
+    {
+        mConversionCompleteCallback();
+    }
 }
                                             
 void weight_sensor_init(weight_sensor_init_t ws_init)
@@ -290,7 +1571,31 @@ void weight_sensor_init(weight_sensor_init_t ws_init)
 
     mNewWeightValueReceivedCallback = ws_init.newWeightValueReceivedCallback;
     mNewWeightFilteredValueReceivedCallback = ws_init.newWeightFilteredValueReceivedCallback;
+    mNewWeightFilteredMilligramsReceivedCallback = ws_init.newWeightFilteredMilligramsReceivedCallback;
+    mRawSampleReceivedCallback = ws_init.rawSampleReceivedCallback;
     mConversionCompleteCallback = ws_init.conversionCompleteCallback;
+
+    kalman_init(&mKalman, KALMAN_DEFAULT_PROCESS_NOISE, KALMAN_DEFAULT_MEASUREMENT_NOISE);
+
+    // No compensation until coefficients are set
+    load_cell_compensation_coefficients_t noCompensation = { 0 };
+    load_cell_compensation_init(&mCompensation, &noCompensation);
+
+    bool outlierFilterValid = hampel_init(&mOutlierFilter, WEIGHT_SENSOR_OUTLIER_WINDOW, WEIGHT_SENSOR_OUTLIER_THRESHOLD, WEIGHT_SENSOR_OUTLIER_MIN_DEVIATION);
+    APP_ERROR_CHECK_BOOL(outlierFilterValid);
+
+    bool calibrationNoiseWindowValid = stability_window_init(&mCalibrationNoiseWindow, CALIBRATION_NOISE_SAMPLES);
+    APP_ERROR_CHECK_BOOL(calibrationNoiseWindowValid);
+
+    bool tareHistoryValid = stability_window_init(&mTareHistory, TARE_HISTORY_SAMPLES);
+    APP_ERROR_CHECK_BOOL(tareHistoryValid);
+
+    bool flowFitValid = linear_fit_window_init(&mFlowFit, WEIGHT_SENSOR_FLOW_FIT_WINDOW);
+    APP_ERROR_CHECK_BOOL(flowFitValid);
+
+    vibration_detector_init(&mVibration);
+
+    calibration_table_reset(&mCalibrationTable);
     
     ret_code_t err_code;
     nrf_gpio_cfg_output(pin_APWR);
@@ -307,37 +1612,127 @@ void weight_sensor_init(weight_sensor_init_t ws_init)
     // Configure input pins for ADS1232, but don't enable interrupts yet
     in_config.pull = NRF_GPIO_PIN_NOPULL; 
 
+#if WEIGHT_SENSOR_SPIM_READOUT_ENABLED
+    // DRDY only feeds PPI, the CPU is woken by the SPIM once the conversion is in RAM
+    err_code = nrf_drv_gpiote_in_init(pin_DOUT, &in_config, NULL);
+#else
     err_code = nrf_drv_gpiote_in_init(pin_DOUT, &in_config, weight_sensor_data_ready_handler);
+#endif
     APP_ERROR_CHECK(err_code);
     // Don't enable event yet
 
     ADS123X_Init(&scale, pin_DOUT, pin_SCLK, pin_PWDN, pin_GAIN0, pin_GAIN1, pin_SPEED);
 
+#if WEIGHT_SENSOR_LOAD_CELL_COUNT > 1
+    if (!ADS123X_multi_Init(&mScaleCells, &scale, pin_DOUT_CELLS, WEIGHT_SENSOR_LOAD_CELL_COUNT))
+    {
+        APP_ERROR_CHECK(NRF_ERROR_INVALID_PARAM);
+    }
+#endif
+
+#if WEIGHT_SENSOR_SPIM_READOUT_ENABLED
+    err_code = ADS123X_spim_init(&mScaleReader, &scale, (nrfx_spim_t)NRFX_SPIM_INSTANCE(WEIGHT_SENSOR_SPIM_INSTANCE), weight_sensor_sample_received);
+    APP_ERROR_CHECK(err_code);
+
+    // Timestamp the SPIM start, which is triggered by DRDY over PPI
+    err_code = sample_clock_init(ADS123X_spim_readout_started_event_get(&mScaleReader));
+#else
+    // Timestamp the DRDY edge itself
+    err_code = sample_clock_init(nrf_drv_gpiote_in_event_addr_get(pin_DOUT));
+#endif
+    APP_ERROR_CHECK(err_code);
+
     ADS123X_setGain(&scale, GAIN_128);
-    ADS123X_setSpeed(&scale, SPEED_80SPS);
+    weight_sensor_set_conversion_rate(SPEED_80SPS);
     ADS123X_setScaleFactor(&scale, ws_init.scaleFactor);
 
-    weight_sensor_sleep(&scale);
+    err_code = app_timer_create(&m_weight_sensor_request_timer_id, APP_TIMER_MODE_SINGLE_SHOT, weight_sensor_request_timeout_handler);
+    APP_ERROR_CHECK(err_code);
 
-    // Create the timer for running the module's tick handler
-    err_code = app_timer_create(&m_weight_sensor_tick_timer_id, APP_TIMER_MODE_REPEATED, weight_sensor_tick_inc);
+    err_code = app_timer_create(&m_weight_sensor_stability_timer_id, APP_TIMER_MODE_SINGLE_SHOT, weight_sensor_stability_timeout_handler);
     APP_ERROR_CHECK(err_code);
 
+    weight_sensor_sleep(&scale);
+
     mTaringAttempts = 0;
+
+    sample_ring_init(&mSampleRing);
+    mReportedSampleOverruns = 0;
 }
 
-void weight_sensor_tare()
+void weight_sensor_tare(void (*tareCompleteCallback)(weight_sensor_result_t result))
 {
+    if (!weight_sensor_request_start(WEIGHT_SENSOR_REQUEST_TARE, WEIGHT_SENSOR_TARE_TIMEOUT_MS))
+    {
+        if (tareCompleteCallback != NULL)
+        {
+            tareCompleteCallback(WEIGHT_SENSOR_ERROR_BUSY);
+        }
+        return;
+    }
+
+    mRequestCompleteCallback = tareCompleteCallback;
+    mTareStartTime = sample_clock_now();
     mWeightSensorCurrentState = START_TARING;    
 }
 
-void weight_sensor_calibrate(void (*calibrationCompleteCallback)(float scaleFactor ))
+static void weight_sensor_calibration_start(float referenceMass, bool addingPoint,
+                                            void (*calibrationCompleteCallback)(weight_sensor_result_t result, float scaleFactor))
 {
+    weight_sensor_result_t result = WEIGHT_SENSOR_SUCCESS;
+
+    if (!(referenceMass >= CALIBRATION_MIN_MASS && referenceMass <= CALIBRATION_MAX_MASS))
+    {
+        result = WEIGHT_SENSOR_ERROR_INVALID_ARGUMENT;
+    }
+    else if (addingPoint && ADS123X_getScaleFactor(&scale) == 0.0f)
+    {
+        result = WEIGHT_SENSOR_ERROR_NOT_CALIBRATED;
+    }
+    else if (!weight_sensor_request_start(WEIGHT_SENSOR_REQUEST_CALIBRATION, WEIGHT_SENSOR_CALIBRATION_TIMEOUT_MS))
+    {
+        result = WEIGHT_SENSOR_ERROR_BUSY;
+    }
+
+    if (result != WEIGHT_SENSOR_SUCCESS)
+    {
+        if (calibrationCompleteCallback != NULL)
+        {
+            calibrationCompleteCallback(result, ADS123X_getScaleFactor(&scale));
+        }
+        return;
+    }
+
     mCalibrationCompleteCallback = calibrationCompleteCallback;
+    mCalibrationMass = referenceMass;
+    mCalibrationAddingPoint = addingPoint;
 
     mWeightSensorCurrentState = START_CALIBRATION;
 }
 
+void weight_sensor_calibrate(float referenceMass, void (*calibrationCompleteCallback)(weight_sensor_result_t result, float scaleFactor))
+{
+    weight_sensor_calibration_start(referenceMass, false, calibrationCompleteCallback);
+}
+
+void weight_sensor_calibrate_point(float referenceMass, void (*calibrationCompleteCallback)(weight_sensor_result_t result, float scaleFactor))
+{
+    weight_sensor_calibration_start(referenceMass, true, calibrationCompleteCallback);
+}
+
+void weight_sensor_set_calibration_table(const calibration_table_t *table)
+{
+    if (table->count <= CALIBRATION_TABLE_MAX_POINTS)
+    {
+        mCalibrationTable = *table;
+    }
+}
+
+void weight_sensor_get_calibration_table(calibration_table_t *table)
+{
+    *table = mCalibrationTable;
+}
+
 float weight_sensor_get_weight()
 {
     return mScaleValue;
@@ -365,29 +1760,68 @@ float weight_sensor_read_weight()
     return mScaleValue;
 }
 
+int32_t weight_sensor_get_weight_filtered_milligrams()
+{
+    return mFilteredMilligrams;
+}
+
 void weight_sensor_sleep()
 {
-    nrf_drv_gpiote_in_event_enable(pin_DOUT, false);
+    // Whatever was in progress can't finish with the sensor powered down
+    weight_sensor_request_complete(WEIGHT_SENSOR_ERROR_CANCELLED);
+    weight_sensor_stability_complete(WEIGHT_SENSOR_ERROR_CANCELLED, mFilteredScaleValue, 0.0f);
+    weight_sensor_learning_complete(WEIGHT_SENSOR_ERROR_CANCELLED);
+
+    nrf_drv_gpiote_in_event_disable(pin_DOUT);
+#if WEIGHT_SENSOR_SPIM_READOUT_ENABLED
+    ADS123X_spim_disable(&mScaleReader);
+#endif
+#if WEIGHT_SENSOR_LOAD_CELL_COUNT > 1
+    ADS123X_multi_PowerOff(&mScaleCells);
+#else
     ADS123X_PowerOff(&scale);
+#endif
     nrf_gpio_pin_set(pin_APWR);
 
-    ret_code_t err_code = app_timer_stop(m_weight_sensor_tick_timer_id);
-    APP_ERROR_CHECK(err_code);
+    sample_clock_stop();
 }
 
-void weight_sensor_wakeup()
+void weight_sensor_wakeup(void (*readyCallback)(weight_sensor_result_t result))
 {
+    // Anything still queued was converted before the sensor went to sleep
+    sample_ring_flush(&mSampleRing);
+    mLastSampleTimestampValid = false;
+    hampel_reset(&mOutlierFilter);
+    stability_window_reset(&mTareHistory);
+
+    sample_clock_start();
+
     nrf_gpio_pin_clear(pin_APWR);
+#if WEIGHT_SENSOR_LOAD_CELL_COUNT > 1
+    ADS123X_multi_PowerOn(&mScaleCells);
+#else
     ADS123X_PowerOn(&scale);
+#endif
 
-    while (!ADS123X_IsReady(&scale)){}
+    // Start fast for the wakeup tare, the rate drops once the load is at rest
+    weight_sensor_set_conversion_rate(SPEED_80SPS);
 
-    ads123x_timeout_handler(NULL);
+#if WEIGHT_SENSOR_SPIM_READOUT_ENABLED
+    ret_code_t err_code = ADS123X_spim_enable(&mScaleReader);
+    APP_ERROR_CHECK(err_code);
 
+    // Event only, the next DRDY edge starts the SPIM transfer over PPI
+    nrf_drv_gpiote_in_event_enable(pin_DOUT, false);
+#else
+    // The first conversion after power up arrives as a DRDY edge like any other
     nrf_drv_gpiote_in_event_enable(pin_DOUT, true);
+#endif
 
-    ret_code_t err_code = app_timer_start(m_weight_sensor_tick_timer_id, READ_WEIGHT_SENSOR_TICKS_INTERVAL, (void*)&READ_WEIGHT_SENSOR_TICKS_INTERVAL_MS);
-    APP_ERROR_CHECK(err_code);
+    // Ready once the wakeup tare completes, fails if the sensor never produces a settled conversion
+    weight_sensor_request_complete(WEIGHT_SENSOR_ERROR_CANCELLED);
+    weight_sensor_request_start(WEIGHT_SENSOR_REQUEST_WAKEUP, WEIGHT_SENSOR_WAKEUP_TIMEOUT_MS);
+    mRequestCompleteCallback = readyCallback;
+    mTareStartTime = sample_clock_now();
 
     mWeightSensorCurrentState = START_TARING;
 }
@@ -399,37 +1833,297 @@ void weight_sensor_enable_weight_change_sense(void (*weightSenseTriggeredCallbac
     mWeightMovedFromZeroCallback = weightSenseTriggeredCallback;
 }
 
-void weight_sensor_get_stable_weight(void (*stableWeightAcheivedCallback)(void))
+void weight_sensor_get_stable_weight(const weight_sensor_stability_config_t *config,
+                                     void (*stableWeightCallback)(weight_sensor_result_t result, float weight, float confidence))
+{
+    weight_sensor_stability_complete(WEIGHT_SENSOR_ERROR_CANCELLED, mFilteredScaleValue, 0.0f);
+
+    mStabilityConfig = config != NULL ? *config : mStabilityDefaultConfig;
+
+    if (!(mStabilityConfig.tolerance > 0.0f))
+    {
+        mStabilityConfig.tolerance = STABILITY_DEFAULT_TOLERANCE;
+    }
+
+    weight_sensor_stability_restart();
+    mStableWeightCallback = stableWeightCallback;
+
+    if (mStabilityConfig.timeoutMs > 0)
+    {
+        ret_code_t err_code = app_timer_start(m_weight_sensor_stability_timer_id, APP_TIMER_TICKS(mStabilityConfig.timeoutMs), NULL);
+        APP_ERROR_CHECK(err_code);
+    }
+}
+
+void weight_sensor_set_stability_tolerance(float tolerance)
+{
+    if (tolerance > 0.0f)
+    {
+        mStabilityDefaultConfig.tolerance = tolerance;
+    }
+}
+
+void weight_sensor_set_rate_mode(weight_sensor_rate_mode_t mode)
+{
+    mRateMode = mode;
+    mRateQuietTime = 0.0f;
+}
+
+weight_sensor_rate_mode_t weight_sensor_get_rate_mode()
+{
+    return mRateMode;
+}
+
+bool weight_sensor_set_weight_filter_cutoff(float cutoffHz)
+{
+    if (!(cutoffHz >= WEIGHT_SENSOR_MIN_FILTER_CUTOFF_HZ && cutoffHz <= WEIGHT_SENSOR_MAX_FILTER_CUTOFF_HZ))
+    {
+        NRF_LOG_WARNING("Weight filter cutoff out of range: " NRF_LOG_FLOAT_MARKER " Hz", NRF_LOG_FLOAT(cutoffHz));
+        return false;
+    }
+
+    mWeightFilterCutoffHz = cutoffHz;
+
+    if (mFilterDesignSampleRate > 0.0f)
+    {
+        weight_sensor_design_filters(mFilterDesignSampleRate);
+    }
+
+    NRF_LOG_INFO("Weight filter cutoff: " NRF_LOG_FLOAT_MARKER " Hz", NRF_LOG_FLOAT(mWeightFilterCutoffHz));
+
+    return true;
+}
+
+float weight_sensor_get_weight_filter_cutoff()
+{
+    return mWeightFilterCutoffHz;
+}
+
+void weight_sensor_set_pipeline(weight_sensor_pipeline_t pipeline)
+{
+    if (pipeline == mPipeline)
+    {
+        return;
+    }
+
+    // Hand the current estimates over so the output doesn't step
+    weight_sensor_filters_preload(mFilteredScaleValue, mGramsPerSecondFiltered);
+    mPipeline = pipeline;
+}
+
+weight_sensor_pipeline_t weight_sensor_get_pipeline()
+{
+    return mPipeline;
+}
+
+void weight_sensor_set_flow_source(weight_sensor_flow_source_t source)
+{
+    if (source == mFlowSource)
+    {
+        return;
+    }
+
+    // Hand the current estimates over so the flow doesn't step
+    weight_sensor_filters_preload(mFilteredScaleValue, mGramsPerSecondFiltered);
+    mFlowSource = source;
+}
+
+weight_sensor_flow_source_t weight_sensor_get_flow_source()
+{
+    return mFlowSource;
+}
+
+bool weight_sensor_set_flow_fit_window(float seconds)
+{
+    return linear_fit_window_set_length(&mFlowFit, seconds);
+}
+
+float weight_sensor_get_flow_fit_quality()
+{
+    return mFlowFitQuality;
+}
+
+void weight_sensor_set_notch_enabled(bool enabled)
+{
+    if (enabled == mNotchEnabled)
+    {
+        return;
+    }
+
+    // Either way the next vibration is found from a fresh scan
+    mNotchEnabled = enabled;
+    vibration_detector_init(&mVibration);
+    weight_sensor_notch_tune(0.0f);
+
+    NRF_LOG_INFO("Vibration notch %s", enabled ? "enabled" : "disabled");
+}
+
+bool weight_sensor_get_notch_enabled()
+{
+    return mNotchEnabled;
+}
+
+float weight_sensor_get_notch_frequency()
+{
+    return mNotchFrequency;
+}
+
+bool weight_sensor_set_kalman_noise(float processNoise, float measurementNoise)
+{
+    if (!(processNoise > 0.0f && measurementNoise > 0.0f))
+    {
+        return false;
+    }
+
+    kalman_set_noise(&mKalman, processNoise, measurementNoise);
+
+    return true;
+}
+
+void weight_sensor_get_kalman_noise(float *processNoise, float *measurementNoise)
+{
+    *processNoise = mKalman.process_noise;
+    *measurementNoise = mKalman.measurement_noise;
+}
+
+float weight_sensor_get_sampling_rate()
+{
+    if (mSamplePeriodUs == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    return (float)SAMPLE_CLOCK_TICKS_PER_SECOND / mSamplePeriodUs;
+}
+
+float weight_sensor_get_filter_delay()
+{
+    // A notch of width B at f0 delays the weight by B / (2 pi f0^2) well below f0
+    float notchDelay = 0.0f;
+
+    if (mNotchFrequency > 0.0f)
+    {
+        notchDelay = WEIGHT_SENSOR_NOTCH_BANDWIDTH / (2.0f * (float)M_PI * mNotchFrequency * mNotchFrequency);
+    }
+
+    // The constant velocity model follows a steady pour without lag
+    if (mPipeline == WEIGHT_SENSOR_PIPELINE_KALMAN)
+    {
+        return notchDelay;
+    }
+
+    return mWeightFilterDelay + notchDelay;
+}
+
+uint32_t weight_sensor_get_sample_timestamp()
+{
+    return mLastSampleTimestamp;
+}
+
+void weight_sensor_set_temperature(float celsius)
+{
+    load_cell_compensation_set_temperature(&mCompensation, celsius);
+
+    if (!weight_sensor_learning_at_rest())
+    {
+        return;
+    }
+
+    if (mLearningStep == WEIGHT_SENSOR_LEARNING_OFFSET_TEMPCO)
+    {
+        load_cell_temperature_fit_add(&mTemperatureFit, celsius, mFilteredScaleValue);
+    }
+    else if (mLearningStep == WEIGHT_SENSOR_LEARNING_SPAN_TEMPCO && fabsf(mFilteredScaleValue) >= SPAN_LEARNING_MIN_LOAD)
+    {
+        // Compensation is suspended while learning, take the known zero drift out here
+        float offsetDrift = mCompensation.coefficients.offset_tempco * (celsius - mCompensation.tare_temperature);
+        load_cell_temperature_fit_add(&mTemperatureFit, celsius, mFilteredScaleValue - offsetDrift);
+    }
+}
+
+void weight_sensor_set_compensation(const load_cell_compensation_coefficients_t *coefficients)
+{
+    mCompensation.coefficients = *coefficients;
+    mCompensation.creep = 0.0f;
+}
+
+void weight_sensor_get_compensation(load_cell_compensation_coefficients_t *coefficients)
 {
-    mStableWeightRequested = true;
-    mStableWeightAcheivedCallback = stableWeightAcheivedCallback;
+    *coefficients = mCompensation.coefficients;
 }
 
-void weight_sensor_set_weight_filter_input_coefficient(float coefficient)
+bool weight_sensor_learning_start(weight_sensor_learning_t step,
+                                  void (*learningCompleteCallback)(weight_sensor_result_t result, const load_cell_compensation_coefficients_t *coefficients))
 {
-    if (coefficient < 1.0)
+    weight_sensor_learning_complete(WEIGHT_SENSOR_ERROR_CANCELLED);
+
+    if (step != WEIGHT_SENSOR_LEARNING_OFFSET_TEMPCO && step != WEIGHT_SENSOR_LEARNING_SPAN_TEMPCO &&
+        step != WEIGHT_SENSOR_LEARNING_CREEP)
     {
-        mWeightFilterInputCoefficient = coefficient;
-        mWeightFilterOutputCoefficient = 1.0 - mWeightFilterInputCoefficient;
+        return false;
     }
 
-    NRF_LOG_INFO("Filter Output Coefficient:%s%d.%02d\n" , NRF_LOG_FLOAT(mWeightFilterOutputCoefficient) );
+    load_cell_temperature_fit_reset(&mTemperatureFit);
+    mCreepReadingCount = 0;
+    mCreepLearningTime = 0.0f;
+
+    // Learn from the uncompensated weight
+    mCompensation.enabled = false;
+    mCompensation.creep = 0.0f;
+
+    mLearningCompleteCallback = learningCompleteCallback;
+    mLearningStep = step;
+
+    return true;
 }
 
-void weight_sensor_set_weight_filter_output_coefficient(float coefficient)
+void weight_sensor_learning_finish()
 {
-    if (coefficient < 1.0)
+    float slope;
+    float mean;
+    float meanTemperature;
+
+    if (mLearningStep != WEIGHT_SENSOR_LEARNING_OFFSET_TEMPCO && mLearningStep != WEIGHT_SENSOR_LEARNING_SPAN_TEMPCO)
+    {
+        return;
+    }
+
+    if (!load_cell_temperature_fit_get(&mTemperatureFit, TEMPERATURE_LEARNING_MIN_RANGE, &slope, &mean, &meanTemperature))
     {
-        mWeightFilterOutputCoefficient = coefficient;
-        mWeightFilterInputCoefficient = 1.0 - mWeightFilterOutputCoefficient;
+        weight_sensor_learning_complete(WEIGHT_SENSOR_ERROR_UNSTABLE);
+        return;
     }
 
-    NRF_LOG_INFO("Filter Output Coefficient:%s%d.%02d\n" , NRF_LOG_FLOAT(mWeightFilterOutputCoefficient) );
+    if (mLearningStep == WEIGHT_SENSOR_LEARNING_OFFSET_TEMPCO)
+    {
+        mCompensation.coefficients.offset_tempco = slope;
+    }
+    else
+    {
+        // Relative to the reading at the calibration temperature, where the span is correct
+        float referenceReading = mean + slope * (mCompensation.coefficients.span_reference_temperature - meanTemperature);
+
+        if (fabsf(referenceReading) < SPAN_LEARNING_MIN_LOAD)
+        {
+            weight_sensor_learning_complete(WEIGHT_SENSOR_ERROR_UNSTABLE);
+            return;
+        }
+
+        mCompensation.coefficients.span_tempco = slope / referenceReading;
+    }
+
+    weight_sensor_learning_complete(WEIGHT_SENSOR_SUCCESS);
+}
+
+void weight_sensor_set_brew_active(bool active)
+{
+    mBrewActive = active;
+    mZeroTrackingHoldTime = 0.0f;
 }
 
-uint16_t weight_sensor_get_sampling_rate()
+float weight_sensor_get_zero_tracking_correction()
 {
-    return mSamplesPerSecond;
+    return mZeroTrackingCorrection;
 }
 
 uint16_t weight_sensor_get_taring_attempts()
@@ -437,18 +2131,42 @@ uint16_t weight_sensor_get_taring_attempts()
     return mTaringAttempts;
 }
 
-void weight_sensor_data_ready_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
+uint32_t weight_sensor_get_tare_latency_ms()
 {
-   ads123x_timeout_handler(NULL);
+    return mTareLatencyMs;
+}
+
+uint16_t weight_sensor_get_last_tare_attempts()
+{
+    return mLastTareAttempts;
+}
+
+bool weight_sensor_request_pending()
+{
+    return mPendingRequest != WEIGHT_SENSOR_REQUEST_NONE;
 }
 
-void weight_sensor_tick_inc(void * p_context)
+void weight_sensor_data_ready_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
 {
-    uint32_t *tickPeriod = (uint32_t *)p_context;
-    mTimeMS += *tickPeriod;
+   ads123x_timeout_handler(NULL);
 }
 
 float weight_sensor_get_grams_per_second()
 {
     return mGramsPerSecondFiltered;
+}
+
+uint32_t weight_sensor_get_sample_overruns()
+{
+    return sample_ring_get_overruns(&mSampleRing);
+}
+
+uint32_t weight_sensor_get_rejected_samples()
+{
+    return hampel_get_rejected(&mOutlierFilter);
+}
+
+uint32_t weight_sensor_get_sample_queue_high_watermark()
+{
+    return sample_ring_get_high_watermark(&mSampleRing);
 }
\ No newline at end of file
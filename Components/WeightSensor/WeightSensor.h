@@ -1,6 +1,109 @@
 #ifndef WEIGHT_SENSOR_h
 #define WEIGHT_SENSOR_h
 #include "nrf_drv_gpiote.h"
+#include "Compensation/load_cell_compensation.h"
+#include "Calibration/calibration_table.h"
+
+// Number of load cells, each with its own ADS123X sharing SCLK and the control pins.
+// Cells are summed into a single weight
+#ifndef WEIGHT_SENSOR_LOAD_CELL_COUNT
+#define WEIGHT_SENSOR_LOAD_CELL_COUNT 1
+#endif
+
+// Set to 1 to clock conversions out of the ADS123X with a SPIM started over PPI from DRDY,
+// or 0 to bit-bang the conversion in the DRDY interrupt. The SPIM can only read a single load cell
+#ifndef WEIGHT_SENSOR_SPIM_READOUT_ENABLED
+#if WEIGHT_SENSOR_LOAD_CELL_COUNT > 1
+#define WEIGHT_SENSOR_SPIM_READOUT_ENABLED 0
+#else
+#define WEIGHT_SENSOR_SPIM_READOUT_ENABLED 1
+#endif
+#endif
+
+#if WEIGHT_SENSOR_SPIM_READOUT_ENABLED && WEIGHT_SENSOR_LOAD_CELL_COUNT > 1
+#error "SPIM readout only supports a single load cell"
+#endif
+
+// SPIM instance used for the ADS123X readout (SPIM0/1 share resources with TWI0/1, SPIM3 drives the display)
+#ifndef WEIGHT_SENSOR_SPIM_INSTANCE
+#define WEIGHT_SENSOR_SPIM_INSTANCE 2
+#endif
+
+// Set to 1 to drop the ADS123X to 10 SPS while the load is at rest and return to 80 SPS when the weight changes
+#ifndef WEIGHT_SENSOR_ADAPTIVE_RATE_ENABLED
+#define WEIGHT_SENSOR_ADAPTIVE_RATE_ENABLED 1
+#endif
+
+// Set to 1 to follow a large step in the weight (cup or dose placed) directly instead of through the low-pass
+// filter, returning to full smoothing once the new weight has settled
+#ifndef WEIGHT_SENSOR_STEP_DETECTION_ENABLED
+#define WEIGHT_SENSOR_STEP_DETECTION_ENABLED 1
+#endif
+
+// Set to 1 to replace corrupted conversions (readout glitches, an ESD knock) with the median of the last
+// WEIGHT_SENSOR_OUTLIER_WINDOW before they reach the filters or the tare and calibration averages. A conversion is
+// an outlier when it is more than WEIGHT_SENSOR_OUTLIER_THRESHOLD scaled MADs (and WEIGHT_SENSOR_OUTLIER_MIN_DEVIATION
+// codes) from that median
+#ifndef WEIGHT_SENSOR_OUTLIER_REJECTION_ENABLED
+#define WEIGHT_SENSOR_OUTLIER_REJECTION_ENABLED 1
+#endif
+
+#ifndef WEIGHT_SENSOR_OUTLIER_WINDOW
+#define WEIGHT_SENSOR_OUTLIER_WINDOW 5
+#endif
+
+#ifndef WEIGHT_SENSOR_OUTLIER_THRESHOLD
+#define WEIGHT_SENSOR_OUTLIER_THRESHOLD 3.0f
+#endif
+
+#ifndef WEIGHT_SENSOR_OUTLIER_MIN_DEVIATION
+#define WEIGHT_SENSOR_OUTLIER_MIN_DEVIATION 500
+#endif
+
+// Set to 1 to slowly follow drift of the zero (temperature, creep) while the empty platform is at rest near zero.
+// Suspended while a brew is active, see weight_sensor_set_brew_active
+#ifndef WEIGHT_SENSOR_ZERO_TRACKING_ENABLED
+#define WEIGHT_SENSOR_ZERO_TRACKING_ENABLED 1
+#endif
+
+// Set to 1 to run offset removal, scaling, filtering and the flow derivative in integer math (milligrams)
+// instead of float. Weights saturate at +-ADS123X_MILLIGRAMS_MAX (12 kg)
+#ifndef WEIGHT_SENSOR_FIXED_POINT
+#define WEIGHT_SENSOR_FIXED_POINT 0
+#endif
+
+// Pipeline used from power up, see weight_sensor_pipeline_t
+#ifndef WEIGHT_SENSOR_DEFAULT_PIPELINE
+#define WEIGHT_SENSOR_DEFAULT_PIPELINE WEIGHT_SENSOR_PIPELINE_BIQUAD
+#endif
+
+// Flow estimate of the biquad pipeline used from power up, see weight_sensor_flow_source_t
+#ifndef WEIGHT_SENSOR_DEFAULT_FLOW_SOURCE
+#define WEIGHT_SENSOR_DEFAULT_FLOW_SOURCE WEIGHT_SENSOR_FLOW_DIFFERENCE
+#endif
+
+// Length of the least squares flow fit in seconds
+#ifndef WEIGHT_SENSOR_FLOW_FIT_WINDOW
+#define WEIGHT_SENSOR_FLOW_FIT_WINDOW 0.5f
+#endif
+
+// Adaptive notch for pump and grinder vibration ahead of the weight filter, tuned to the strongest periodic
+// component found in the unfiltered weight. Off by default: main applies the saved weigh mode at boot and
+// weigh_mode_apply switches the notch with it, on for espresso where the pump shakes the drip tray and off for
+// the other modes, where a scan that found nothing would only cost time. Builds without the weigh modes can
+// set this to 1
+#ifndef WEIGHT_SENSOR_DEFAULT_NOTCH_ENABLED
+#define WEIGHT_SENSOR_DEFAULT_NOTCH_ENABLED 0
+#endif
+
+// -3 dB width of the vibration notch in Hz
+#ifndef WEIGHT_SENSOR_NOTCH_BANDWIDTH
+#define WEIGHT_SENSOR_NOTCH_BANDWIDTH 2.0f
+#endif
+
+#define WEIGHT_SENSOR_DEFAULT_FILTER_CUTOFF_HZ  6.0f
+#define WEIGHT_SENSOR_MIN_FILTER_CUTOFF_HZ      1.0f
+#define WEIGHT_SENSOR_MAX_FILTER_CUTOFF_HZ      20.0f
 
 #define NRF_LOG_FLOAT_SCALES(val) (uint32_t)(((val) < 0 && (val) > -1.0) ? "-" : ""),   \
                            (int32_t)(val),                                              \
@@ -14,6 +117,7 @@ typedef enum
     TARING,
     VERIFY_TARE,
     START_CALIBRATION,
+    MEASURING_CALIBRATION_NOISE,
     CALIBRATING,
     VERIFY_CALIBRATION,
 } weight_sensor_state_t;
@@ -24,40 +128,201 @@ typedef enum
     SENSING_WEIGHT_CHANGE
 } weight_sensor_sense_state_t;
 
+typedef enum
+{
+    WEIGHT_SENSOR_REQUEST_NONE,
+    WEIGHT_SENSOR_REQUEST_WAKEUP,
+    WEIGHT_SENSOR_REQUEST_TARE,
+    WEIGHT_SENSOR_REQUEST_CALIBRATION
+} weight_sensor_request_t;
+
+typedef enum
+{
+    WEIGHT_SENSOR_SUCCESS,
+    WEIGHT_SENSOR_ERROR_TIMEOUT,        // no settled result before the request timed out (or no conversions at all)
+    WEIGHT_SENSOR_ERROR_UNSTABLE,       // result failed verification too many times
+    WEIGHT_SENSOR_ERROR_NOT_CALIBRATED, // no scale factor to convert conversions with
+    WEIGHT_SENSOR_ERROR_BUSY,           // another request is in progress
+    WEIGHT_SENSOR_ERROR_CANCELLED,      // sensor put to sleep or woken again before the request completed
+    WEIGHT_SENSOR_ERROR_INVALID_ARGUMENT // reference mass out of range or the calibration table is full
+} weight_sensor_result_t;
+
+// Stable weight request. The filtered weight is stable once its standard deviation and its drift over the
+// last minDuration seconds are both within tolerance
+typedef struct
+{
+    float tolerance;        // g
+    float minDuration;      // s
+    uint32_t timeoutMs;     // 0 waits indefinitely
+} weight_sensor_stability_config_t;
+
+// Guided procedures that learn the compensation coefficients
+typedef enum
+{
+    WEIGHT_SENSOR_LEARNING_NONE,
+    WEIGHT_SENSOR_LEARNING_OFFSET_TEMPCO,   // empty platform while the machine warms up, ended by weight_sensor_learning_finish
+    WEIGHT_SENSOR_LEARNING_SPAN_TEMPCO,     // a fixed load on the platform while the machine warms up, ended the same way
+    WEIGHT_SENSOR_LEARNING_CREEP            // place a load of 20 g or more and leave it, ends by itself after 10 minutes
+} weight_sensor_learning_t;
+
+typedef enum
+{
+    WEIGHT_SENSOR_PIPELINE_BIQUAD,      // Butterworth weight filter, flow from its derivative through a second filter
+    WEIGHT_SENSOR_PIPELINE_KALMAN       // constant velocity Kalman filter estimating weight and flow together
+} weight_sensor_pipeline_t;
+
+// Conversion rate policy. Adaptive runs at 10 SPS while the load is at rest and 80 SPS while it is changing
+// (80 SPS throughout if WEIGHT_SENSOR_ADAPTIVE_RATE_ENABLED is 0). Tare and calibration always run at 80 SPS
+typedef enum
+{
+    WEIGHT_SENSOR_RATE_ADAPTIVE,
+    WEIGHT_SENSOR_RATE_FAST,            // 80 SPS
+    WEIGHT_SENSOR_RATE_SLOW             // 10 SPS
+} weight_sensor_rate_mode_t;
+
+// How the biquad pipeline estimates the flow from the filtered weight
+typedef enum
+{
+    WEIGHT_SENSOR_FLOW_DIFFERENCE,      // difference of consecutive filtered weights through the flow filter
+    WEIGHT_SENSOR_FLOW_LEAST_SQUARES    // least squares slope of the filtered weight over the timestamped fit window
+} weight_sensor_flow_source_t;
+
 typedef struct
 {
     float scaleFactor;
     void (*newWeightValueReceivedCallback)(float weight);
     void (*newWeightFilteredValueReceivedCallback)(float weight);
+    void (*newWeightFilteredMilligramsReceivedCallback)(int32_t milligrams);
+    void (*rawSampleReceivedCallback)(int32_t rawValue);      // every conversion, before any processing
     void (*conversionCompleteCallback)(void);
 } weight_sensor_init_t;
 
+// None of the functions below lock against weight_sensor_process, call them from the main loop. Interrupt handlers
+// (touch, BLE, app_timer) have to defer to it, main.c puts them on the app_scheduler
 void weight_sensor_init(weight_sensor_init_t ws_init);
 float weight_sensor_get_weight();
 float weight_sensor_get_weight_filtered();
-void weight_sensor_tare();
-void weight_sensor_calibrate(void (*calibrationCompleteCallback)(float scaleFactor ));
+
+// Tare, calibration and wakeup never wait on the ADC. They are driven by the conversions processed in
+// weight_sensor_process and report their result through the callback (which may be NULL)
+void weight_sensor_tare(void (*tareCompleteCallback)(weight_sensor_result_t result));
+
+// Span calibration with referenceMass grams on the tared platform. Clears the nonlinearity correction points
+void weight_sensor_calibrate(float referenceMass, void (*calibrationCompleteCallback)(weight_sensor_result_t result, float scaleFactor));
+
+// Adds a nonlinearity correction point with referenceMass grams on the tared platform, after a span calibration.
+// Up to CALIBRATION_TABLE_MAX_POINTS masses spread over the range, repeating a mass replaces its point
+void weight_sensor_calibrate_point(float referenceMass, void (*calibrationCompleteCallback)(weight_sensor_result_t result, float scaleFactor));
+
+// Correction points as saved after a calibration
+void weight_sensor_set_calibration_table(const calibration_table_t *table);
+void weight_sensor_get_calibration_table(calibration_table_t *table);
 
 void weight_sensor_sleep();
-void weight_sensor_wakeup();
+// readyCallback is called once the sensor has powered up and completed its wakeup tare
+void weight_sensor_wakeup(void (*readyCallback)(weight_sensor_result_t result));
+
+bool weight_sensor_request_pending();
 
 float weight_sensor_read_weight();
 
+// filtered weight in whole milligrams, as handed to newWeightFilteredMilligramsReceivedCallback
+int32_t weight_sensor_get_weight_filtered_milligrams();
+
 void weight_sensor_enable_weight_change_sense(void (*weightSenseTriggeredCallback)(void));
 
-void weight_sensor_get_stable_weight(void (*stableWeightAcheivedCallback)(void));
+// Wait for the weight to settle without blocking. The callback gets the mean weight over the stable window and a
+// confidence from 0 (just within tolerance) to 1 (no variation), or a timeout or cancellation. config may be
+// NULL for the defaults. A new request replaces one in progress, which is cancelled
+void weight_sensor_get_stable_weight(const weight_sensor_stability_config_t *config,
+                                     void (*stableWeightCallback)(weight_sensor_result_t result, float weight, float confidence));
+
+// Tolerance of weight_sensor_get_stable_weight requests made without a config, in grams
+void weight_sensor_set_stability_tolerance(float tolerance);
+
+// Takes effect from the next conversion processed, without restarting the filters
+void weight_sensor_set_rate_mode(weight_sensor_rate_mode_t mode);
+weight_sensor_rate_mode_t weight_sensor_get_rate_mode();
+
+// Cutoff of the Butterworth weight filter, the flow filter runs at half of it. At 10 SPS the cutoff
+// is limited to 1.5 Hz. Returns false and keeps the current cutoff if it is out of range
+bool weight_sensor_set_weight_filter_cutoff(float cutoffHz);
+float weight_sensor_get_weight_filter_cutoff();
+
+// Select how the weight and flow are estimated. The new pipeline starts from the current estimates
+void weight_sensor_set_pipeline(weight_sensor_pipeline_t pipeline);
+weight_sensor_pipeline_t weight_sensor_get_pipeline();
+
+// Select the flow estimate of the biquad pipeline. The new source starts from the current flow
+void weight_sensor_set_flow_source(weight_sensor_flow_source_t source);
+weight_sensor_flow_source_t weight_sensor_get_flow_source();
+
+// Length of the least squares flow fit, longer is smoother but lags by half of it. Returns false if not positive
+bool weight_sensor_set_flow_fit_window(float seconds);
 
-void weight_sensor_set_weight_filter_input_coefficient(float coefficient);
+// How well the least squares fit follows the filtered weight, 0 (no trend in the noise) to 1 (steady flow)
+float weight_sensor_get_flow_fit_quality();
 
-void weight_sensor_set_weight_filter_output_coefficient(float coefficient);
+// Vibration notch. While enabled the unfiltered weight is scanned for vibration and the notch follows it.
+// The frequency is 0 while no vibration is being notched out
+void weight_sensor_set_notch_enabled(bool enabled);
+bool weight_sensor_get_notch_enabled();
+float weight_sensor_get_notch_frequency();
+
+// Kalman pipeline tuning. processNoise is the spectral density of flow changes in (g/s^2)^2/Hz, higher
+// follows changes in flow faster. measurementNoise is the variance of a conversion in g^2. Returns false and keeps
+// the current tuning unless both are positive
+bool weight_sensor_set_kalman_noise(float processNoise, float measurementNoise);
+void weight_sensor_get_kalman_noise(float *processNoise, float *measurementNoise);
+
+// Load cell temperature in degrees C for the temperature compensation
+void weight_sensor_set_temperature(float celsius);
+
+void weight_sensor_set_compensation(const load_cell_compensation_coefficients_t *coefficients);
+void weight_sensor_get_compensation(load_cell_compensation_coefficients_t *coefficients);
+
+// Start a compensation learning step, replacing (and cancelling) one in progress. Compensation is suspended
+// until it completes. The callback gets the full set of coefficients with the learned ones updated, which
+// are already in use on success. Returns false if step isn't a learning step
+bool weight_sensor_learning_start(weight_sensor_learning_t step,
+                                  void (*learningCompleteCallback)(weight_sensor_result_t result, const load_cell_compensation_coefficients_t *coefficients));
+
+// End a temperature learning step and fit the readings taken so far
+void weight_sensor_learning_finish();
+
+// Zero tracking never runs while a brew is active
+void weight_sensor_set_brew_active(bool active);
+
+// Zero drift taken out by zero tracking since the last tare, in grams
+float weight_sensor_get_zero_tracking_correction();
 
 uint16_t weight_sensor_get_taring_attempts();
-uint16_t weight_sensor_get_sampling_rate();
 
-void weight_sensor_data_ready_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action);
+// Time the last successful tare took from the request, and how many averages it needed. 0 averages means it was
+// taken straight from the conversions that had already settled
+uint32_t weight_sensor_get_tare_latency_ms();
+uint16_t weight_sensor_get_last_tare_attempts();
 
-void weight_sensor_tick_inc(void * p_context);
+float weight_sensor_get_sampling_rate();
+
+// seconds the filtered weight lags the load by while the weight is changing steadily
+float weight_sensor_get_filter_delay();
+
+// sample clock timestamp of the conversion behind the latest weight
+uint32_t weight_sensor_get_sample_timestamp();
+
+void weight_sensor_data_ready_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action);
 
 float weight_sensor_get_grams_per_second();
 
+// Drains the conversions queued by the DRDY interrupt through the filters and state machine.
+// Must be called regularly from the main loop while the sensor is awake
+void weight_sensor_process();
+
+uint32_t weight_sensor_get_sample_overruns();
+
+// conversions replaced by the outlier rejection since power up
+uint32_t weight_sensor_get_rejected_samples();
+uint32_t weight_sensor_get_sample_queue_high_watermark();
+
 #endif
\ No newline at end of file
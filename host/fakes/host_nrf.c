@@ -0,0 +1,1120 @@
+#include "host_nrf.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "nrf_delay.h"
+#include "nrf_drv_gpiote.h"
+#include "nordic_common.h"
+#include "nrf_gpio.h"
+#include "nrfx_ppi.h"
+#include "nrfx_spim.h"
+#include "nrfx_rtc.h"
+#include "nrfx_timer.h"
+
+#define HOST_PIN_COUNT          64
+#define HOST_APP_TIMER_COUNT    16
+#define HOST_SPIM_COUNT         4
+#define HOST_TIMER_COUNT        5
+#define HOST_TIMER_CC_COUNT     6
+#define HOST_RTC_COUNT          3
+
+NRF_GPIO_Type host_gpio_port[2];
+NRF_SPIM_Type host_spim[HOST_SPIM_COUNT] = { { 0 }, { 1 }, { 2 }, { 3 } };
+NRF_TIMER_Type host_timer[HOST_TIMER_COUNT] = { { 0 }, { 1 }, { 2 }, { 3 }, { 4 } };
+NRF_RTC_Type host_rtc[HOST_RTC_COUNT] = { { 0 }, { 1 }, { 2 } };
+volatile uint32_t host_critical_region_depth = 0;
+
+static uint64_t mTimeUs = 0;
+
+static host_gpio_output_handler_t mGpioOutputHandler = NULL;
+static void *mGpioOutputContext = NULL;
+
+typedef struct
+{
+    bool initialised;
+    nrf_gpiote_polarity_t sense;
+    nrf_drv_gpiote_evt_handler_t handler;
+    bool eventEnabled;
+    bool interruptEnabled;
+} host_gpiote_in_t;
+
+static bool mGpioteInitialised = false;
+static host_gpiote_in_t mGpioteIn[HOST_PIN_COUNT];
+
+static app_timer_t *mAppTimers[HOST_APP_TIMER_COUNT];
+static uint32_t mAppTimerCount = 0;
+
+typedef struct
+{
+    bool allocated;
+    bool enabled;
+    uint32_t eep;
+    uint32_t tep;
+    uint32_t fork;
+} host_ppi_channel_t;
+
+typedef struct
+{
+    bool allocated;
+    uint32_t channels;      // mask
+} host_ppi_group_t;
+
+static host_ppi_channel_t mPpiChannels[HOST_PPI_CHANNEL_COUNT];
+static host_ppi_group_t mPpiGroups[HOST_PPI_GROUP_COUNT];
+static uint32_t mEventDepth = 0;
+
+typedef struct
+{
+    bool initialised;
+    bool enabled;
+    nrfx_spim_config_t config;
+    nrfx_spim_evt_handler_t handler;
+    void *context;
+    bool armed;
+    bool startPending;
+    bool running;
+    nrfx_spim_xfer_desc_t xfer;
+    uint32_t flags;
+    uint32_t transfers;
+    uint32_t unarmedStarts;
+} host_spim_t;
+
+static host_spim_t mSpim[HOST_SPIM_COUNT];
+
+typedef struct
+{
+    bool initialised;
+    bool enabled;
+    nrf_timer_frequency_t frequency;
+    uint64_t countBase;         // counter value at enabledAt
+    uint64_t enabledAt;         // us
+    uint32_t cc[HOST_TIMER_CC_COUNT];
+    uint64_t runningUs;         // total time enabled before enabledAt
+} host_timer_t;
+
+static host_timer_t mTimers[HOST_TIMER_COUNT];
+
+typedef struct
+{
+    bool initialised;
+    bool enabled;
+    uint16_t prescaler;
+    nrfx_rtc_handler_t handler;
+    bool overflowInterrupt;
+    uint64_t countBase;         // ticks at enabledAt, not wrapped
+    uint64_t enabledAt;         // us
+    uint64_t overflowsHandled;
+} host_rtc_t;
+
+static host_rtc_t mRtcs[HOST_RTC_COUNT];
+
+static void host_rtc_deliver_overflows(void);
+
+void host_nrf_reset(void)
+{
+    mTimeUs = 0;
+
+    memset(host_gpio_port, 0, sizeof(host_gpio_port));
+    mGpioOutputHandler = NULL;
+    mGpioOutputContext = NULL;
+
+    mGpioteInitialised = false;
+    memset(mGpioteIn, 0, sizeof(mGpioteIn));
+
+    for (uint32_t i = 0; i < mAppTimerCount; i++)
+    {
+        memset(mAppTimers[i], 0, sizeof(*mAppTimers[i]));
+    }
+    mAppTimerCount = 0;
+
+    memset(mPpiChannels, 0, sizeof(mPpiChannels));
+    memset(mPpiGroups, 0, sizeof(mPpiGroups));
+    mEventDepth = 0;
+
+    memset(mSpim, 0, sizeof(mSpim));
+    memset(mTimers, 0, sizeof(mTimers));
+    memset(mRtcs, 0, sizeof(mRtcs));
+
+    host_critical_region_depth = 0;
+}
+
+uint64_t host_nrf_time_us(void)
+{
+    return mTimeUs;
+}
+
+static app_timer_t *host_app_timer_next(uint64_t until)
+{
+    app_timer_t *next = NULL;
+
+    for (uint32_t i = 0; i < mAppTimerCount; i++)
+    {
+        app_timer_t *timer = mAppTimers[i];
+
+        if (timer->active && timer->expiry_us <= until && (next == NULL || timer->expiry_us < next->expiry_us))
+        {
+            next = timer;
+        }
+    }
+
+    return next;
+}
+
+void host_nrf_advance(uint64_t us)
+{
+    uint64_t until = mTimeUs + us;
+    app_timer_t *timer;
+
+    while ((timer = host_app_timer_next(until)) != NULL)
+    {
+        mTimeUs = timer->expiry_us;
+
+        if (timer->mode == APP_TIMER_MODE_REPEATED)
+        {
+            timer->expiry_us += timer->period_us;
+        }
+        else
+        {
+            timer->active = false;
+        }
+
+        timer->handler(timer->p_context);
+        host_rtc_deliver_overflows();
+    }
+
+    mTimeUs = until;
+    host_rtc_deliver_overflows();
+}
+
+uint64_t host_timer_running_us(uint8_t instance)
+{
+    const host_timer_t *timer = &mTimers[instance];
+
+    return timer->runningUs + (timer->enabled ? mTimeUs - timer->enabledAt : 0);
+}
+
+uint32_t host_critical_region_nesting(void)
+{
+    return host_critical_region_depth;
+}
+
+void app_error_handler(ret_code_t error_code, uint32_t line_num, const uint8_t *p_file_name)
+{
+    fprintf(stderr, "%s:%u: error check failed with 0x%x\n", (const char *)p_file_name, line_num, error_code);
+    abort();
+}
+
+void nrf_delay_us(uint32_t us_time)
+{
+    (void)us_time;
+}
+
+void nrf_delay_ms(uint32_t ms_time)
+{
+    (void)ms_time;
+}
+
+// GPIO
+
+static NRF_GPIO_Type *host_gpio_port_get(uint32_t pin)
+{
+    if (pin >= HOST_PIN_COUNT)
+    {
+        fprintf(stderr, "GPIO pin %u out of range\n", pin);
+        abort();
+    }
+
+    return &host_gpio_port[pin >> 5];
+}
+
+void host_gpio_attach(host_gpio_output_handler_t handler, void *context)
+{
+    mGpioOutputHandler = handler;
+    mGpioOutputContext = context;
+}
+
+void nrf_gpio_cfg_output(uint32_t pin_number)
+{
+    host_gpio_port_get(pin_number)->DIR |= 1UL << (pin_number & 0x1F);
+}
+
+void nrf_gpio_cfg_input(uint32_t pin_number, nrf_gpio_pin_pull_t pull_config)
+{
+    (void)pull_config;
+    host_gpio_port_get(pin_number)->DIR &= ~(1UL << (pin_number & 0x1F));
+}
+
+void nrf_gpio_cfg_default(uint32_t pin_number)
+{
+    nrf_gpio_cfg_input(pin_number, NRF_GPIO_PIN_NOPULL);
+}
+
+void nrf_gpio_pin_write(uint32_t pin_number, uint32_t value)
+{
+    NRF_GPIO_Type *port = host_gpio_port_get(pin_number);
+    uint32_t mask = 1UL << (pin_number & 0x1F);
+    uint32_t level = value ? 1 : 0;
+
+    if (((port->OUT & mask) != 0) == (level != 0))
+    {
+        return;
+    }
+
+    port->OUT = level ? (port->OUT | mask) : (port->OUT & ~mask);
+
+    if (mGpioOutputHandler != NULL)
+    {
+        mGpioOutputHandler(mGpioOutputContext, pin_number, level);
+    }
+}
+
+void nrf_gpio_pin_set(uint32_t pin_number)
+{
+    nrf_gpio_pin_write(pin_number, 1);
+}
+
+void nrf_gpio_pin_clear(uint32_t pin_number)
+{
+    nrf_gpio_pin_write(pin_number, 0);
+}
+
+uint32_t nrf_gpio_pin_read(uint32_t pin_number)
+{
+    return (host_gpio_port_get(pin_number)->IN >> (pin_number & 0x1F)) & 1UL;
+}
+
+uint32_t nrf_gpio_pin_out_read(uint32_t pin_number)
+{
+    return (host_gpio_port_get(pin_number)->OUT >> (pin_number & 0x1F)) & 1UL;
+}
+
+uint32_t host_gpio_output(uint32_t pin)
+{
+    return nrf_gpio_pin_out_read(pin);
+}
+
+NRF_GPIO_Type * nrf_gpio_pin_port_decode(uint32_t * p_pin)
+{
+    NRF_GPIO_Type *port = host_gpio_port_get(*p_pin);
+
+    *p_pin &= 0x1F;
+    return port;
+}
+
+uint32_t nrf_gpio_port_in_read(NRF_GPIO_Type const * p_reg)
+{
+    return p_reg->IN;
+}
+
+void host_gpio_drive(uint32_t pin, uint32_t level)
+{
+    NRF_GPIO_Type *port = host_gpio_port_get(pin);
+    uint32_t mask = 1UL << (pin & 0x1F);
+    uint32_t previous = (port->IN & mask) ? 1 : 0;
+
+    level = level ? 1 : 0;
+    port->IN = level ? (port->IN | mask) : (port->IN & ~mask);
+
+    if (level == previous)
+    {
+        return;
+    }
+
+    host_gpiote_in_t *in = &mGpioteIn[pin];
+    nrf_gpiote_polarity_t edge = level ? NRF_GPIOTE_POLARITY_LOTOHI : NRF_GPIOTE_POLARITY_HITOLO;
+
+    if (!in->initialised || !in->eventEnabled || (in->sense & edge) == 0)
+    {
+        return;
+    }
+
+    host_event_raise(HOST_GPIOTE_IN_EVENT(pin));
+
+    if (in->interruptEnabled && in->handler != NULL)
+    {
+        in->handler(pin, in->sense);
+    }
+}
+
+// GPIOTE
+
+bool nrfx_gpiote_is_init(void)
+{
+    return mGpioteInitialised;
+}
+
+ret_code_t nrf_drv_gpiote_init(void)
+{
+    if (mGpioteInitialised)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    mGpioteInitialised = true;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_drv_gpiote_in_init(nrfx_gpiote_pin_t pin,
+                                  nrf_drv_gpiote_in_config_t const * p_config,
+                                  nrf_drv_gpiote_evt_handler_t evt_handler)
+{
+    if (!mGpioteInitialised || pin >= HOST_PIN_COUNT)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if (mGpioteIn[pin].initialised)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    mGpioteIn[pin].initialised = true;
+    mGpioteIn[pin].sense = p_config->sense;
+    mGpioteIn[pin].handler = evt_handler;
+    mGpioteIn[pin].eventEnabled = false;
+    mGpioteIn[pin].interruptEnabled = false;
+
+    return NRF_SUCCESS;
+}
+
+void nrf_drv_gpiote_in_uninit(nrfx_gpiote_pin_t pin)
+{
+    memset(&mGpioteIn[pin], 0, sizeof(mGpioteIn[pin]));
+}
+
+void nrf_drv_gpiote_in_event_enable(nrfx_gpiote_pin_t pin, bool int_enable)
+{
+    mGpioteIn[pin].eventEnabled = true;
+    mGpioteIn[pin].interruptEnabled = int_enable;
+}
+
+void nrf_drv_gpiote_in_event_disable(nrfx_gpiote_pin_t pin)
+{
+    mGpioteIn[pin].eventEnabled = false;
+    mGpioteIn[pin].interruptEnabled = false;
+}
+
+uint32_t nrf_drv_gpiote_in_event_addr_get(nrfx_gpiote_pin_t pin)
+{
+    return HOST_GPIOTE_IN_EVENT(pin);
+}
+
+bool nrf_drv_gpiote_in_is_set(nrfx_gpiote_pin_t pin)
+{
+    return nrf_gpio_pin_read(pin) != 0;
+}
+
+// app_timer
+
+ret_code_t app_timer_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_create(app_timer_id_t const * p_timer_id, app_timer_mode_t mode,
+                            app_timer_timeout_handler_t timeout_handler)
+{
+    app_timer_t *timer = *p_timer_id;
+
+    if (timeout_handler == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (!timer->created)
+    {
+        if (mAppTimerCount >= HOST_APP_TIMER_COUNT)
+        {
+            return NRF_ERROR_NO_MEM;
+        }
+
+        mAppTimers[mAppTimerCount++] = timer;
+    }
+
+    timer->handler = timeout_handler;
+    timer->mode = mode;
+    timer->created = true;
+    timer->active = false;
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context)
+{
+    if (!timer_id->created)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if (timeout_ticks < APP_TIMER_MIN_TIMEOUT_TICKS)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint64_t period = ((uint64_t)timeout_ticks * 1000000ULL + APP_TIMER_CLOCK_FREQ / 2) / APP_TIMER_CLOCK_FREQ;
+
+    timer_id->p_context = p_context;
+    timer_id->period_us = period;
+    timer_id->expiry_us = mTimeUs + period;
+    timer_id->active = true;
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_stop(app_timer_id_t timer_id)
+{
+    timer_id->active = false;
+    return NRF_SUCCESS;
+}
+
+uint32_t app_timer_cnt_get(void)
+{
+    return (uint32_t)((mTimeUs * APP_TIMER_CLOCK_FREQ) / 1000000ULL) & 0x00FFFFFF;
+}
+
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from)
+{
+    return (ticks_to - ticks_from) & 0x00FFFFFF;
+}
+
+// TIMER
+
+static host_timer_t *host_timer_get(nrfx_timer_t const * p_instance)
+{
+    return &mTimers[p_instance->instance_id];
+}
+
+static uint64_t host_timer_count(const host_timer_t *timer)
+{
+    if (!timer->enabled)
+    {
+        return timer->countBase;
+    }
+
+    // 16 MHz divided by 2^frequency
+    return timer->countBase + (((mTimeUs - timer->enabledAt) * 16ULL) >> timer->frequency);
+}
+
+nrfx_err_t nrfx_timer_init(nrfx_timer_t const * p_instance, nrfx_timer_config_t const * p_config,
+                           nrfx_timer_event_handler_t timer_event_handler)
+{
+    host_timer_t *timer = host_timer_get(p_instance);
+
+    if (timer->initialised)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    (void)timer_event_handler;
+
+    memset(timer, 0, sizeof(*timer));
+    timer->initialised = true;
+    timer->frequency = p_config->frequency;
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_timer_uninit(nrfx_timer_t const * p_instance)
+{
+    memset(host_timer_get(p_instance), 0, sizeof(host_timer_t));
+}
+
+void nrfx_timer_enable(nrfx_timer_t const * p_instance)
+{
+    host_timer_t *timer = host_timer_get(p_instance);
+
+    if (!timer->enabled)
+    {
+        timer->enabledAt = mTimeUs;
+        timer->enabled = true;
+    }
+}
+
+void nrfx_timer_disable(nrfx_timer_t const * p_instance)
+{
+    host_timer_t *timer = host_timer_get(p_instance);
+
+    if (timer->enabled)
+    {
+        timer->countBase = host_timer_count(timer);
+        timer->runningUs += mTimeUs - timer->enabledAt;
+        timer->enabled = false;
+    }
+}
+
+bool nrfx_timer_is_enabled(nrfx_timer_t const * p_instance)
+{
+    return host_timer_get(p_instance)->enabled;
+}
+
+void nrfx_timer_clear(nrfx_timer_t const * p_instance)
+{
+    host_timer_t *timer = host_timer_get(p_instance);
+
+    if (timer->enabled)
+    {
+        timer->runningUs += mTimeUs - timer->enabledAt;
+    }
+
+    timer->countBase = 0;
+    timer->enabledAt = mTimeUs;
+}
+
+uint32_t nrfx_timer_task_address_get(nrfx_timer_t const * p_instance, nrf_timer_task_t timer_task)
+{
+    return HOST_TIMER_BASE(p_instance->instance_id) + (uint32_t)timer_task;
+}
+
+uint32_t nrfx_timer_capture(nrfx_timer_t const * p_instance, nrf_timer_cc_channel_t cc_channel)
+{
+    host_timer_t *timer = host_timer_get(p_instance);
+
+    timer->cc[cc_channel] = (uint32_t)host_timer_count(timer);
+    return timer->cc[cc_channel];
+}
+
+uint32_t nrfx_timer_capture_get(nrfx_timer_t const * p_instance, nrf_timer_cc_channel_t cc_channel)
+{
+    return host_timer_get(p_instance)->cc[cc_channel];
+}
+
+void nrf_timer_task_trigger(NRF_TIMER_Type * p_reg, nrf_timer_task_t task)
+{
+    nrfx_timer_t instance = NRFX_TIMER_INSTANCE(p_reg->instance);
+
+    switch (task)
+    {
+        case NRF_TIMER_TASK_START:
+            nrfx_timer_enable(&instance);
+            break;
+
+        case NRF_TIMER_TASK_STOP:
+        case NRF_TIMER_TASK_SHUTDOWN:
+            nrfx_timer_disable(&instance);
+            break;
+
+        case NRF_TIMER_TASK_CLEAR:
+            nrfx_timer_clear(&instance);
+            break;
+
+        default:
+            if (task >= NRF_TIMER_TASK_CAPTURE0 && task < NRF_TIMER_TASK_CAPTURE0 + 4 * HOST_TIMER_CC_COUNT)
+            {
+                UNUSED_RETURN_VALUE(nrfx_timer_capture(&instance, (nrf_timer_cc_channel_t)((task - NRF_TIMER_TASK_CAPTURE0) / 4)));
+            }
+            break;
+    }
+}
+
+uint32_t nrf_timer_cc_read(NRF_TIMER_Type const * p_reg, nrf_timer_cc_channel_t cc_channel)
+{
+    return mTimers[p_reg->instance].cc[cc_channel];
+}
+
+// RTC
+
+static uint64_t host_rtc_ticks(const host_rtc_t *rtc)
+{
+    if (!rtc->enabled)
+    {
+        return rtc->countBase;
+    }
+
+    return rtc->countBase + (mTimeUs - rtc->enabledAt) * RTC_INPUT_FREQ / 1000000ULL / (rtc->prescaler + 1U);
+}
+
+static uint64_t host_rtc_overflows(const host_rtc_t *rtc)
+{
+    return host_rtc_ticks(rtc) >> 24;
+}
+
+// Runs the overflow interrupts of the counters that wrapped, as the RTC interrupt would
+static void host_rtc_deliver_overflows(void)
+{
+    for (uint8_t i = 0; i < HOST_RTC_COUNT; i++)
+    {
+        host_rtc_t *rtc = &mRtcs[i];
+
+        while (rtc->overflowInterrupt && rtc->handler != NULL && rtc->overflowsHandled < host_rtc_overflows(rtc))
+        {
+            rtc->overflowsHandled++;
+            rtc->handler(NRFX_RTC_INT_OVERFLOW);
+        }
+    }
+}
+
+nrfx_err_t nrfx_rtc_init(nrfx_rtc_t const * p_instance, nrfx_rtc_config_t const * p_config, nrfx_rtc_handler_t handler)
+{
+    host_rtc_t *rtc = &mRtcs[p_instance->instance_id];
+
+    if (rtc->initialised)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    memset(rtc, 0, sizeof(*rtc));
+    rtc->initialised = true;
+    rtc->prescaler = p_config->prescaler;
+    rtc->handler = handler;
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_rtc_uninit(nrfx_rtc_t const * p_instance)
+{
+    memset(&mRtcs[p_instance->instance_id], 0, sizeof(host_rtc_t));
+}
+
+void nrfx_rtc_enable(nrfx_rtc_t const * p_instance)
+{
+    host_rtc_t *rtc = &mRtcs[p_instance->instance_id];
+
+    if (!rtc->enabled)
+    {
+        rtc->enabledAt = mTimeUs;
+        rtc->enabled = true;
+    }
+}
+
+void nrfx_rtc_disable(nrfx_rtc_t const * p_instance)
+{
+    host_rtc_t *rtc = &mRtcs[p_instance->instance_id];
+
+    rtc->countBase = host_rtc_ticks(rtc);
+    rtc->enabled = false;
+}
+
+void nrfx_rtc_overflow_enable(nrfx_rtc_t const * p_instance, bool enable_irq)
+{
+    mRtcs[p_instance->instance_id].overflowInterrupt = enable_irq;
+}
+
+void nrfx_rtc_counter_clear(nrfx_rtc_t const * p_instance)
+{
+    host_rtc_t *rtc = &mRtcs[p_instance->instance_id];
+
+    rtc->countBase = 0;
+    rtc->enabledAt = mTimeUs;
+    rtc->overflowsHandled = 0;
+}
+
+uint32_t nrfx_rtc_counter_get(nrfx_rtc_t const * p_instance)
+{
+    return (uint32_t)(host_rtc_ticks(&mRtcs[p_instance->instance_id]) & RTC_COUNTER_COUNTER_Msk);
+}
+
+bool nrf_rtc_event_pending(NRF_RTC_Type * p_reg, nrf_rtc_event_t event)
+{
+    host_rtc_t *rtc = &mRtcs[p_reg->instance];
+
+    if (event == NRF_RTC_EVENT_OVERFLOW)
+    {
+        return rtc->overflowsHandled < host_rtc_overflows(rtc);
+    }
+
+    return false;
+}
+
+// SPIM
+
+void nrf_spim_enable(NRF_SPIM_Type * p_reg)
+{
+    mSpim[p_reg->instance].enabled = true;
+}
+
+void nrf_spim_disable(NRF_SPIM_Type * p_reg)
+{
+    mSpim[p_reg->instance].enabled = false;
+}
+
+uint32_t nrf_spim_event_address_get(NRF_SPIM_Type const * p_reg, nrf_spim_event_t spim_event)
+{
+    return HOST_SPIM_BASE(p_reg->instance) + (uint32_t)spim_event;
+}
+
+uint32_t nrf_spim_task_address_get(NRF_SPIM_Type const * p_reg, nrf_spim_task_t spim_task)
+{
+    return HOST_SPIM_BASE(p_reg->instance) + (uint32_t)spim_task;
+}
+
+nrfx_err_t nrfx_spim_init(nrfx_spim_t const * p_instance, nrfx_spim_config_t const * p_config,
+                          nrfx_spim_evt_handler_t handler, void * p_context)
+{
+    host_spim_t *spim = &mSpim[p_instance->drv_inst_idx];
+
+    if (spim->initialised)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    memset(spim, 0, sizeof(*spim));
+    spim->initialised = true;
+    spim->enabled = true;
+    spim->config = *p_config;
+    spim->handler = handler;
+    spim->context = p_context;
+
+    if (p_config->sck_pin != NRFX_SPIM_PIN_NOT_USED)
+    {
+        // SCK idles low in modes 0 and 1
+        nrf_gpio_cfg_output(p_config->sck_pin);
+        nrf_gpio_pin_clear(p_config->sck_pin);
+    }
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_spim_uninit(nrfx_spim_t const * p_instance)
+{
+    host_spim_t *spim = &mSpim[p_instance->drv_inst_idx];
+    uint32_t transfers = spim->transfers;
+    uint32_t unarmedStarts = spim->unarmedStarts;
+
+    memset(spim, 0, sizeof(*spim));
+    spim->transfers = transfers;
+    spim->unarmedStarts = unarmedStarts;
+}
+
+static void host_spim_transfer(uint8_t instance)
+{
+    host_spim_t *spim = &mSpim[instance];
+
+    spim->startPending = false;
+
+    if (!spim->initialised || !spim->enabled || !spim->armed)
+    {
+        spim->unarmedStarts++;
+        return;
+    }
+
+    spim->armed = false;
+    spim->running = true;
+
+    host_event_raise(HOST_SPIM_BASE(instance) + NRF_SPIM_EVENT_STARTED);
+
+    uint8_t sck = spim->config.sck_pin;
+    uint8_t miso = spim->config.miso_pin;
+
+    for (size_t i = 0; i < spim->xfer.rx_length; i++)
+    {
+        uint8_t byte = 0;
+
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            // Mode 1 shifts on the leading edge and samples on the trailing edge
+            nrf_gpio_pin_set(sck);
+            nrf_gpio_pin_clear(sck);
+
+            uint32_t level = miso != NRFX_SPIM_PIN_NOT_USED ? nrf_gpio_pin_read(miso) : 0;
+
+            if (spim->config.bit_order == NRF_SPIM_BIT_ORDER_MSB_FIRST)
+            {
+                byte = (uint8_t)((byte << 1) | level);
+            }
+            else
+            {
+                byte = (uint8_t)(byte | (level << bit));
+            }
+        }
+
+        spim->xfer.p_rx_buffer[i] = byte;
+    }
+
+    spim->running = false;
+    spim->transfers++;
+
+    host_event_raise(HOST_SPIM_BASE(instance) + NRF_SPIM_EVENT_END);
+
+    if (spim->handler != NULL && (spim->flags & NRFX_SPIM_FLAG_NO_XFER_EVT_HANDLER) == 0)
+    {
+        nrfx_spim_evt_t event =
+        {
+            .type = NRFX_SPIM_EVENT_DONE,
+            .xfer_desc = spim->xfer,
+        };
+
+        spim->handler(&event, spim->context);
+    }
+}
+
+nrfx_err_t nrfx_spim_xfer(nrfx_spim_t const * p_instance, nrfx_spim_xfer_desc_t const * p_xfer_desc, uint32_t flags)
+{
+    host_spim_t *spim = &mSpim[p_instance->drv_inst_idx];
+
+    if (!spim->initialised)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    if (spim->running)
+    {
+        return NRFX_ERROR_BUSY;
+    }
+
+    spim->xfer = *p_xfer_desc;
+    spim->flags = flags;
+    spim->armed = true;
+
+    if ((flags & NRFX_SPIM_FLAG_HOLD_XFER) == 0)
+    {
+        host_spim_transfer(p_instance->drv_inst_idx);
+    }
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_spim_abort(nrfx_spim_t const * p_instance)
+{
+    host_spim_t *spim = &mSpim[p_instance->drv_inst_idx];
+
+    spim->armed = false;
+    spim->startPending = false;
+}
+
+uint32_t nrfx_spim_start_task_get(nrfx_spim_t const * p_instance)
+{
+    return nrf_spim_task_address_get(p_instance->p_reg, NRF_SPIM_TASK_START);
+}
+
+uint32_t nrfx_spim_end_event_get(nrfx_spim_t const * p_instance)
+{
+    return nrf_spim_event_address_get(p_instance->p_reg, NRF_SPIM_EVENT_END);
+}
+
+uint32_t host_spim_transfer_count(uint8_t instance)
+{
+    return mSpim[instance].transfers;
+}
+
+uint32_t host_spim_unarmed_start_count(uint8_t instance)
+{
+    return mSpim[instance].unarmedStarts;
+}
+
+// PPI
+
+static void host_task_trigger(uint32_t task)
+{
+    for (uint8_t i = 0; i < HOST_SPIM_COUNT; i++)
+    {
+        if (task == HOST_SPIM_BASE(i) + NRF_SPIM_TASK_START)
+        {
+            // Runs once every task of the event has been triggered
+            mSpim[i].startPending = true;
+            return;
+        }
+    }
+
+    for (uint8_t i = 0; i < HOST_TIMER_COUNT; i++)
+    {
+        uint32_t base = HOST_TIMER_BASE(i);
+
+        if (task >= base && task < base + NRF_TIMER_TASK_CAPTURE0 + 4 * HOST_TIMER_CC_COUNT)
+        {
+            nrf_timer_task_trigger(&host_timer[i], (nrf_timer_task_t)(task - base));
+            return;
+        }
+    }
+
+    for (uint8_t i = 0; i < HOST_PPI_GROUP_COUNT; i++)
+    {
+        if (task == HOST_PPI_GROUP_TASK(i))
+        {
+            UNUSED_RETURN_VALUE(nrfx_ppi_group_enable(i));
+            return;
+        }
+
+        if (task == HOST_PPI_GROUP_TASK(i) + 4)
+        {
+            UNUSED_RETURN_VALUE(nrfx_ppi_group_disable(i));
+            return;
+        }
+    }
+}
+
+void host_event_raise(uint32_t event_address)
+{
+    uint32_t tasks[2 * HOST_PPI_CHANNEL_COUNT];
+    uint32_t taskCount = 0;
+
+    // Every channel on the event fires before any of its tasks take effect
+    for (uint8_t i = 0; i < HOST_PPI_CHANNEL_COUNT; i++)
+    {
+        host_ppi_channel_t *channel = &mPpiChannels[i];
+
+        if (channel->allocated && channel->enabled && channel->eep == event_address)
+        {
+            tasks[taskCount++] = channel->tep;
+
+            if (channel->fork != 0)
+            {
+                tasks[taskCount++] = channel->fork;
+            }
+        }
+    }
+
+    mEventDepth++;
+
+    for (uint32_t i = 0; i < taskCount; i++)
+    {
+        host_task_trigger(tasks[i]);
+    }
+
+    mEventDepth--;
+
+    if (mEventDepth > 0)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < HOST_SPIM_COUNT; i++)
+    {
+        if (mSpim[i].startPending)
+        {
+            host_spim_transfer(i);
+        }
+    }
+}
+
+nrfx_err_t nrfx_ppi_channel_alloc(nrf_ppi_channel_t * p_channel)
+{
+    for (uint8_t i = 0; i < HOST_PPI_CHANNEL_COUNT; i++)
+    {
+        if (!mPpiChannels[i].allocated)
+        {
+            memset(&mPpiChannels[i], 0, sizeof(mPpiChannels[i]));
+            mPpiChannels[i].allocated = true;
+            *p_channel = i;
+            return NRFX_SUCCESS;
+        }
+    }
+
+    return NRFX_ERROR_NO_MEM;
+}
+
+nrfx_err_t nrfx_ppi_channel_free(nrf_ppi_channel_t channel)
+{
+    memset(&mPpiChannels[channel], 0, sizeof(mPpiChannels[channel]));
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_ppi_channel_assign(nrf_ppi_channel_t channel, uint32_t eep, uint32_t tep)
+{
+    if (channel >= HOST_PPI_CHANNEL_COUNT || !mPpiChannels[channel].allocated)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    mPpiChannels[channel].eep = eep;
+    mPpiChannels[channel].tep = tep;
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_ppi_channel_fork_assign(nrf_ppi_channel_t channel, uint32_t fork_tep)
+{
+    if (channel >= HOST_PPI_CHANNEL_COUNT || !mPpiChannels[channel].allocated)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    mPpiChannels[channel].fork = fork_tep;
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_ppi_channel_enable(nrf_ppi_channel_t channel)
+{
+    if (channel >= HOST_PPI_CHANNEL_COUNT || !mPpiChannels[channel].allocated)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    mPpiChannels[channel].enabled = true;
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_ppi_channel_disable(nrf_ppi_channel_t channel)
+{
+    if (channel >= HOST_PPI_CHANNEL_COUNT || !mPpiChannels[channel].allocated)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    mPpiChannels[channel].enabled = false;
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_ppi_group_alloc(nrf_ppi_channel_group_t * p_group)
+{
+    for (uint8_t i = 0; i < HOST_PPI_GROUP_COUNT; i++)
+    {
+        if (!mPpiGroups[i].allocated)
+        {
+            mPpiGroups[i].allocated = true;
+            mPpiGroups[i].channels = 0;
+            *p_group = i;
+            return NRFX_SUCCESS;
+        }
+    }
+
+    return NRFX_ERROR_NO_MEM;
+}
+
+nrfx_err_t nrfx_ppi_group_free(nrf_ppi_channel_group_t group)
+{
+    memset(&mPpiGroups[group], 0, sizeof(mPpiGroups[group]));
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_ppi_channel_include_in_group(nrf_ppi_channel_t channel, nrf_ppi_channel_group_t group)
+{
+    if (group >= HOST_PPI_GROUP_COUNT || !mPpiGroups[group].allocated)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    mPpiGroups[group].channels |= 1UL << channel;
+    return NRFX_SUCCESS;
+}
+
+static nrfx_err_t host_ppi_group_set(nrf_ppi_channel_group_t group, bool enabled)
+{
+    if (group >= HOST_PPI_GROUP_COUNT || !mPpiGroups[group].allocated)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    for (uint8_t i = 0; i < HOST_PPI_CHANNEL_COUNT; i++)
+    {
+        if (mPpiGroups[group].channels & (1UL << i))
+        {
+            mPpiChannels[i].enabled = enabled;
+        }
+    }
+
+    return NRFX_SUCCESS;
+}
+
+nrfx_err_t nrfx_ppi_group_enable(nrf_ppi_channel_group_t group)
+{
+    return host_ppi_group_set(group, true);
+}
+
+nrfx_err_t nrfx_ppi_group_disable(nrf_ppi_channel_group_t group)
+{
+    return host_ppi_group_set(group, false);
+}
+
+uint32_t nrfx_ppi_task_addr_group_enable_get(nrf_ppi_channel_group_t group)
+{
+    return HOST_PPI_GROUP_TASK(group);
+}
+
+uint32_t nrfx_ppi_task_addr_group_disable_get(nrf_ppi_channel_group_t group)
+{
+    return HOST_PPI_GROUP_TASK(group) + 4;
+}
@@ -0,0 +1,51 @@
+#ifndef HOST_NRF_h
+#define HOST_NRF_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Control side of the host peripherals behind the stub nRF headers.
+//
+// Time only moves when host_nrf_advance is called, app_timer handlers run as their expiry is passed. A device
+// model attaches to the GPIO pins to see the outputs the firmware drives and drives the inputs back with
+// host_gpio_drive. Input edges raise GPIOTE events, events are routed to tasks over PPI, and a SPIM transfer
+// started by its task runs once the event that started it has been handled, as it would on the chip.
+
+// Peripheral register addresses, as returned by the *_addr_get and *_address_get functions
+#define HOST_GPIOTE_IN_EVENT(pin)       (0x40006100UL + 4UL * (pin))
+#define HOST_SPIM_BASE(instance)        (0x40100000UL + 0x1000UL * (instance))
+#define HOST_TIMER_BASE(instance)       (0x40200000UL + 0x1000UL * (instance))
+#define HOST_PPI_GROUP_TASK(group)      (0x4001F000UL + 8UL * (group))  // enable, disable at + 4
+
+typedef void (*host_gpio_output_handler_t)(void *context, uint32_t pin, uint32_t level);
+
+// Everything back to its reset state with the clock at 0. Timers, GPIOTE inputs and PPI allocations are released
+void host_nrf_reset(void);
+
+uint64_t host_nrf_time_us(void);
+
+// Move the clock on, running the app_timer handlers that expire on the way in order
+void host_nrf_advance(uint64_t us);
+
+// Output changes on any pin are passed to handler
+void host_gpio_attach(host_gpio_output_handler_t handler, void *context);
+
+// Input level driven by the device model
+void host_gpio_drive(uint32_t pin, uint32_t level);
+
+uint32_t host_gpio_output(uint32_t pin);
+
+// Route a peripheral event over PPI
+void host_event_raise(uint32_t event_address);
+
+// Transfers clocked by a SPIM instance since reset, and START tasks that found no transfer set up
+uint32_t host_spim_transfer_count(uint8_t instance);
+uint32_t host_spim_unarmed_start_count(uint8_t instance);
+
+// Time a TIMER instance has spent running since reset, the time it holds the high frequency clock on
+uint64_t host_timer_running_us(uint8_t instance);
+
+// Nesting of CRITICAL_REGION_ENTER at the moment
+uint32_t host_critical_region_nesting(void);
+
+#endif
@@ -0,0 +1,130 @@
+#include "ads1232_model.h"
+
+#include <string.h>
+
+#include "host_nrf.h"
+#include "nrf_gpio.h"
+
+#define ADS1232_DATA_BITS           24
+#define ADS1232_READ_PULSES         25      // the 25th forces DOUT high
+#define ADS1232_CALIBRATION_PULSES  26      // the 26th starts an offset calibration
+
+static void ads1232_model_finish_readout(ads1232_model_t *model)
+{
+    if (model->pulses == 0)
+    {
+        return;
+    }
+
+    model->lastPulses = model->pulses;
+
+    if (model->pulses != ADS1232_READ_PULSES && model->pulses != ADS1232_CALIBRATION_PULSES)
+    {
+        model->framingErrors++;
+    }
+
+    model->pulses = 0;
+}
+
+static void ads1232_model_sclk_rising(ads1232_model_t *model)
+{
+    if (!ads1232_model_powered(model))
+    {
+        return;
+    }
+
+    // Clocking a chip that has nothing to send, or past the calibration pulse
+    if ((!model->dataReady && model->pulses == 0) || model->pulses >= ADS1232_CALIBRATION_PULSES)
+    {
+        model->framingErrors++;
+        return;
+    }
+
+    model->pulses++;
+
+    if (model->pulses <= ADS1232_DATA_BITS)
+    {
+        host_gpio_drive(model->pin_DOUT, (model->word >> (ADS1232_DATA_BITS - model->pulses)) & 1U);
+    }
+    else if (model->pulses == ADS1232_READ_PULSES)
+    {
+        model->dataReady = false;
+        model->reads++;
+        host_gpio_drive(model->pin_DOUT, 1);
+    }
+    else
+    {
+        model->calibrating = true;
+        model->calibrations++;
+    }
+}
+
+static void ads1232_model_output_changed(void *context, uint32_t pin, uint32_t level)
+{
+    ads1232_model_t *model = (ads1232_model_t *)context;
+
+    if (pin == model->pin_SCLK && level)
+    {
+        ads1232_model_sclk_rising(model);
+    }
+    else if (pin == model->pin_PDWN && !level)
+    {
+        // Power down resets the interface
+        ads1232_model_finish_readout(model);
+        model->dataReady = false;
+        model->calibrating = false;
+        host_gpio_drive(model->pin_DOUT, 1);
+    }
+}
+
+void ads1232_model_init(ads1232_model_t *model, uint8_t pin_DOUT, uint8_t pin_SCLK, uint8_t pin_PDWN, uint8_t pin_SPEED)
+{
+    memset(model, 0, sizeof(*model));
+
+    model->pin_DOUT = pin_DOUT;
+    model->pin_SCLK = pin_SCLK;
+    model->pin_PDWN = pin_PDWN;
+    model->pin_SPEED = pin_SPEED;
+
+    host_gpio_drive(pin_DOUT, 1);
+    host_gpio_attach(ads1232_model_output_changed, model);
+}
+
+bool ads1232_model_convert(ads1232_model_t *model, int32_t code)
+{
+    if (!ads1232_model_powered(model))
+    {
+        return false;
+    }
+
+    if (model->dataReady && model->pulses == 0)
+    {
+        model->missed++;
+    }
+
+    ads1232_model_finish_readout(model);
+
+    code = code > ADS1232_MODEL_CODE_MAX ? ADS1232_MODEL_CODE_MAX : code;
+    code = code < ADS1232_MODEL_CODE_MIN ? ADS1232_MODEL_CODE_MIN : code;
+
+    model->word = (uint32_t)code & 0xFFFFFFU;
+    model->dataReady = true;
+    model->calibrating = false;
+    model->conversions++;
+
+    // DOUT goes high briefly before new data, so a readout that left it low still sees DRDY fall
+    host_gpio_drive(model->pin_DOUT, 1);
+    host_gpio_drive(model->pin_DOUT, 0);
+
+    return true;
+}
+
+bool ads1232_model_powered(const ads1232_model_t *model)
+{
+    return host_gpio_output(model->pin_PDWN) != 0;
+}
+
+float ads1232_model_data_rate(const ads1232_model_t *model)
+{
+    return host_gpio_output(model->pin_SPEED) ? 80.0f : 10.0f;
+}
@@ -0,0 +1,48 @@
+#ifndef ADS1232_MODEL_h
+#define ADS1232_MODEL_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Behavioural model of the ADS1232 serial interface on the host GPIO, after figures 33 to 35 of the datasheet.
+//
+// A new conversion pulls DOUT/DRDY low. Each SCLK rising edge shifts out the next of the 24 bits, MSB first.
+// The 25th rising edge forces DOUT high again, a 26th starts an offset calibration and the chip stays busy
+// until the next conversion. Readouts with any other number of pulses, and clocks while no data is ready, are
+// counted as framing errors so tests can check the readout drives the interface exactly as the datasheet asks.
+
+#define ADS1232_MODEL_CODE_MAX      0x7FFFFF
+#define ADS1232_MODEL_CODE_MIN      (-0x800000)
+
+typedef struct
+{
+    uint8_t pin_DOUT;
+    uint8_t pin_SCLK;
+    uint8_t pin_PDWN;
+    uint8_t pin_SPEED;
+
+    bool dataReady;         // a conversion is waiting to be clocked out
+    uint32_t word;          // 24 bit two's complement conversion being clocked out
+    uint8_t pulses;         // SCLK rising edges since the conversion became ready
+    bool calibrating;
+
+    uint32_t conversions;
+    uint32_t reads;         // readouts completed by the 25th pulse
+    uint32_t calibrations;  // offset calibrations started by a 26th pulse
+    uint32_t missed;        // conversions replaced before any of them was read
+    uint32_t framingErrors;
+    uint8_t lastPulses;     // pulses of the last finished readout
+} ads1232_model_t;
+
+// Attaches the model to the host GPIO, with DOUT high until the first conversion
+void ads1232_model_init(ads1232_model_t *model, uint8_t pin_DOUT, uint8_t pin_SCLK, uint8_t pin_PDWN, uint8_t pin_SPEED);
+
+// Completes a conversion, saturated to the 24 bit range. Returns false if the chip is powered down
+bool ads1232_model_convert(ads1232_model_t *model, int32_t code);
+
+bool ads1232_model_powered(const ads1232_model_t *model);
+
+// Nominal output data rate selected by the SPEED pin
+float ads1232_model_data_rate(const ads1232_model_t *model);
+
+#endif
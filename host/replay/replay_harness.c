@@ -0,0 +1,178 @@
+#include "replay_harness.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "host_nrf.h"
+#include "Components/WeightSensor/WeightSensor.h"
+
+// Pins the firmware drives the ADS123X on
+extern const uint8_t pin_DOUT;
+extern const uint8_t pin_SCLK;
+extern const uint8_t pin_PWDN;
+extern const uint8_t pin_SPEED;
+
+static replay_harness_config_t mConfig;
+static ads1232_model_t mModel;
+static bool mInitialised = false;
+
+static double mNextConversionUs = 0.0;
+static bool mWeightUpdated = false;
+static float mFilteredGrams = 0.0f;
+
+static bool mReady = false;
+static weight_sensor_result_t mReadyResult = WEIGHT_SENSOR_SUCCESS;
+
+static void replay_harness_filtered_weight(float weight)
+{
+    mWeightUpdated = true;
+    mFilteredGrams = weight;
+}
+
+static void replay_harness_ready(weight_sensor_result_t result)
+{
+    mReady = true;
+    mReadyResult = result;
+}
+
+static uint64_t replay_harness_clock_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static uint64_t replay_harness_clock_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+bool replay_harness_init(const replay_harness_config_t *config)
+{
+    replay_harness_config_t defaults =
+    {
+        .scale_factor = REPLAY_HARNESS_SCALE_FACTOR,
+        .zero_code = REPLAY_HARNESS_ZERO_CODE,
+        .clock_error = 0.0f,
+    };
+
+    mConfig = config != NULL ? *config : defaults;
+
+    // Lets the sensor release the peripherals before they are reset under it
+    if (mInitialised)
+    {
+        weight_sensor_sleep();
+    }
+
+    host_nrf_reset();
+    ads1232_model_init(&mModel, pin_DOUT, pin_SCLK, pin_PWDN, pin_SPEED);
+
+    weight_sensor_init_t init =
+    {
+        .scaleFactor = mConfig.scale_factor,
+        .newWeightFilteredValueReceivedCallback = replay_harness_filtered_weight,
+    };
+
+    weight_sensor_init(init);
+    mInitialised = true;
+
+    mNextConversionUs = 0.0;
+    mReady = false;
+    weight_sensor_wakeup(replay_harness_ready);
+
+    while (!mReady && host_nrf_time_us() < (uint64_t)(REPLAY_HARNESS_WAKEUP_TIMEOUT * 1e6f))
+    {
+        replay_harness_convert(0.0f, NULL);
+    }
+
+    return mReady && mReadyResult == WEIGHT_SENSOR_SUCCESS;
+}
+
+float replay_harness_conversion_period(void)
+{
+    return 1.0f / (ads1232_model_data_rate(&mModel) * (1.0f + mConfig.clock_error));
+}
+
+bool replay_harness_convert(float grams, replay_harness_cost_t *cost)
+{
+    mNextConversionUs += 1e6 * replay_harness_conversion_period();
+    host_nrf_advance((uint64_t)mNextConversionUs - host_nrf_time_us());
+
+    int32_t code = mConfig.zero_code + (int32_t)lroundf(grams * mConfig.scale_factor);
+
+    mWeightUpdated = false;
+    ads1232_model_convert(&mModel, code);
+
+    uint64_t start = replay_harness_clock_ns();
+    uint64_t startCycles = replay_harness_clock_cycles();
+    weight_sensor_process();
+    uint64_t elapsedCycles = replay_harness_clock_cycles() - startCycles;
+    uint64_t elapsed = replay_harness_clock_ns() - start;
+
+    if (cost != NULL)
+    {
+        cost->ns = (uint32_t)elapsed;
+        cost->cycles = (uint32_t)elapsedCycles;
+    }
+
+    return mWeightUpdated;
+}
+
+float replay_harness_filtered_grams(void)
+{
+    return mFilteredGrams;
+}
+
+bool replay_harness_run(trace_replay_t *replay, replay_harness_observer_t observer, void *context)
+{
+    float grams;
+    bool measured = false;
+
+    while (trace_replay_next(replay, replay_harness_conversion_period(), &grams))
+    {
+        replay_harness_cost_t cost;
+
+        if (!replay_harness_convert(grams, &cost))
+        {
+            continue;
+        }
+
+        float flow = weight_sensor_get_grams_per_second();
+
+        trace_replay_measure(replay, mFilteredGrams, flow);
+        trace_replay_add_cost(replay, cost.ns, cost.cycles);
+        measured = true;
+
+        if (observer != NULL)
+        {
+            replay_harness_sample_t sample =
+            {
+                .time = replay->time,
+                .trace_grams = replay->grams,
+                .trace_flow = replay->flow,
+                .grams = mFilteredGrams,
+                .flow = flow,
+                .timestamp = weight_sensor_get_sample_timestamp(),
+            };
+
+            observer(context, &sample);
+        }
+    }
+
+    return measured;
+}
+
+ads1232_model_t *replay_harness_model(void)
+{
+    return &mModel;
+}
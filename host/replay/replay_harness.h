@@ -0,0 +1,67 @@
+#ifndef REPLAY_HARNESS_h
+#define REPLAY_HARNESS_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ads1232_model.h"
+#include "trace_replay.h"
+
+// Runs the firmware weight sensor on the host against the ADS1232 model.
+//
+// Each conversion moves the host clock on by one conversion period at the rate the firmware selected on the
+// SPEED pin, completes the conversion in the model, and lets the readout, the DRDY timestamp and the sample
+// ring work as they do on the device before weight_sensor_process drains the ring. Only
+// weight_sensor_process is timed, that is the work the main loop does for every conversion.
+
+#define REPLAY_HARNESS_SCALE_FACTOR     4000.0f     // codes per gram of a 1 kg load cell at gain 128
+#define REPLAY_HARNESS_ZERO_CODE        12000       // code with the platform empty
+#define REPLAY_HARNESS_WAKEUP_TIMEOUT   5.0f        // s
+
+typedef struct
+{
+    float scale_factor;         // codes per gram
+    int32_t zero_code;
+    float clock_error;          // fraction the ADS123X oscillator runs fast by
+} replay_harness_config_t;
+
+// A conversion that made it through the pipeline, with the trace it was converted from
+typedef struct
+{
+    float time;                 // s into the trace
+    float trace_grams;          // without the noise
+    float trace_flow;
+    float grams;                // filtered weight
+    float flow;                 // filtered flow
+    uint32_t timestamp;         // sample clock ticks of the conversion
+} replay_harness_sample_t;
+
+typedef void (*replay_harness_observer_t)(void *context, const replay_harness_sample_t *sample);
+
+// Powers up the sensor and runs empty conversions until its wakeup tare is complete.
+// config may be NULL for the defaults. Returns false if the sensor isn't ready in time
+bool replay_harness_init(const replay_harness_config_t *config);
+
+// Host cost of weight_sensor_process for one conversion
+typedef struct
+{
+    uint32_t ns;
+    uint32_t cycles;            // time stamp counter, 0 on hosts without one
+} replay_harness_cost_t;
+
+// One conversion of grams. Returns true if it produced a filtered weight, cost (which may be NULL) is what
+// weight_sensor_process took
+bool replay_harness_convert(float grams, replay_harness_cost_t *cost);
+
+// Seconds until the next conversion at the current rate
+float replay_harness_conversion_period(void);
+
+// Filtered weight of the last conversion that produced one
+float replay_harness_filtered_grams(void);
+
+// Runs the trace through the sensor, measuring every filtered weight against it. observer may be NULL
+bool replay_harness_run(trace_replay_t *replay, replay_harness_observer_t observer, void *context);
+
+ads1232_model_t *replay_harness_model(void);
+
+#endif
@@ -0,0 +1,319 @@
+#include "trace_replay.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define TRACE_REPLAY_SEED       12345u
+#define TRACE_REPLAY_POUR_SLOTS 8       // pour, pause, pour, pause, pour and three slots of rest
+
+// Uniform in [-0.5, 0.5) from a linear congruential generator, repeatable for a given seed
+static float trace_replay_uniform(trace_replay_t *replay)
+{
+    replay->seed = replay->seed * 1664525u + 1013904223u;
+
+    return (float)(replay->seed >> 8) / (float)(1u << 24) - 0.5f;
+}
+
+// Roughly gaussian with unit variance, the sum of four uniforms has a variance of 1/3
+static float trace_replay_gaussian(trace_replay_t *replay)
+{
+    float sum = 0.0f;
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        sum += trace_replay_uniform(replay);
+    }
+
+    return sum * sqrtf(3.0f);
+}
+
+// A file trace is over once the rest of its points are within the settle tolerance of the last
+static float trace_replay_file_change_end(const trace_replay_config_t *config)
+{
+    const trace_replay_point_t *points = config->points;
+    float finalGrams = points[config->point_count - 1].grams;
+    uint32_t i = config->point_count - 1;
+
+    while (i > 0 && fabsf(points[i - 1].grams - finalGrams) <= TRACE_REPLAY_SETTLE_TOLERANCE)
+    {
+        i--;
+    }
+
+    return TRACE_REPLAY_LEAD_TIME + points[i].time;
+}
+
+bool trace_replay_init(trace_replay_t *replay, const trace_replay_config_t *config)
+{
+    if (config->trace > TRACE_REPLAY_FILE)
+    {
+        return false;
+    }
+
+    if (config->trace == TRACE_REPLAY_FILE && (config->points == NULL || config->point_count < 2))
+    {
+        return false;
+    }
+
+    memset(replay, 0, sizeof(*replay));
+    replay->config = *config;
+    replay->seed = TRACE_REPLAY_SEED;
+    replay->flow_start = -1.0f;
+    replay->flow_lag = -1.0f;
+
+    if (config->trace == TRACE_REPLAY_FILE)
+    {
+        replay->config.duration = TRACE_REPLAY_LEAD_TIME + config->points[config->point_count - 1].time;
+    }
+
+    if (!(replay->config.duration > TRACE_REPLAY_LEAD_TIME * 2.0f))
+    {
+        return false;
+    }
+
+    float length = config->duration - TRACE_REPLAY_LEAD_TIME;
+
+    switch (config->trace)
+    {
+        case TRACE_REPLAY_RAMP:
+            replay->change_end = TRACE_REPLAY_LEAD_TIME + length / 2.0f;
+            replay->final_grams = config->grams;
+            break;
+
+        case TRACE_REPLAY_POUR:
+            replay->change_end = TRACE_REPLAY_LEAD_TIME + length * 5.0f / TRACE_REPLAY_POUR_SLOTS;
+            replay->final_grams = config->grams;
+            break;
+
+        case TRACE_REPLAY_VIBRATION:
+            replay->change_end = TRACE_REPLAY_LEAD_TIME;
+            replay->final_grams = 0.0f;
+            break;
+
+        case TRACE_REPLAY_FILE:
+            replay->change_end = trace_replay_file_change_end(config);
+            replay->final_grams = config->points[config->point_count - 1].grams;
+            break;
+
+        default:
+            replay->change_end = TRACE_REPLAY_LEAD_TIME;
+            replay->final_grams = config->grams;
+            break;
+    }
+
+    return true;
+}
+
+// Trace weight and flow at time t
+static void trace_replay_evaluate(trace_replay_t *replay, float t)
+{
+    const trace_replay_config_t *config = &replay->config;
+    float elapsed = t - TRACE_REPLAY_LEAD_TIME;
+    float length = config->duration - TRACE_REPLAY_LEAD_TIME;
+
+    replay->grams = 0.0f;
+    replay->flow = 0.0f;
+
+    if (elapsed < 0.0f)
+    {
+        return;
+    }
+
+    switch (config->trace)
+    {
+        case TRACE_REPLAY_STEP:
+            replay->grams = config->grams;
+            break;
+
+        case TRACE_REPLAY_RAMP:
+        {
+            float rampTime = length / 2.0f;
+
+            replay->grams = config->grams * fminf(elapsed / rampTime, 1.0f);
+            replay->flow = elapsed < rampTime ? config->grams / rampTime : 0.0f;
+            break;
+        }
+
+        case TRACE_REPLAY_POUR:
+        {
+            float slotTime = length / TRACE_REPLAY_POUR_SLOTS;
+            float pourFlow = config->grams / 3.0f / slotTime;
+            uint32_t slot = (uint32_t)(elapsed / slotTime);
+
+            // Pours in the even slots up to the third
+            uint32_t poursDone = slot >= 5 ? 3 : (slot + 1) / 2;
+
+            replay->grams = poursDone * config->grams / 3.0f;
+
+            if (slot < 5 && (slot % 2) == 0)
+            {
+                replay->grams += (elapsed - slot * slotTime) * pourFlow;
+                replay->flow = pourFlow;
+            }
+            break;
+        }
+
+        case TRACE_REPLAY_VIBRATION:
+            replay->grams = config->grams * sinf(2.0f * (float)M_PI * config->vibration_hz * elapsed);
+            break;
+
+        case TRACE_REPLAY_FILE:
+        {
+            const trace_replay_point_t *points = config->points;
+            uint32_t last = config->point_count - 1;
+
+            // Samples only move forward in time
+            while (replay->point < last && points[replay->point + 1].time <= elapsed)
+            {
+                replay->point++;
+            }
+
+            if (replay->point == last)
+            {
+                replay->grams = points[last].grams;
+                break;
+            }
+
+            const trace_replay_point_t *from = &points[replay->point];
+            const trace_replay_point_t *to = &points[replay->point + 1];
+            float span = to->time - from->time;
+
+            replay->flow = span > 0.0f ? (to->grams - from->grams) / span : 0.0f;
+            replay->grams = from->grams + replay->flow * (elapsed - from->time);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+bool trace_replay_next(trace_replay_t *replay, float dt, float *grams)
+{
+    replay->time += dt;
+
+    if (replay->time > replay->config.duration)
+    {
+        return false;
+    }
+
+    trace_replay_evaluate(replay, replay->time);
+
+    if (replay->flow > 0.0f && replay->flow_start < 0.0f)
+    {
+        replay->flow_start = replay->time;
+    }
+
+    *grams = replay->grams + replay->config.noise * trace_replay_gaussian(replay);
+
+    return true;
+}
+
+void trace_replay_measure(trace_replay_t *replay, float filteredGrams, float gramsPerSecond)
+{
+    const trace_replay_config_t *config = &replay->config;
+
+    // Every trace ends at rest, at the weight it has once the changes are over
+    float finalGrams = replay->final_grams;
+    float error = filteredGrams - finalGrams;
+
+    if (replay->time >= TRACE_REPLAY_LEAD_TIME)
+    {
+        if (fabsf(error) > TRACE_REPLAY_SETTLE_TOLERANCE)
+        {
+            replay->last_outside = replay->time;
+        }
+
+        // Past the final weight in the direction of the change
+        float beyond = finalGrams < 0.0f ? -error : error;
+        replay->overshoot = fmaxf(replay->overshoot, beyond);
+    }
+
+    // Well clear of the last change, for a trace that only just comes to rest
+    float restTime = config->duration - replay->change_end;
+
+    if (replay->time >= replay->change_end + restTime * (1.0f - TRACE_REPLAY_NOISE_FRACTION))
+    {
+        replay->error_squares += error * error;
+        replay->error_count++;
+    }
+
+    if (replay->flow_start >= 0.0f && replay->flow_lag < 0.0f && replay->flow > 0.0f &&
+        gramsPerSecond >= replay->flow / 2.0f)
+    {
+        replay->flow_lag = replay->time - replay->flow_start;
+    }
+}
+
+void trace_replay_add_cost(trace_replay_t *replay, uint32_t nanoseconds, uint32_t cycles)
+{
+    replay->cost_ns += nanoseconds;
+    replay->cost_cycles += cycles;
+    replay->cost_count++;
+
+    if (nanoseconds > replay->max_ns)
+    {
+        replay->max_ns = nanoseconds;
+    }
+}
+
+void trace_replay_result(const trace_replay_t *replay, trace_replay_result_t *result)
+{
+    result->settle_time = fmaxf(replay->last_outside - replay->change_end, 0.0f);
+    result->overshoot = replay->overshoot;
+    result->noise_rms = replay->error_count > 0 ? sqrtf(replay->error_squares / replay->error_count) : 0.0f;
+    result->mean_ns = replay->cost_count > 0 ? (uint32_t)(replay->cost_ns / replay->cost_count) : 0;
+    result->max_ns = replay->max_ns;
+    result->mean_cycles = replay->cost_count > 0 ? (uint32_t)(replay->cost_cycles / replay->cost_count) : 0;
+
+    // A flow the estimate never caught up with lags for the rest of the trace
+    if (replay->flow_start >= 0.0f && replay->flow_lag < 0.0f)
+    {
+        result->flow_lag = replay->time - replay->flow_start;
+    }
+    else
+    {
+        result->flow_lag = fmaxf(replay->flow_lag, 0.0f);
+    }
+}
+
+uint32_t trace_replay_load_file(const char *path, trace_replay_point_t *points, uint32_t max_points)
+{
+    FILE *file = fopen(path, "r");
+    char line[128];
+    uint32_t count = 0;
+
+    if (file == NULL)
+    {
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        const char *start = line + strspn(line, " \t");
+
+        if (*start == '#' || *start == '\n' || *start == '\r' || *start == '\0')
+        {
+            continue;
+        }
+
+        trace_replay_point_t point;
+
+        if (count >= max_points || sscanf(start, "%f,%f", &point.time, &point.grams) != 2 ||
+            (count > 0 && !(point.time > points[count - 1].time)))
+        {
+            count = 0;
+            break;
+        }
+
+        points[count++] = point;
+    }
+
+    fclose(file);
+
+    return count;
+}
@@ -0,0 +1,102 @@
+#ifndef TRACE_REPLAY_h
+#define TRACE_REPLAY_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Weight traces for evaluating the weight sensor pipeline on the host, and the figures of merit of the filtered
+// weight and flow measured against them.
+//
+// Every trace starts at 0 g for TRACE_REPLAY_LEAD_TIME and ends at rest, so the settle time, overshoot and
+// noise are measured from the end of the trace. The synthetic traces are generated from a few parameters, a
+// file trace interpolates between the points read from a CSV file. The noise added to the weight is repeatable
+// from run to run.
+
+#define TRACE_REPLAY_LEAD_TIME          1.0f    // s at 0 g before the trace changes
+#define TRACE_REPLAY_SETTLE_TOLERANCE   0.1f    // g from the final weight
+#define TRACE_REPLAY_NOISE_FRACTION     0.25f   // last part of the rest at the end the noise is measured over
+#define TRACE_REPLAY_MAX_POINTS         4096
+
+typedef enum
+{
+    TRACE_REPLAY_STEP,          // step of grams
+    TRACE_REPLAY_RAMP,          // grams poured at a steady rate over the first half of the trace
+    TRACE_REPLAY_POUR,          // grams in three pours with pauses between them
+    TRACE_REPLAY_VIBRATION,     // empty platform vibrating grams peak at vibration_hz
+    TRACE_REPLAY_FILE           // points, duration follows from the last of them
+} trace_replay_trace_t;
+
+// Weight of a file trace, time in s from the end of the lead
+typedef struct
+{
+    float time;
+    float grams;
+} trace_replay_point_t;
+
+typedef struct
+{
+    trace_replay_trace_t trace;
+    float grams;
+    float duration;         // s, including the lead
+    float noise;            // g RMS added to every sample
+    float vibration_hz;
+
+    const trace_replay_point_t *points;
+    uint32_t point_count;
+} trace_replay_config_t;
+
+typedef struct
+{
+    float settle_time;      // s from the last change of the trace until the weight stays within tolerance
+    float overshoot;        // g past the final weight
+    float noise_rms;        // g RMS error over the end of the trace
+    float flow_lag;         // s from the flow starting until the estimate reaches half of it, 0 for a step.
+                            // The rest of the trace if it never does
+    uint32_t mean_ns;       // host CPU time to process a conversion
+    uint32_t max_ns;
+    uint32_t mean_cycles;   // host time stamp counter cycles to process a conversion, 0 where there is none
+} trace_replay_result_t;
+
+typedef struct
+{
+    trace_replay_config_t config;
+
+    float time;
+    float grams;            // trace weight of the current sample
+    float flow;             // trace flow of the current sample
+    float final_grams;      // weight the trace ends at
+    float change_end;       // s the last change of the trace is over
+    uint32_t point;         // file trace point at or before time
+    uint32_t seed;
+
+    float last_outside;     // s the weight was last outside the settle tolerance
+    float overshoot;
+    float error_squares;
+    uint32_t error_count;
+    float flow_start;       // s the trace flow started, negative before
+    float flow_lag;         // negative until measured
+
+    uint64_t cost_ns;
+    uint32_t cost_count;
+    uint32_t max_ns;
+    uint64_t cost_cycles;
+} trace_replay_t;
+
+// Returns false if the trace is unknown, its duration too short or a file trace has no points
+bool trace_replay_init(trace_replay_t *replay, const trace_replay_config_t *config);
+
+// Advance dt seconds to the next sample. Returns false once the trace is over
+bool trace_replay_next(trace_replay_t *replay, float dt, float *grams);
+
+// Compare the pipeline output for the current sample with the trace
+void trace_replay_measure(trace_replay_t *replay, float filteredGrams, float gramsPerSecond);
+
+void trace_replay_add_cost(trace_replay_t *replay, uint32_t nanoseconds, uint32_t cycles);
+
+void trace_replay_result(const trace_replay_t *replay, trace_replay_result_t *result);
+
+// Reads "time,grams" lines, times in s increasing from 0. Blank lines and lines starting with # are skipped.
+// Returns the number of points read, 0 if the file can't be read or a line doesn't parse
+uint32_t trace_replay_load_file(const char *path, trace_replay_point_t *points, uint32_t max_points);
+
+#endif
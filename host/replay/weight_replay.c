@@ -0,0 +1,350 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay_harness.h"
+#include "trace_replay.h"
+#include "Components/WeightSensor/WeightSensor.h"
+
+// Replays a synthetic or recorded trace through the weight sensor and prints its figures of merit.
+// With any of the --max options it fails if the result is worse, which is how the tests use it.
+// --dump writes the filtered weight and flow of every conversion, and --reference compares them with a dump
+// of another build of the sensor, how the fixed point pipeline is checked against the float one.
+
+static trace_replay_point_t mPoints[TRACE_REPLAY_MAX_POINTS];
+
+typedef struct
+{
+    float settle;
+    float overshoot;
+    float noise;
+    float flow_lag;
+    float difference;
+} replay_limits_t;
+
+// Filtered output of every conversion, written to and read back from a dump
+typedef struct
+{
+    float time;
+    float grams;
+    float flow;
+} replay_output_t;
+
+#define REPLAY_MAX_OUTPUTS  16384   // conversions, over 200 s at 80 SPS
+
+typedef struct
+{
+    FILE *dump;
+    const replay_output_t *reference;
+    uint32_t reference_count;
+    uint32_t count;
+    float max_difference;       // g
+    float max_flow_difference;  // g/s
+    double difference_squares;
+} replay_comparison_t;
+
+static replay_output_t mReference[REPLAY_MAX_OUTPUTS];
+
+static void replay_observe(void *context, const replay_harness_sample_t *sample)
+{
+    replay_comparison_t *comparison = context;
+
+    if (comparison->dump != NULL)
+    {
+        fprintf(comparison->dump, "%.6f,%.6f,%.6f\n", sample->time, sample->grams, sample->flow);
+    }
+
+    if (comparison->count < comparison->reference_count)
+    {
+        const replay_output_t *reference = &comparison->reference[comparison->count];
+        float difference = fabsf(sample->grams - reference->grams);
+        float flowDifference = fabsf(sample->flow - reference->flow);
+
+        comparison->max_difference = fmaxf(comparison->max_difference, difference);
+        comparison->max_flow_difference = fmaxf(comparison->max_flow_difference, flowDifference);
+        comparison->difference_squares += (double)difference * difference;
+    }
+
+    comparison->count++;
+}
+
+static uint32_t load_reference(const char *path)
+{
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL)
+    {
+        return 0;
+    }
+
+    uint32_t count = 0;
+
+    while (count < REPLAY_MAX_OUTPUTS &&
+           fscanf(file, "%f,%f,%f", &mReference[count].time, &mReference[count].grams, &mReference[count].flow) == 3)
+    {
+        count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [--trace step|ramp|pour|vibration | --file trace.csv]\n"
+            "       [--grams g] [--duration s] [--noise g] [--vibration-hz hz]\n"
+            "       [--pipeline biquad|kalman] [--flow difference|least-squares] [--cutoff hz]\n"
+            "       [--notch] [--rate adaptive|fast|slow] [--scale-factor codes/g]\n"
+            "       [--dump out.csv] [--reference out.csv]\n"
+            "       [--max-settle s] [--max-overshoot g] [--max-noise g] [--max-flow-lag s] [--max-difference g]\n",
+            name);
+}
+
+static bool parse_trace(const char *name, trace_replay_config_t *config)
+{
+    static const struct
+    {
+        const char *name;
+        trace_replay_config_t config;
+    } traces[] =
+    {
+        { "step",       { .trace = TRACE_REPLAY_STEP,      .grams = 100.0f, .duration = 10.0f, .noise = 0.02f } },
+        { "ramp",       { .trace = TRACE_REPLAY_RAMP,      .grams = 100.0f, .duration = 12.0f, .noise = 0.02f } },
+        { "pour",       { .trace = TRACE_REPLAY_POUR,      .grams = 300.0f, .duration = 20.0f, .noise = 0.02f } },
+        { "vibration",  { .trace = TRACE_REPLAY_VIBRATION, .grams = 0.5f,   .duration = 10.0f, .noise = 0.02f,
+                          .vibration_hz = 4.0f } },
+    };
+
+    for (size_t i = 0; i < sizeof(traces) / sizeof(traces[0]); i++)
+    {
+        if (strcmp(name, traces[i].name) == 0)
+        {
+            *config = traces[i].config;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    trace_replay_config_t config;
+    replay_limits_t limits = { -1.0f, -1.0f, -1.0f, -1.0f, -1.0f };
+    replay_harness_config_t harness =
+    {
+        .scale_factor = REPLAY_HARNESS_SCALE_FACTOR,
+        .zero_code = REPLAY_HARNESS_ZERO_CODE,
+    };
+    replay_comparison_t comparison = { 0 };
+    const char *dumpPath = NULL;
+    const char *traceName = "step";
+
+    parse_trace(traceName, &config);
+
+    weight_sensor_pipeline_t pipeline = WEIGHT_SENSOR_PIPELINE_BIQUAD;
+    weight_sensor_flow_source_t flowSource = WEIGHT_SENSOR_FLOW_DIFFERENCE;
+    weight_sensor_rate_mode_t rateMode = WEIGHT_SENSOR_RATE_ADAPTIVE;
+    float cutoff = 0.0f;
+    bool notch = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *option = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(option, "--notch") == 0)
+        {
+            notch = true;
+            continue;
+        }
+
+        if (value == NULL)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+
+        i++;
+
+        if (strcmp(option, "--trace") == 0)
+        {
+            traceName = value;
+            if (!parse_trace(value, &config))
+            {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else if (strcmp(option, "--file") == 0)
+        {
+            uint32_t count = trace_replay_load_file(value, mPoints, TRACE_REPLAY_MAX_POINTS);
+
+            if (count == 0)
+            {
+                fprintf(stderr, "%s: can't read a trace from %s\n", argv[0], value);
+                return 2;
+            }
+
+            traceName = value;
+            config = (trace_replay_config_t){ .trace = TRACE_REPLAY_FILE, .points = mPoints, .point_count = count };
+        }
+        else if (strcmp(option, "--grams") == 0)
+        {
+            config.grams = strtof(value, NULL);
+        }
+        else if (strcmp(option, "--duration") == 0)
+        {
+            config.duration = strtof(value, NULL);
+        }
+        else if (strcmp(option, "--noise") == 0)
+        {
+            config.noise = strtof(value, NULL);
+        }
+        else if (strcmp(option, "--vibration-hz") == 0)
+        {
+            config.vibration_hz = strtof(value, NULL);
+        }
+        else if (strcmp(option, "--pipeline") == 0)
+        {
+            pipeline = strcmp(value, "kalman") == 0 ? WEIGHT_SENSOR_PIPELINE_KALMAN : WEIGHT_SENSOR_PIPELINE_BIQUAD;
+        }
+        else if (strcmp(option, "--flow") == 0)
+        {
+            flowSource = strcmp(value, "least-squares") == 0 ? WEIGHT_SENSOR_FLOW_LEAST_SQUARES : WEIGHT_SENSOR_FLOW_DIFFERENCE;
+        }
+        else if (strcmp(option, "--cutoff") == 0)
+        {
+            cutoff = strtof(value, NULL);
+        }
+        else if (strcmp(option, "--rate") == 0)
+        {
+            rateMode = strcmp(value, "fast") == 0 ? WEIGHT_SENSOR_RATE_FAST :
+                       strcmp(value, "slow") == 0 ? WEIGHT_SENSOR_RATE_SLOW : WEIGHT_SENSOR_RATE_ADAPTIVE;
+        }
+        else if (strcmp(option, "--scale-factor") == 0)
+        {
+            harness.scale_factor = strtof(value, NULL);
+        }
+        else if (strcmp(option, "--dump") == 0)
+        {
+            dumpPath = value;
+        }
+        else if (strcmp(option, "--reference") == 0)
+        {
+            comparison.reference = mReference;
+            comparison.reference_count = load_reference(value);
+
+            if (comparison.reference_count == 0)
+            {
+                fprintf(stderr, "%s: can't read a reference from %s\n", argv[0], value);
+                return 2;
+            }
+        }
+        else if (strcmp(option, "--max-settle") == 0)
+        {
+            limits.settle = strtof(value, NULL);
+        }
+        else if (strcmp(option, "--max-overshoot") == 0)
+        {
+            limits.overshoot = strtof(value, NULL);
+        }
+        else if (strcmp(option, "--max-noise") == 0)
+        {
+            limits.noise = strtof(value, NULL);
+        }
+        else if (strcmp(option, "--max-flow-lag") == 0)
+        {
+            limits.flow_lag = strtof(value, NULL);
+        }
+        else if (strcmp(option, "--max-difference") == 0)
+        {
+            limits.difference = strtof(value, NULL);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    trace_replay_t replay;
+
+    if (!trace_replay_init(&replay, &config))
+    {
+        fprintf(stderr, "%s: invalid trace\n", argv[0]);
+        return 2;
+    }
+
+    if (!replay_harness_init(&harness))
+    {
+        fprintf(stderr, "%s: weight sensor not ready after wakeup\n", argv[0]);
+        return 1;
+    }
+
+    weight_sensor_set_pipeline(pipeline);
+    weight_sensor_set_flow_source(flowSource);
+    weight_sensor_set_rate_mode(rateMode);
+    weight_sensor_set_notch_enabled(notch);
+
+    if (cutoff > 0.0f && !weight_sensor_set_weight_filter_cutoff(cutoff))
+    {
+        fprintf(stderr, "%s: cutoff out of range\n", argv[0]);
+        return 2;
+    }
+
+    if (dumpPath != NULL && (comparison.dump = fopen(dumpPath, "w")) == NULL)
+    {
+        fprintf(stderr, "%s: can't write %s\n", argv[0], dumpPath);
+        return 2;
+    }
+
+    bool measured = replay_harness_run(&replay, replay_observe, &comparison);
+
+    if (comparison.dump != NULL)
+    {
+        fclose(comparison.dump);
+    }
+
+    if (!measured)
+    {
+        fprintf(stderr, "%s: no filtered weight during the trace\n", argv[0]);
+        return 1;
+    }
+
+    trace_replay_result_t result;
+    trace_replay_result(&replay, &result);
+
+    printf("%s: settle %.3f s, overshoot %.3f g, noise %.4f g RMS, flow lag %.3f s, %u ns per conversion (max %u), "
+           "%u cycles\n",
+           traceName, result.settle_time, result.overshoot, result.noise_rms, result.flow_lag,
+           result.mean_ns, result.max_ns, result.mean_cycles);
+
+    // A reference from a different trace or rate doesn't line up conversion for conversion
+    bool mismatched = comparison.reference != NULL && comparison.count != comparison.reference_count;
+
+    if (comparison.reference != NULL)
+    {
+        printf("%s: against the reference %.6f g max, %.6f g RMS, flow %.6f g/s max over %u conversions%s\n",
+               traceName, comparison.max_difference,
+               sqrt(comparison.difference_squares / (comparison.count > 0 ? comparison.count : 1)),
+               comparison.max_flow_difference, comparison.count,
+               mismatched ? ", count differs from the reference" : "");
+    }
+
+    bool failed = (limits.settle >= 0.0f && result.settle_time > limits.settle) ||
+                  (limits.overshoot >= 0.0f && result.overshoot > limits.overshoot) ||
+                  (limits.noise >= 0.0f && result.noise_rms > limits.noise) ||
+                  (limits.flow_lag >= 0.0f && result.flow_lag > limits.flow_lag) ||
+                  (limits.difference >= 0.0f && (mismatched || comparison.max_difference > limits.difference));
+
+    if (failed)
+    {
+        fprintf(stderr, "%s: outside the limits\n", traceName);
+        return 1;
+    }
+
+    return 0;
+}
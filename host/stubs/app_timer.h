@@ -0,0 +1,56 @@
+#ifndef APP_TIMER_H__
+#define APP_TIMER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "app_error.h"
+#include "nordic_common.h"
+#include "sdk_errors.h"
+
+// Host app_timer on the RTC1 tick. Timers expire as host_nrf_advance moves the host clock on
+
+#define APP_TIMER_CLOCK_FREQ        32768
+#define APP_TIMER_MIN_TIMEOUT_TICKS 5
+
+#define APP_TIMER_TICKS(MS)         ((uint32_t)(((uint64_t)(MS) * APP_TIMER_CLOCK_FREQ + 500) / 1000))
+
+typedef void (*app_timer_timeout_handler_t)(void * p_context);
+
+typedef enum
+{
+    APP_TIMER_MODE_SINGLE_SHOT,
+    APP_TIMER_MODE_REPEATED
+} app_timer_mode_t;
+
+typedef struct
+{
+    app_timer_timeout_handler_t handler;
+    app_timer_mode_t            mode;
+    void *                      p_context;
+    bool                        created;
+    bool                        active;
+    uint64_t                    expiry_us;
+    uint64_t                    period_us;
+} app_timer_t;
+
+typedef app_timer_t * app_timer_id_t;
+
+#define APP_TIMER_DEF(timer_id)                                 \
+    static app_timer_t CONCAT_2(timer_id, _data);               \
+    static const app_timer_id_t timer_id = &CONCAT_2(timer_id, _data)
+
+#ifndef CONCAT_2
+#define CONCAT_2(p1, p2)            CONCAT_2_(p1, p2)
+#define CONCAT_2_(p1, p2)           p1##p2
+#endif
+
+ret_code_t app_timer_init(void);
+ret_code_t app_timer_create(app_timer_id_t const * p_timer_id, app_timer_mode_t mode,
+                            app_timer_timeout_handler_t timeout_handler);
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context);
+ret_code_t app_timer_stop(app_timer_id_t timer_id);
+uint32_t app_timer_cnt_get(void);
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from);
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#include "nrf.h"
+
+// The host has no interrupts to mask, the region only counts its nesting so tests can see it was taken
+
+extern volatile uint32_t host_critical_region_depth;
+
+#define CRITICAL_REGION_ENTER()     { host_critical_region_depth++;
+#define CRITICAL_REGION_EXIT()        host_critical_region_depth--; }
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef NORDIC_COMMON_H__
+#define NORDIC_COMMON_H__
+
+#define UNUSED_VARIABLE(X)          ((void)(X))
+#define UNUSED_PARAMETER(X)         UNUSED_VARIABLE(X)
+#define UNUSED_RETURN_VALUE(X)      UNUSED_VARIABLE(X)
+
+#define ARRAY_SIZE(arr)             (sizeof(arr) / sizeof((arr)[0]))
+
+#ifndef MIN
+#define MIN(a, b)                   ((a) < (b) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#define MAX(a, b)                   ((a) < (b) ? (b) : (a))
+#endif
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef NRF_H__
+#define NRF_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Host stand-in for the device header, only the CMSIS intrinsics the sources use
+
+#define __DMB()     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __DSB()     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __ISB()     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __NOP()     ((void)0)
+
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE static inline
+#endif
+
+#endif
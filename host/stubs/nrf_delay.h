@@ -0,0 +1,10 @@
+#ifndef NRF_DELAY_H__
+#define NRF_DELAY_H__
+
+#include <stdint.h>
+
+// Busy waits don't advance the host clock, the models only see the pin edges
+void nrf_delay_us(uint32_t us_time);
+void nrf_delay_ms(uint32_t ms_time);
+
+#endif
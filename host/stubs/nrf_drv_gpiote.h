@@ -0,0 +1,77 @@
+#ifndef NRF_DRV_GPIOTE_H__
+#define NRF_DRV_GPIOTE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "nrf_gpio.h"
+
+// Host GPIOTE. An input edge generates the IN event, which is routed over the host PPI and, with the
+// interrupt enabled, calls the handler straight away as the interrupt would
+
+typedef uint32_t nrfx_gpiote_pin_t;
+
+typedef enum
+{
+    NRF_GPIOTE_POLARITY_LOTOHI = 1,
+    NRF_GPIOTE_POLARITY_HITOLO = 2,
+    NRF_GPIOTE_POLARITY_TOGGLE = 3
+} nrf_gpiote_polarity_t;
+
+typedef struct
+{
+    nrf_gpiote_polarity_t sense;
+    nrf_gpio_pin_pull_t   pull;
+    bool                  is_watcher;
+    bool                  hi_accuracy;
+    bool                  skip_gpio_setup;
+} nrf_drv_gpiote_in_config_t;
+
+typedef void (*nrf_drv_gpiote_evt_handler_t)(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action);
+typedef nrf_drv_gpiote_evt_handler_t nrfx_gpiote_evt_handler_t;
+
+#define NRFX_GPIOTE_CONFIG_IN_SENSE_HITOLO(hi_accu)     \
+{                                                       \
+    .sense = NRF_GPIOTE_POLARITY_HITOLO,                \
+    .pull = NRF_GPIO_PIN_NOPULL,                        \
+    .is_watcher = false,                                \
+    .hi_accuracy = hi_accu,                             \
+    .skip_gpio_setup = false,                           \
+}
+
+#define NRFX_GPIOTE_CONFIG_IN_SENSE_LOTOHI(hi_accu)     \
+{                                                       \
+    .sense = NRF_GPIOTE_POLARITY_LOTOHI,                \
+    .pull = NRF_GPIO_PIN_NOPULL,                        \
+    .is_watcher = false,                                \
+    .hi_accuracy = hi_accu,                             \
+    .skip_gpio_setup = false,                           \
+}
+
+#define NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(hi_accu)     \
+{                                                       \
+    .sense = NRF_GPIOTE_POLARITY_TOGGLE,                \
+    .pull = NRF_GPIO_PIN_NOPULL,                        \
+    .is_watcher = false,                                \
+    .hi_accuracy = hi_accu,                             \
+    .skip_gpio_setup = false,                           \
+}
+
+#define GPIOTE_CONFIG_IN_SENSE_HITOLO   NRFX_GPIOTE_CONFIG_IN_SENSE_HITOLO
+#define GPIOTE_CONFIG_IN_SENSE_LOTOHI   NRFX_GPIOTE_CONFIG_IN_SENSE_LOTOHI
+#define GPIOTE_CONFIG_IN_SENSE_TOGGLE   NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE
+
+bool nrfx_gpiote_is_init(void);
+ret_code_t nrf_drv_gpiote_init(void);
+
+ret_code_t nrf_drv_gpiote_in_init(nrfx_gpiote_pin_t pin,
+                                  nrf_drv_gpiote_in_config_t const * p_config,
+                                  nrf_drv_gpiote_evt_handler_t evt_handler);
+void nrf_drv_gpiote_in_uninit(nrfx_gpiote_pin_t pin);
+void nrf_drv_gpiote_in_event_enable(nrfx_gpiote_pin_t pin, bool int_enable);
+void nrf_drv_gpiote_in_event_disable(nrfx_gpiote_pin_t pin);
+uint32_t nrf_drv_gpiote_in_event_addr_get(nrfx_gpiote_pin_t pin);
+bool nrf_drv_gpiote_in_is_set(nrfx_gpiote_pin_t pin);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef NRF_GPIO_H__
+#define NRF_GPIO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Host GPIO, two 32 pin ports. Outputs are passed on to the device model attached with host_gpio_attach,
+// inputs are driven by it
+
+#define NRF_GPIO_PIN_MAP(port, pin)     (((port) << 5) | ((pin) & 0x1F))
+
+typedef enum
+{
+    NRF_GPIO_PIN_NOPULL   = 0,
+    NRF_GPIO_PIN_PULLDOWN = 1,
+    NRF_GPIO_PIN_PULLUP   = 3
+} nrf_gpio_pin_pull_t;
+
+typedef struct
+{
+    volatile uint32_t OUT;
+    volatile uint32_t IN;
+    volatile uint32_t DIR;
+} NRF_GPIO_Type;
+
+extern NRF_GPIO_Type host_gpio_port[2];
+
+#define NRF_P0  (&host_gpio_port[0])
+#define NRF_P1  (&host_gpio_port[1])
+
+void nrf_gpio_cfg_output(uint32_t pin_number);
+void nrf_gpio_cfg_input(uint32_t pin_number, nrf_gpio_pin_pull_t pull_config);
+void nrf_gpio_cfg_default(uint32_t pin_number);
+
+void nrf_gpio_pin_set(uint32_t pin_number);
+void nrf_gpio_pin_clear(uint32_t pin_number);
+void nrf_gpio_pin_write(uint32_t pin_number, uint32_t value);
+uint32_t nrf_gpio_pin_read(uint32_t pin_number);
+uint32_t nrf_gpio_pin_out_read(uint32_t pin_number);
+
+NRF_GPIO_Type * nrf_gpio_pin_port_decode(uint32_t * p_pin);
+uint32_t nrf_gpio_port_in_read(NRF_GPIO_Type const * p_reg);
+
+#endif
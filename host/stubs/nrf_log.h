@@ -0,0 +1,30 @@
+#ifndef NRF_LOG_H_
+#define NRF_LOG_H_
+
+#include <stdint.h>
+
+// Logging is discarded on the host, the arguments are still evaluated as they are on the device
+
+static inline void nrf_log_host_discard(int unused, ...)
+{
+    (void)unused;
+}
+
+#define NRF_LOG_HOST_DISCARD(...)       nrf_log_host_discard(0, __VA_ARGS__)
+
+#define NRF_LOG_ERROR(...)              NRF_LOG_HOST_DISCARD(__VA_ARGS__)
+#define NRF_LOG_WARNING(...)            NRF_LOG_HOST_DISCARD(__VA_ARGS__)
+#define NRF_LOG_INFO(...)               NRF_LOG_HOST_DISCARD(__VA_ARGS__)
+#define NRF_LOG_DEBUG(...)              NRF_LOG_HOST_DISCARD(__VA_ARGS__)
+#define NRF_LOG_RAW_INFO(...)           NRF_LOG_HOST_DISCARD(__VA_ARGS__)
+#define NRF_LOG_HEXDUMP_INFO(p, len)    ((void)(p), (void)(len))
+#define NRF_LOG_FLUSH()                 ((void)0)
+#define NRF_LOG_PROCESS()               false
+
+#define NRF_LOG_FLOAT_MARKER            "%s%d.%02d"
+#define NRF_LOG_FLOAT(val)              (uint32_t)(uintptr_t)(((val) < 0 && (val) > -1.0) ? "-" : ""),     \
+                                        (int32_t)(val),                                         \
+                                        (int32_t)((((val) > 0) ? (val) - (int32_t)(val)         \
+                                                               : (int32_t)(val) - (val)) * 100)
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef NRF_RTC_H__
+#define NRF_RTC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Host RTC registers, only what identifies an instance and its events
+
+typedef struct
+{
+    uint32_t instance;
+} NRF_RTC_Type;
+
+extern NRF_RTC_Type host_rtc[3];
+
+#define RTC_INPUT_FREQ                  32768
+#define RTC_FREQ_TO_PRESCALER(FREQ)     (uint16_t)(((RTC_INPUT_FREQ) / (FREQ)) - 1)
+#define RTC_COUNTER_COUNTER_Msk         0xFFFFFFUL
+
+typedef enum
+{
+    NRF_RTC_EVENT_TICK     = 0x100,
+    NRF_RTC_EVENT_OVERFLOW = 0x104
+} nrf_rtc_event_t;
+
+bool nrf_rtc_event_pending(NRF_RTC_Type * p_reg, nrf_rtc_event_t event);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef NRF_SPIM_H__
+#define NRF_SPIM_H__
+
+#include <stdint.h>
+
+// Host SPIM registers, only what identifies an instance and its event and task addresses
+
+typedef struct
+{
+    uint32_t instance;
+} NRF_SPIM_Type;
+
+extern NRF_SPIM_Type host_spim[4];
+
+typedef enum
+{
+    NRF_SPIM_TASK_START     = 0x010,
+    NRF_SPIM_TASK_STOP      = 0x014
+} nrf_spim_task_t;
+
+typedef enum
+{
+    NRF_SPIM_EVENT_END      = 0x118,
+    NRF_SPIM_EVENT_STARTED  = 0x14C
+} nrf_spim_event_t;
+
+typedef enum
+{
+    NRF_SPIM_FREQ_125K  = 0x02000000,
+    NRF_SPIM_FREQ_250K  = 0x04000000,
+    NRF_SPIM_FREQ_500K  = 0x08000000,
+    NRF_SPIM_FREQ_1M    = 0x10000000,
+    NRF_SPIM_FREQ_2M    = 0x20000000,
+    NRF_SPIM_FREQ_4M    = 0x40000000,
+    NRF_SPIM_FREQ_8M    = 0x80000000
+} nrf_spim_frequency_t;
+
+typedef enum
+{
+    NRF_SPIM_MODE_0,
+    NRF_SPIM_MODE_1,
+    NRF_SPIM_MODE_2,
+    NRF_SPIM_MODE_3
+} nrf_spim_mode_t;
+
+typedef enum
+{
+    NRF_SPIM_BIT_ORDER_MSB_FIRST,
+    NRF_SPIM_BIT_ORDER_LSB_FIRST
+} nrf_spim_bit_order_t;
+
+#define NRF_SPIM_PIN_NOT_CONNECTED  0xFFFFFFFF
+
+void nrf_spim_enable(NRF_SPIM_Type * p_reg);
+void nrf_spim_disable(NRF_SPIM_Type * p_reg);
+uint32_t nrf_spim_event_address_get(NRF_SPIM_Type const * p_reg, nrf_spim_event_t spim_event);
+uint32_t nrf_spim_task_address_get(NRF_SPIM_Type const * p_reg, nrf_spim_task_t spim_task);
+
+#endif
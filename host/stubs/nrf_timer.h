@@ -0,0 +1,78 @@
+#ifndef NRF_TIMER_H__
+#define NRF_TIMER_H__
+
+#include <stdint.h>
+
+// Host TIMER registers, only what identifies an instance and its task addresses. Tasks triggered through the HAL
+// act as they do over PPI
+
+typedef struct
+{
+    uint32_t instance;
+} NRF_TIMER_Type;
+
+extern NRF_TIMER_Type host_timer[5];
+
+typedef enum
+{
+    NRF_TIMER_TASK_START    = 0x00,
+    NRF_TIMER_TASK_STOP     = 0x04,
+    NRF_TIMER_TASK_CLEAR    = 0x0C,
+    NRF_TIMER_TASK_SHUTDOWN = 0x10,
+    NRF_TIMER_TASK_CAPTURE0 = 0x40,
+    NRF_TIMER_TASK_CAPTURE1 = 0x44,
+    NRF_TIMER_TASK_CAPTURE2 = 0x48,
+    NRF_TIMER_TASK_CAPTURE3 = 0x4C
+} nrf_timer_task_t;
+
+typedef enum
+{
+    NRF_TIMER_EVENT_COMPARE0 = 0x140,
+    NRF_TIMER_EVENT_COMPARE1 = 0x144
+} nrf_timer_event_t;
+
+typedef enum
+{
+    NRF_TIMER_CC_CHANNEL0,
+    NRF_TIMER_CC_CHANNEL1,
+    NRF_TIMER_CC_CHANNEL2,
+    NRF_TIMER_CC_CHANNEL3
+} nrf_timer_cc_channel_t;
+
+typedef enum
+{
+    NRF_TIMER_MODE_TIMER,
+    NRF_TIMER_MODE_COUNTER
+} nrf_timer_mode_t;
+
+typedef enum
+{
+    NRF_TIMER_BIT_WIDTH_8,
+    NRF_TIMER_BIT_WIDTH_16,
+    NRF_TIMER_BIT_WIDTH_24,
+    NRF_TIMER_BIT_WIDTH_32
+} nrf_timer_bit_width_t;
+
+typedef enum
+{
+    NRF_TIMER_FREQ_16MHz,
+    NRF_TIMER_FREQ_8MHz,
+    NRF_TIMER_FREQ_4MHz,
+    NRF_TIMER_FREQ_2MHz,
+    NRF_TIMER_FREQ_1MHz,
+    NRF_TIMER_FREQ_500kHz,
+    NRF_TIMER_FREQ_250kHz,
+    NRF_TIMER_FREQ_125kHz,
+    NRF_TIMER_FREQ_62500Hz,
+    NRF_TIMER_FREQ_31250Hz
+} nrf_timer_frequency_t;
+
+void nrf_timer_task_trigger(NRF_TIMER_Type * p_reg, nrf_timer_task_t task);
+uint32_t nrf_timer_cc_read(NRF_TIMER_Type const * p_reg, nrf_timer_cc_channel_t cc_channel);
+
+static inline nrf_timer_task_t nrf_timer_capture_task_get(uint32_t channel)
+{
+    return (nrf_timer_task_t)(NRF_TIMER_TASK_CAPTURE0 + 4 * channel);
+}
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef NRFX_H__
+#define NRFX_H__
+
+#include "sdk_errors.h"
+
+typedef ret_code_t nrfx_err_t;
+
+#define NRFX_SUCCESS                NRF_SUCCESS
+#define NRFX_ERROR_INVALID_STATE    NRF_ERROR_INVALID_STATE
+#define NRFX_ERROR_NO_MEM           NRF_ERROR_NO_MEM
+#define NRFX_ERROR_BUSY             NRF_ERROR_BUSY
+#define NRFX_ERROR_INVALID_PARAM    NRF_ERROR_INVALID_PARAM
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef NRFX_PPI_H__
+#define NRFX_PPI_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrfx.h"
+
+// Host PPI. Events raised by the host peripherals trigger the tasks of the enabled channels assigned to them
+
+#define HOST_PPI_CHANNEL_COUNT  20
+#define HOST_PPI_GROUP_COUNT    6
+
+typedef uint8_t nrf_ppi_channel_t;
+typedef uint8_t nrf_ppi_channel_group_t;
+
+nrfx_err_t nrfx_ppi_channel_alloc(nrf_ppi_channel_t * p_channel);
+nrfx_err_t nrfx_ppi_channel_free(nrf_ppi_channel_t channel);
+nrfx_err_t nrfx_ppi_channel_assign(nrf_ppi_channel_t channel, uint32_t eep, uint32_t tep);
+nrfx_err_t nrfx_ppi_channel_fork_assign(nrf_ppi_channel_t channel, uint32_t fork_tep);
+nrfx_err_t nrfx_ppi_channel_enable(nrf_ppi_channel_t channel);
+nrfx_err_t nrfx_ppi_channel_disable(nrf_ppi_channel_t channel);
+
+nrfx_err_t nrfx_ppi_group_alloc(nrf_ppi_channel_group_t * p_group);
+nrfx_err_t nrfx_ppi_group_free(nrf_ppi_channel_group_t group);
+nrfx_err_t nrfx_ppi_channel_include_in_group(nrf_ppi_channel_t channel, nrf_ppi_channel_group_t group);
+nrfx_err_t nrfx_ppi_group_enable(nrf_ppi_channel_group_t group);
+nrfx_err_t nrfx_ppi_group_disable(nrf_ppi_channel_group_t group);
+uint32_t nrfx_ppi_task_addr_group_enable_get(nrf_ppi_channel_group_t group);
+uint32_t nrfx_ppi_task_addr_group_disable_get(nrf_ppi_channel_group_t group);
+
+#endif
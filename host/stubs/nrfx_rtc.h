@@ -0,0 +1,63 @@
+#ifndef NRFX_RTC_H__
+#define NRFX_RTC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrfx.h"
+#include "nrf_rtc.h"
+
+// Host RTC driver, counting the host clock at 32.768 kHz over the prescaler while enabled. The overflow
+// handler runs from host_nrf_advance as the 24 bit counter wraps
+
+typedef struct
+{
+    NRF_RTC_Type * p_reg;
+    uint8_t        instance_id;
+    uint8_t        cc_channel_count;
+} nrfx_rtc_t;
+
+#define NRFX_RTC_INSTANCE(id)                   \
+{                                               \
+    .p_reg            = &host_rtc[id],          \
+    .instance_id      = id,                     \
+    .cc_channel_count = 4,                      \
+}
+
+typedef struct
+{
+    uint16_t prescaler;
+    uint8_t  interrupt_priority;
+    uint8_t  tick_latency;
+    bool     reliable;
+} nrfx_rtc_config_t;
+
+#define NRFX_RTC_DEFAULT_CONFIG                 \
+{                                               \
+    .prescaler          = 0,                    \
+    .interrupt_priority = 6,                    \
+    .tick_latency       = 0,                    \
+    .reliable           = false,                \
+}
+
+typedef enum
+{
+    NRFX_RTC_INT_COMPARE0 = 0,
+    NRFX_RTC_INT_COMPARE1 = 1,
+    NRFX_RTC_INT_COMPARE2 = 2,
+    NRFX_RTC_INT_COMPARE3 = 3,
+    NRFX_RTC_INT_TICK     = 4,
+    NRFX_RTC_INT_OVERFLOW = 5
+} nrfx_rtc_int_type_t;
+
+typedef void (*nrfx_rtc_handler_t)(nrfx_rtc_int_type_t int_type);
+
+nrfx_err_t nrfx_rtc_init(nrfx_rtc_t const * p_instance, nrfx_rtc_config_t const * p_config, nrfx_rtc_handler_t handler);
+void nrfx_rtc_uninit(nrfx_rtc_t const * p_instance);
+void nrfx_rtc_enable(nrfx_rtc_t const * p_instance);
+void nrfx_rtc_disable(nrfx_rtc_t const * p_instance);
+void nrfx_rtc_overflow_enable(nrfx_rtc_t const * p_instance, bool enable_irq);
+void nrfx_rtc_counter_clear(nrfx_rtc_t const * p_instance);
+uint32_t nrfx_rtc_counter_get(nrfx_rtc_t const * p_instance);
+
+#endif
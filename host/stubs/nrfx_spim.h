@@ -0,0 +1,101 @@
+#ifndef NRFX_SPIM_H__
+#define NRFX_SPIM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "nrfx.h"
+#include "nrf_spim.h"
+
+// Host SPIM driver. A transfer clocks the bits over the SCK pin of the attached device model and samples
+// MISO on the falling edge. Transfers set up with NRFX_SPIM_FLAG_HOLD_XFER wait for the START task
+
+typedef struct
+{
+    NRF_SPIM_Type * p_reg;
+    uint8_t         drv_inst_idx;
+} nrfx_spim_t;
+
+#define NRFX_SPIM_INSTANCE(id)                  \
+{                                               \
+    .p_reg        = &host_spim[id],             \
+    .drv_inst_idx = id,                         \
+}
+
+#define NRFX_SPIM_PIN_NOT_USED      0xFF
+
+typedef struct
+{
+    uint8_t              sck_pin;
+    uint8_t              mosi_pin;
+    uint8_t              miso_pin;
+    uint8_t              ss_pin;
+    bool                 ss_active_high;
+    uint8_t              irq_priority;
+    uint8_t              orc;
+    nrf_spim_frequency_t frequency;
+    nrf_spim_mode_t      mode;
+    nrf_spim_bit_order_t bit_order;
+} nrfx_spim_config_t;
+
+#define NRFX_SPIM_DEFAULT_CONFIG                        \
+{                                                       \
+    .sck_pin        = NRFX_SPIM_PIN_NOT_USED,           \
+    .mosi_pin       = NRFX_SPIM_PIN_NOT_USED,           \
+    .miso_pin       = NRFX_SPIM_PIN_NOT_USED,           \
+    .ss_pin         = NRFX_SPIM_PIN_NOT_USED,           \
+    .ss_active_high = false,                            \
+    .irq_priority   = 6,                                \
+    .orc            = 0xFF,                             \
+    .frequency      = NRF_SPIM_FREQ_4M,                 \
+    .mode           = NRF_SPIM_MODE_0,                  \
+    .bit_order      = NRF_SPIM_BIT_ORDER_MSB_FIRST,     \
+}
+
+#define NRFX_SPIM_FLAG_TX_POSTINC           (1UL << 0)
+#define NRFX_SPIM_FLAG_RX_POSTINC           (1UL << 1)
+#define NRFX_SPIM_FLAG_NO_XFER_EVT_HANDLER  (1UL << 2)
+#define NRFX_SPIM_FLAG_HOLD_XFER            (1UL << 3)
+#define NRFX_SPIM_FLAG_REPEATED_XFER        (1UL << 4)
+
+typedef struct
+{
+    uint8_t const * p_tx_buffer;
+    size_t          tx_length;
+    uint8_t *       p_rx_buffer;
+    size_t          rx_length;
+} nrfx_spim_xfer_desc_t;
+
+#define NRFX_SPIM_XFER_TRX(p_tx_buf, tx_len, p_rx_buf, rx_len)     \
+{                                                               \
+    .p_tx_buffer = (uint8_t const *)(p_tx_buf),                 \
+    .tx_length = (tx_len),                                      \
+    .p_rx_buffer = (p_rx_buf),                                  \
+    .rx_length = (rx_len),                                      \
+}
+
+#define NRFX_SPIM_XFER_RX(p_buf, length)    NRFX_SPIM_XFER_TRX(NULL, 0, p_buf, length)
+
+typedef enum
+{
+    NRFX_SPIM_EVENT_DONE
+} nrfx_spim_evt_type_t;
+
+typedef struct
+{
+    nrfx_spim_evt_type_t  type;
+    nrfx_spim_xfer_desc_t xfer_desc;
+} nrfx_spim_evt_t;
+
+typedef void (*nrfx_spim_evt_handler_t)(nrfx_spim_evt_t const * p_event, void * p_context);
+
+nrfx_err_t nrfx_spim_init(nrfx_spim_t const * p_instance, nrfx_spim_config_t const * p_config,
+                          nrfx_spim_evt_handler_t handler, void * p_context);
+void nrfx_spim_uninit(nrfx_spim_t const * p_instance);
+nrfx_err_t nrfx_spim_xfer(nrfx_spim_t const * p_instance, nrfx_spim_xfer_desc_t const * p_xfer_desc, uint32_t flags);
+void nrfx_spim_abort(nrfx_spim_t const * p_instance);
+uint32_t nrfx_spim_start_task_get(nrfx_spim_t const * p_instance);
+uint32_t nrfx_spim_end_event_get(nrfx_spim_t const * p_instance);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef NRFX_TIMER_H__
+#define NRFX_TIMER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrfx.h"
+#include "nrf_timer.h"
+
+// Host TIMER driver, counting the host clock at the configured frequency while enabled
+
+typedef struct
+{
+    NRF_TIMER_Type * p_reg;
+    uint8_t          instance_id;
+    uint8_t          cc_channel_count;
+} nrfx_timer_t;
+
+#define NRFX_TIMER_INSTANCE(id)                 \
+{                                               \
+    .p_reg            = &host_timer[id],        \
+    .instance_id      = id,                     \
+    .cc_channel_count = 6,                      \
+}
+
+typedef struct
+{
+    nrf_timer_frequency_t frequency;
+    nrf_timer_mode_t      mode;
+    nrf_timer_bit_width_t bit_width;
+    uint8_t               interrupt_priority;
+    void *                p_context;
+} nrfx_timer_config_t;
+
+#define NRFX_TIMER_DEFAULT_CONFIG                   \
+{                                                   \
+    .frequency          = NRF_TIMER_FREQ_16MHz,     \
+    .mode               = NRF_TIMER_MODE_TIMER,     \
+    .bit_width          = NRF_TIMER_BIT_WIDTH_16,   \
+    .interrupt_priority = 6,                        \
+    .p_context          = NULL,                     \
+}
+
+typedef void (*nrfx_timer_event_handler_t)(nrf_timer_event_t event_type, void * p_context);
+
+nrfx_err_t nrfx_timer_init(nrfx_timer_t const * p_instance, nrfx_timer_config_t const * p_config,
+                           nrfx_timer_event_handler_t timer_event_handler);
+void nrfx_timer_uninit(nrfx_timer_t const * p_instance);
+void nrfx_timer_enable(nrfx_timer_t const * p_instance);
+void nrfx_timer_disable(nrfx_timer_t const * p_instance);
+bool nrfx_timer_is_enabled(nrfx_timer_t const * p_instance);
+void nrfx_timer_clear(nrfx_timer_t const * p_instance);
+uint32_t nrfx_timer_task_address_get(nrfx_timer_t const * p_instance, nrf_timer_task_t timer_task);
+uint32_t nrfx_timer_capture(nrfx_timer_t const * p_instance, nrf_timer_cc_channel_t cc_channel);
+uint32_t nrfx_timer_capture_get(nrfx_timer_t const * p_instance, nrf_timer_cc_channel_t cc_channel);
+
+#endif
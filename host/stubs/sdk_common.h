@@ -0,0 +1,31 @@
+#ifndef SDK_COMMON_H__
+#define SDK_COMMON_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "sdk_errors.h"
+#include "nordic_common.h"
+#include "app_util_platform.h"
+
+#define VERIFY_SUCCESS(statement)                       \
+    do                                                  \
+    {                                                   \
+        uint32_t _err_code = (uint32_t)(statement);     \
+        if (_err_code != NRF_SUCCESS)                   \
+        {                                               \
+            return _err_code;                           \
+        }                                               \
+    } while (0)
+
+#define VERIFY_PARAM_NOT_NULL(param)                    \
+    do                                                  \
+    {                                                   \
+        if ((param) == NULL)                            \
+        {                                               \
+            return NRF_ERROR_NULL;                      \
+        }                                               \
+    } while (0)
+
+#endif
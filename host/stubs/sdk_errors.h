@@ -0,0 +1,24 @@
+#ifndef SDK_ERRORS_H__
+#define SDK_ERRORS_H__
+
+#include <stdint.h>
+
+// Host stand-in for the nRF5 SDK error codes
+
+typedef uint32_t ret_code_t;
+
+#define NRF_ERROR_BASE_NUM          (0x0)
+
+#define NRF_SUCCESS                 (NRF_ERROR_BASE_NUM + 0)
+#define NRF_ERROR_INTERNAL          (NRF_ERROR_BASE_NUM + 3)
+#define NRF_ERROR_NO_MEM            (NRF_ERROR_BASE_NUM + 4)
+#define NRF_ERROR_NOT_FOUND         (NRF_ERROR_BASE_NUM + 5)
+#define NRF_ERROR_NOT_SUPPORTED     (NRF_ERROR_BASE_NUM + 6)
+#define NRF_ERROR_INVALID_PARAM     (NRF_ERROR_BASE_NUM + 7)
+#define NRF_ERROR_INVALID_STATE     (NRF_ERROR_BASE_NUM + 8)
+#define NRF_ERROR_INVALID_LENGTH    (NRF_ERROR_BASE_NUM + 9)
+#define NRF_ERROR_TIMEOUT           (NRF_ERROR_BASE_NUM + 13)
+#define NRF_ERROR_NULL              (NRF_ERROR_BASE_NUM + 14)
+#define NRF_ERROR_BUSY              (NRF_ERROR_BASE_NUM + 17)
+
+#endif
@@ -0,0 +1,310 @@
+#include <stdio.h>
+
+#include "host_test.h"
+#include "host_nrf.h"
+#include "ads1232_model.h"
+#include "nrf_gpio.h"
+#include "nrf_drv_gpiote.h"
+#include "Components/WeightSensor/ADS123X/ADS123X.h"
+#include "Components/WeightSensor/ADS123X/ADS123X_spim.h"
+
+// ADS123X readout against the ADS1232 model: the 24 bit framing and sign extension, the 25th pulse that ends a
+// readout and the 26th that starts an offset calibration, and the DRDY -> SPIM chain being re-armed for every
+// conversion. Covers both the SPIM/PPI readout and the bit-banged one it replaced, and the fixed point
+// conversion of the codes read to milligrams
+
+int host_test_failures = 0;
+
+#define PIN_DOUT    33
+#define PIN_SCLK    35
+#define PIN_PDWN    37
+#define PIN_GAIN0   36
+#define PIN_GAIN1   38
+#define PIN_SPEED   39
+
+#define SPIM_INSTANCE   2
+
+static const int32_t mCodes[] = { 0, 1, 0x123456, 0x7FFFFF, -1, -2, -0x123456, -0x800000, 0x555555, -0x2AAAAB };
+#define CODE_COUNT  (sizeof(mCodes) / sizeof(mCodes[0]))
+
+static ADS123X mDevice;
+static ADS123X_spim mReader;
+static ads1232_model_t mModel;
+
+static int32_t mValues[64];
+static uint32_t mValueCount;
+
+static void data_handler(int32_t value)
+{
+    if (mValueCount < sizeof(mValues) / sizeof(mValues[0]))
+    {
+        mValues[mValueCount] = value;
+    }
+    mValueCount++;
+}
+
+// Powered ADS1232 at 80 SPS on the GPIO, DOUT set up as the DRDY input the way the weight sensor does it
+static void setup_device(void)
+{
+    host_nrf_reset();
+    ads1232_model_init(&mModel, PIN_DOUT, PIN_SCLK, PIN_PDWN, PIN_SPEED);
+
+    nrf_gpio_cfg_output(PIN_SCLK);
+    nrf_gpio_cfg_output(PIN_PDWN);
+    nrf_gpio_cfg_output(PIN_GAIN0);
+    nrf_gpio_cfg_output(PIN_GAIN1);
+    nrf_gpio_cfg_output(PIN_SPEED);
+    nrf_gpio_cfg_input(PIN_DOUT, NRF_GPIO_PIN_NOPULL);
+
+    ADS123X_Init(&mDevice, PIN_DOUT, PIN_SCLK, PIN_PDWN, PIN_GAIN0, PIN_GAIN1, PIN_SPEED);
+    ADS123X_setGain(&mDevice, GAIN_128);
+    ADS123X_setSpeed(&mDevice, SPEED_80SPS);
+    ADS123X_PowerOn(&mDevice);
+
+    mValueCount = 0;
+}
+
+static void setup_spim(void)
+{
+    setup_device();
+
+    nrf_drv_gpiote_in_config_t in_config = NRFX_GPIOTE_CONFIG_IN_SENSE_HITOLO(true);
+
+    HOST_TEST_CHECK_EQUAL(NRF_SUCCESS, nrf_drv_gpiote_init());
+    HOST_TEST_CHECK_EQUAL(NRF_SUCCESS, nrf_drv_gpiote_in_init(PIN_DOUT, &in_config, NULL));
+    HOST_TEST_CHECK_EQUAL(NRF_SUCCESS, ADS123X_spim_init(&mReader, &mDevice,
+                                                         (nrfx_spim_t)NRFX_SPIM_INSTANCE(SPIM_INSTANCE), data_handler));
+    HOST_TEST_CHECK_EQUAL(NRF_SUCCESS, ADS123X_spim_enable(&mReader));
+    nrf_drv_gpiote_in_event_enable(PIN_DOUT, false);
+}
+
+static void test_sign_extend(void)
+{
+    HOST_TEST_CHECK_EQUAL(0, ADS123X_signExtend(0x000000));
+    HOST_TEST_CHECK_EQUAL(0x7FFFFF, ADS123X_signExtend(0x7FFFFF));
+    HOST_TEST_CHECK_EQUAL(-0x800000, ADS123X_signExtend(0x800000));
+    HOST_TEST_CHECK_EQUAL(-1, ADS123X_signExtend(0xFFFFFF));
+    HOST_TEST_CHECK_EQUAL(-0x123456, ADS123X_signExtend(0x1000000 - 0x123456));
+}
+
+#define MILLIGRAMS_Q(mg)    ((double)(mg) * (1 << ADS123X_MILLIGRAM_FRACTIONAL_BITS))
+
+static void test_convert_to_milligrams(void)
+{
+    setup_device();
+
+    int32_t milligramsQ;
+
+    HOST_TEST_CHECK_EQUAL(DIVIDED_by_ZERO, ADS123X_convertToMilligrams(&mDevice, 0, &milligramsQ));
+
+    // 2.5 mg per code, a 20 kg load cell
+    ADS123X_setScaleFactor(&mDevice, 400.0f);
+    ADS123X_setOffset(&mDevice, 12000.0f);
+
+    HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_convertToMilligrams(&mDevice, 12000 + 400, &milligramsQ));
+    HOST_TEST_CHECK_NEAR(MILLIGRAMS_Q(1000), milligramsQ, 1);
+
+    // Past the 8.4 kg that overflowed int32 with 8 fractional bits
+    HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_convertToMilligrams(&mDevice, 12000 + 400 * 9500, &milligramsQ));
+    HOST_TEST_CHECK_NEAR(MILLIGRAMS_Q(9500000), milligramsQ, 1);
+
+    HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_convertToMilligrams(&mDevice, 12000 - 400 * 9500, &milligramsQ));
+    HOST_TEST_CHECK_NEAR(MILLIGRAMS_Q(-9500000), milligramsQ, 1);
+
+    // Overloads saturate at the range rather than wrap, right up to full scale
+    HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_convertToMilligrams(&mDevice, 12000 + 400 * 15000, &milligramsQ));
+    HOST_TEST_CHECK_NEAR(MILLIGRAMS_Q(ADS123X_MILLIGRAMS_MAX), milligramsQ, MILLIGRAMS_Q(0.01));
+
+    HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_convertToMilligrams(&mDevice, 0x7FFFFF, &milligramsQ));
+    HOST_TEST_CHECK_NEAR(MILLIGRAMS_Q(ADS123X_MILLIGRAMS_MAX), milligramsQ, MILLIGRAMS_Q(0.01));
+
+    HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_convertToMilligrams(&mDevice, -0x800000, &milligramsQ));
+    HOST_TEST_CHECK_NEAR(MILLIGRAMS_Q(-ADS123X_MILLIGRAMS_MAX), milligramsQ, MILLIGRAMS_Q(0.01));
+
+    // Zero tracking moves the offset by fractions of a code, they carry through to the weight
+    ADS123X_setOffset(&mDevice, 12000.25f);
+
+    HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_convertToMilligrams(&mDevice, 12000, &milligramsQ));
+    HOST_TEST_CHECK_NEAR(MILLIGRAMS_Q(-0.625), milligramsQ, 1);
+
+    ADS123X_setOffset(&mDevice, 11999.9f);
+
+    HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_convertToMilligrams(&mDevice, 12000, &milligramsQ));
+    HOST_TEST_CHECK_NEAR(MILLIGRAMS_Q(0.25), milligramsQ, 1);
+
+    // Offsets far enough out that a float can't hold the quarter code, set in fixed point it still gets through
+    int64_t offsetCode = ((int64_t)2000000 << ADS123X_OFFSET_FRACTIONAL_BITS) + 64;
+
+    ADS123X_setOffsetCode(&mDevice, offsetCode);
+    HOST_TEST_CHECK(ADS123X_getOffsetCode(&mDevice) == offsetCode);
+
+    HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_convertToMilligrams(&mDevice, 2000000, &milligramsQ));
+    HOST_TEST_CHECK_NEAR(MILLIGRAMS_Q(-0.625), milligramsQ, 1);
+}
+
+static void test_spim_framing(void)
+{
+    setup_spim();
+
+    for (uint32_t i = 0; i < CODE_COUNT; i++)
+    {
+        ads1232_model_convert(&mModel, mCodes[i]);
+
+        HOST_TEST_CHECK_EQUAL(i + 1, mValueCount);
+        HOST_TEST_CHECK_EQUAL(mCodes[i], mValues[i]);
+
+        // 24 data bits and the 25th that forces DOUT back high until the next conversion
+        HOST_TEST_CHECK_EQUAL(25, mModel.pulses);
+        HOST_TEST_CHECK_EQUAL(1, nrf_gpio_pin_read(PIN_DOUT));
+    }
+
+    HOST_TEST_CHECK_EQUAL(CODE_COUNT, mModel.reads);
+    HOST_TEST_CHECK_EQUAL(0, mModel.framingErrors);
+    HOST_TEST_CHECK_EQUAL(0, mModel.calibrations);
+}
+
+static void test_spim_clamps_to_the_converter_range(void)
+{
+    setup_spim();
+
+    ads1232_model_convert(&mModel, 0x7FFFFF + 1000);
+    ads1232_model_convert(&mModel, -0x800000 - 1000);
+
+    HOST_TEST_CHECK_EQUAL(2, mValueCount);
+    HOST_TEST_CHECK_EQUAL(0x7FFFFF, mValues[0]);
+    HOST_TEST_CHECK_EQUAL(-0x800000, mValues[1]);
+}
+
+static void test_spim_calibration_pulse(void)
+{
+    setup_spim();
+
+    ads1232_model_convert(&mModel, 1000);
+    HOST_TEST_CHECK_EQUAL(25, mModel.pulses);
+
+    ADS123X_calibrateOnNextConversion(&mDevice);
+    ads1232_model_convert(&mModel, 2000);
+
+    HOST_TEST_CHECK_EQUAL(2000, mValues[1]);
+    HOST_TEST_CHECK_EQUAL(26, mModel.pulses);
+    HOST_TEST_CHECK_EQUAL(1, mModel.calibrations);
+    HOST_TEST_CHECK(!mDevice.calibrateOnNextConversion);
+
+    // Only the one conversion is followed by the calibration pulse
+    ads1232_model_convert(&mModel, 3000);
+
+    HOST_TEST_CHECK_EQUAL(3000, mValues[2]);
+    HOST_TEST_CHECK_EQUAL(25, mModel.pulses);
+    HOST_TEST_CHECK_EQUAL(1, mModel.calibrations);
+    HOST_TEST_CHECK_EQUAL(0, mModel.framingErrors);
+}
+
+static void test_spim_rearms_for_every_conversion(void)
+{
+    setup_spim();
+
+    const uint32_t conversions = 1000;
+
+    for (uint32_t i = 0; i < conversions; i++)
+    {
+        host_nrf_advance(12500);
+        ads1232_model_convert(&mModel, (int32_t)(i * 4099) - 0x200000);
+    }
+
+    HOST_TEST_CHECK_EQUAL(conversions, mValueCount);
+    HOST_TEST_CHECK_EQUAL(conversions, mModel.reads);
+    HOST_TEST_CHECK_EQUAL(0, mModel.missed);
+    HOST_TEST_CHECK_EQUAL(0, mModel.framingErrors);
+
+    // One transfer per DRDY, none started by the data bits on DOUT and none started before being set up
+    HOST_TEST_CHECK_EQUAL(conversions, host_spim_transfer_count(SPIM_INSTANCE));
+    HOST_TEST_CHECK_EQUAL(0, host_spim_unarmed_start_count(SPIM_INSTANCE));
+}
+
+static void test_spim_disable_stops_the_readout(void)
+{
+    setup_spim();
+
+    ads1232_model_convert(&mModel, 42);
+    HOST_TEST_CHECK_EQUAL(1, mValueCount);
+
+    ADS123X_spim_disable(&mReader);
+    ads1232_model_convert(&mModel, 43);
+
+    HOST_TEST_CHECK_EQUAL(1, mValueCount);
+    HOST_TEST_CHECK_EQUAL(1, host_spim_transfer_count(SPIM_INSTANCE));
+    HOST_TEST_CHECK_EQUAL(0, host_spim_unarmed_start_count(SPIM_INSTANCE));
+
+    // Enabled again it picks up the next conversion
+    HOST_TEST_CHECK_EQUAL(NRF_SUCCESS, ADS123X_spim_enable(&mReader));
+    ads1232_model_convert(&mModel, 44);
+
+    HOST_TEST_CHECK_EQUAL(2, mValueCount);
+    HOST_TEST_CHECK_EQUAL(44, mValues[1]);
+    HOST_TEST_CHECK_EQUAL(0, mModel.framingErrors);
+}
+
+static void test_bitbang_framing(void)
+{
+    setup_device();
+
+    int32_t value;
+
+    HOST_TEST_CHECK_EQUAL(SENSOR_NOT_READY, ADS123X_read(&mDevice, &value));
+
+    for (uint32_t i = 0; i < CODE_COUNT; i++)
+    {
+        ads1232_model_convert(&mModel, mCodes[i]);
+
+        HOST_TEST_CHECK(ADS123X_IsReady(&mDevice));
+        HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_read(&mDevice, &value));
+        HOST_TEST_CHECK_EQUAL(mCodes[i], value);
+        HOST_TEST_CHECK_EQUAL(25, mModel.pulses);
+        HOST_TEST_CHECK(!ADS123X_IsReady(&mDevice));
+    }
+
+    ADS123X_calibrateOnNextConversion(&mDevice);
+    ads1232_model_convert(&mModel, -5);
+
+    HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_read(&mDevice, &value));
+    HOST_TEST_CHECK_EQUAL(-5, value);
+    HOST_TEST_CHECK_EQUAL(26, mModel.pulses);
+    HOST_TEST_CHECK_EQUAL(1, mModel.calibrations);
+    HOST_TEST_CHECK_EQUAL(0, mModel.framingErrors);
+}
+
+static void test_power_down_resets_the_interface(void)
+{
+    setup_device();
+
+    ads1232_model_convert(&mModel, 100);
+    ADS123X_PowerOff(&mDevice);
+
+    HOST_TEST_CHECK(!ads1232_model_powered(&mModel));
+    HOST_TEST_CHECK(!ADS123X_IsReady(&mDevice));
+    HOST_TEST_CHECK(!ads1232_model_convert(&mModel, 200));
+
+    ADS123X_PowerOn(&mDevice);
+    ads1232_model_convert(&mModel, 300);
+
+    int32_t value;
+
+    HOST_TEST_CHECK_EQUAL(NoERROR, ADS123X_read(&mDevice, &value));
+    HOST_TEST_CHECK_EQUAL(300, value);
+    HOST_TEST_CHECK_EQUAL(0, mModel.framingErrors);
+}
+
+int main(void)
+{
+    HOST_TEST_RUN(test_sign_extend);
+    HOST_TEST_RUN(test_convert_to_milligrams);
+    HOST_TEST_RUN(test_spim_framing);
+    HOST_TEST_RUN(test_spim_clamps_to_the_converter_range);
+    HOST_TEST_RUN(test_spim_calibration_pulse);
+    HOST_TEST_RUN(test_spim_rearms_for_every_conversion);
+    HOST_TEST_RUN(test_spim_disable_stops_the_readout);
+    HOST_TEST_RUN(test_bitbang_framing);
+    HOST_TEST_RUN(test_power_down_resets_the_interface);
+
+    return host_test_result();
+}
@@ -0,0 +1,176 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_test.h"
+#include "libraries/biquad/biquad.h"
+
+// filter_process_block and filter_process_block_reference against filter_process on every sample: the output
+// and the state left behind must match bit for bit, over any split of the input into blocks and in place.
+// Prints the host time per sample of each
+
+int host_test_failures = 0;
+
+#define SAMPLE_RATE     80.0f
+#define SECTIONS        3       // 4th order weight filter and the vibration notch
+#define SAMPLE_COUNT    4096
+#define TIMING_PASSES   200
+
+static float mInput[SAMPLE_COUNT];
+static float mExpected[SAMPLE_COUNT];
+static float mOutput[SAMPLE_COUNT];
+
+static void design(Biquad *filt)
+{
+    biquad_design_butterworth_lowpass(filt, 2, 4, 6.0f, SAMPLE_RATE);
+    biquad_design_notch(&filt[2], 25.0f, 2.0f, SAMPLE_RATE);
+}
+
+// A 100 g step with noise and vibration on it, repeatable from run to run
+static void make_input(void)
+{
+    uint32_t seed = 12345;
+
+    for (int n = 0; n < SAMPLE_COUNT; n++)
+    {
+        seed = seed * 1664525U + 1013904223U;
+        float noise = ((float)(seed >> 8) / (float)(1U << 24) - 0.5f) * 0.1f;
+
+        mInput[n] = (n >= 40 ? 100.0f : 0.0f) + 0.3f * sinf(2.0f * (float)M_PI * 25.0f * n / SAMPLE_RATE) + noise;
+    }
+}
+
+static void expected_output(Biquad *state)
+{
+    design(state);
+
+    for (int n = 0; n < SAMPLE_COUNT; n++)
+    {
+        mExpected[n] = filter_process(state, SECTIONS, mInput[n]);
+    }
+}
+
+static uint64_t clock_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void test_block_matches_per_sample(void)
+{
+    static const int blockSizes[] = { 1, 2, 3, 4, 5, 7, 8, 16, 63, 64, SAMPLE_COUNT };
+    Biquad expectedState[SECTIONS];
+
+    expected_output(expectedState);
+
+    // The filters really are filtering, the step has come through at 100 g with the vibration notched out
+    HOST_TEST_CHECK_NEAR(100.0, mExpected[SAMPLE_COUNT - 1], 0.1);
+
+    for (size_t i = 0; i < sizeof(blockSizes) / sizeof(blockSizes[0]); i++)
+    {
+        for (int inPlace = 0; inPlace <= 1; inPlace++)
+        {
+            Biquad block[SECTIONS];
+            Biquad reference[SECTIONS];
+            static float referenceOutput[SAMPLE_COUNT];
+
+            design(block);
+            design(reference);
+
+            if (inPlace)
+            {
+                memcpy(mOutput, mInput, sizeof(mOutput));
+                memcpy(referenceOutput, mInput, sizeof(referenceOutput));
+            }
+
+            for (int n = 0; n < SAMPLE_COUNT; n += blockSizes[i])
+            {
+                int count = SAMPLE_COUNT - n < blockSizes[i] ? SAMPLE_COUNT - n : blockSizes[i];
+
+                filter_process_block(block, SECTIONS, inPlace ? &mOutput[n] : &mInput[n], &mOutput[n], count);
+                filter_process_block_reference(reference, SECTIONS, inPlace ? &referenceOutput[n] : &mInput[n],
+                                               &referenceOutput[n], count);
+            }
+
+            if (memcmp(mOutput, mExpected, sizeof(mOutput)) != 0 ||
+                memcmp(block, expectedState, sizeof(block)) != 0)
+            {
+                fprintf(stderr, "filter_process_block differs in blocks of %d%s\n", blockSizes[i], inPlace ? " in place" : "");
+                host_test_failures++;
+            }
+
+            if (memcmp(referenceOutput, mExpected, sizeof(referenceOutput)) != 0 ||
+                memcmp(reference, expectedState, sizeof(reference)) != 0)
+            {
+                fprintf(stderr, "filter_process_block_reference differs in blocks of %d%s\n", blockSizes[i],
+                        inPlace ? " in place" : "");
+                host_test_failures++;
+            }
+        }
+    }
+}
+
+static void test_no_sections_copies(void)
+{
+    Biquad none[1];
+
+    filter_process_block(none, 0, mInput, mOutput, SAMPLE_COUNT);
+
+    HOST_TEST_CHECK(memcmp(mInput, mOutput, sizeof(mOutput)) == 0);
+}
+
+static void test_time_per_sample(void)
+{
+    Biquad filt[SECTIONS];
+    volatile float sink;    // keeps the passes from being optimised away
+    uint64_t start;
+
+    design(filt);
+    start = clock_ns();
+    for (int pass = 0; pass < TIMING_PASSES; pass++)
+    {
+        for (int n = 0; n < SAMPLE_COUNT; n++)
+        {
+            mOutput[n] = filter_process(filt, SECTIONS, mInput[n]);
+        }
+        sink = mOutput[SAMPLE_COUNT - 1];
+    }
+    double perSampleNs = (double)(clock_ns() - start) / ((double)TIMING_PASSES * SAMPLE_COUNT);
+
+    design(filt);
+    start = clock_ns();
+    for (int pass = 0; pass < TIMING_PASSES; pass++)
+    {
+        filter_process_block_reference(filt, SECTIONS, mInput, mOutput, SAMPLE_COUNT);
+        sink = mOutput[SAMPLE_COUNT - 1];
+    }
+    double referenceNs = (double)(clock_ns() - start) / ((double)TIMING_PASSES * SAMPLE_COUNT);
+
+    design(filt);
+    start = clock_ns();
+    for (int pass = 0; pass < TIMING_PASSES; pass++)
+    {
+        filter_process_block(filt, SECTIONS, mInput, mOutput, SAMPLE_COUNT);
+        sink = mOutput[SAMPLE_COUNT - 1];
+    }
+    double blockNs = (double)(clock_ns() - start) / ((double)TIMING_PASSES * SAMPLE_COUNT);
+
+    printf("%d sections: filter_process %.2f ns per sample, filter_process_block_reference %.2f, "
+           "filter_process_block %.2f\n", SECTIONS, perSampleNs, referenceNs, blockNs);
+    (void)sink;
+}
+
+int main(void)
+{
+    make_input();
+
+    HOST_TEST_RUN(test_block_matches_per_sample);
+    HOST_TEST_RUN(test_no_sections_copies);
+    HOST_TEST_RUN(test_time_per_sample);
+
+    return host_test_result();
+}
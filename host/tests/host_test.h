@@ -0,0 +1,62 @@
+#ifndef HOST_TEST_h
+#define HOST_TEST_h
+
+#include <stdio.h>
+
+// Minimal checks for the host tests. A failed check is reported and counted, the test carries on so one run
+// shows every failure, and main returns host_test_result().
+// Each test defines host_test_failures
+
+extern int host_test_failures;
+
+#define HOST_TEST_CHECK(condition)                                                  \
+    do                                                                              \
+    {                                                                               \
+        if (!(condition))                                                           \
+        {                                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            host_test_failures++;                                                   \
+        }                                                                           \
+    } while (0)
+
+#define HOST_TEST_CHECK_EQUAL(expected, actual)                                     \
+    do                                                                              \
+    {                                                                               \
+        long long host_test_expected = (long long)(expected);                      \
+        long long host_test_actual = (long long)(actual);                          \
+        if (host_test_expected != host_test_actual)                                 \
+        {                                                                           \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, \
+                    #actual, host_test_actual, host_test_expected);                 \
+            host_test_failures++;                                                   \
+        }                                                                           \
+    } while (0)
+
+#define HOST_TEST_CHECK_NEAR(expected, actual, tolerance)                           \
+    do                                                                              \
+    {                                                                               \
+        double host_test_expected = (double)(expected);                             \
+        double host_test_actual = (double)(actual);                                 \
+        if (!(host_test_actual >= host_test_expected - (tolerance) &&               \
+              host_test_actual <= host_test_expected + (tolerance)))                \
+        {                                                                           \
+            fprintf(stderr, "%s:%d: %s is %g, expected %g within %g\n", __FILE__, __LINE__, \
+                    #actual, host_test_actual, host_test_expected, (double)(tolerance)); \
+            host_test_failures++;                                                   \
+        }                                                                           \
+    } while (0)
+
+#define HOST_TEST_RUN(test)                                                         \
+    do                                                                              \
+    {                                                                               \
+        int host_test_before = host_test_failures;                                  \
+        test();                                                                     \
+        printf("%s %s\n", host_test_failures == host_test_before ? "ok  " : "FAIL", #test); \
+    } while (0)
+
+static inline int host_test_result(void)
+{
+    return host_test_failures == 0 ? 0 : 1;
+}
+
+#endif
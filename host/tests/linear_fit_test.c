@@ -0,0 +1,160 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "host_test.h"
+#include "libraries/biquad/biquad.h"
+#include "libraries/linear_fit/linear_fit.h"
+
+// Least squares flow against the difference estimator it can replace, on a ramp with known slope and noise.
+// Both are fed the weight filter output the way the weight sensor feeds them: the fit over
+// WEIGHT_SENSOR_FLOW_FIT_WINDOW, the difference of consecutive filtered weights through the flow filter
+
+int host_test_failures = 0;
+
+#define SAMPLE_RATE         80.0f
+#define PERIOD_US           12500U
+#define FIT_WINDOW          0.5f        // s, WEIGHT_SENSOR_FLOW_FIT_WINDOW
+#define WEIGHT_CUTOFF       6.0f        // Hz, the default weight filter
+#define FLOW_CUTOFF         3.0f        // Hz, half the weight filter cutoff
+#define FILTER_SECTIONS     2
+
+#define RAMP_SLOPE          5.0f        // g/s
+#define NOISE_RMS           0.05f       // g
+#define RAMP_SECONDS        30.0f
+#define SETTLE_SECONDS      2.0f        // left out of the error, both estimators start from 0
+
+// Gaussian noise of unit variance, repeatable from run to run
+static uint32_t mSeed;
+
+static float uniform(void)
+{
+    mSeed = mSeed * 1664525U + 1013904223U;
+    return ((float)(mSeed >> 8) + 0.5f) / (float)(1U << 24);
+}
+
+static float gaussian(void)
+{
+    return sqrtf(-2.0f * logf(uniform())) * cosf(2.0f * (float)M_PI * uniform());
+}
+
+typedef struct
+{
+    double error_squares;
+    double error_sum;
+    uint32_t count;
+} slope_error_t;
+
+static void slope_error_add(slope_error_t *error, float estimate)
+{
+    error->error_squares += (double)(estimate - RAMP_SLOPE) * (estimate - RAMP_SLOPE);
+    error->error_sum += estimate - RAMP_SLOPE;
+    error->count++;
+}
+
+static float slope_error_rms(const slope_error_t *error)
+{
+    return (float)sqrt(error->error_squares / error->count);
+}
+
+static float slope_error_bias(const slope_error_t *error)
+{
+    return (float)(error->error_sum / error->count);
+}
+
+static void test_exact_on_a_clean_ramp(void)
+{
+    LinearFitWindow fit;
+
+    HOST_TEST_CHECK(linear_fit_window_init(&fit, FIT_WINDOW));
+    HOST_TEST_CHECK_EQUAL(0, linear_fit_window_slope(&fit));
+
+    // Starts just short of the timestamp wrap, the fit carries on through it
+    uint32_t timestamp = UINT32_MAX - 2000000U;
+
+    for (int n = 0; n < 1000; n++)
+    {
+        linear_fit_window_add(&fit, timestamp, 250.0f + RAMP_SLOPE * n / SAMPLE_RATE);
+        timestamp += PERIOD_US;
+
+        if (n >= 1)
+        {
+            HOST_TEST_CHECK_NEAR(RAMP_SLOPE, linear_fit_window_slope(&fit), 1e-3);
+        }
+    }
+
+    HOST_TEST_CHECK_NEAR(1.0, linear_fit_window_r_squared(&fit), 1e-4);
+    HOST_TEST_CHECK(fit.count <= (uint16_t)(FIT_WINDOW * SAMPLE_RATE) + 1);
+}
+
+static void test_fit_against_difference_on_a_noisy_ramp(void)
+{
+    Biquad weightFilter[FILTER_SECTIONS];
+    Biquad flowFilter[FILTER_SECTIONS];
+    LinearFitWindow fit;
+
+    biquad_design_butterworth_lowpass(weightFilter, FILTER_SECTIONS, 4, WEIGHT_CUTOFF, SAMPLE_RATE);
+    biquad_design_butterworth_lowpass(flowFilter, FILTER_SECTIONS, 4, FLOW_CUTOFF, SAMPLE_RATE);
+    linear_fit_window_init(&fit, FIT_WINDOW);
+
+    slope_error_t fitError = { 0 };
+    slope_error_t differenceError = { 0 };
+    float previousFiltered = 0.0f;
+    uint32_t timestamp = 0;
+
+    mSeed = 2024;
+
+    int samples = (int)(RAMP_SECONDS * SAMPLE_RATE);
+
+    for (int n = 0; n < samples; n++)
+    {
+        float grams = RAMP_SLOPE * n / SAMPLE_RATE + NOISE_RMS * gaussian();
+        float filtered = filter_process(weightFilter, FILTER_SECTIONS, grams);
+
+        linear_fit_window_add(&fit, timestamp, filtered);
+        float fitSlope = linear_fit_window_slope(&fit);
+
+        float difference = n > 0 ? (filtered - previousFiltered) * SAMPLE_RATE : 0.0f;
+        float differenceSlope = filter_process(flowFilter, FILTER_SECTIONS, difference);
+
+        previousFiltered = filtered;
+        timestamp += PERIOD_US;
+
+        if (n >= (int)(SETTLE_SECONDS * SAMPLE_RATE))
+        {
+            slope_error_add(&fitError, fitSlope);
+            slope_error_add(&differenceError, differenceSlope);
+        }
+    }
+
+    printf("%.0f g/s ramp with %.2f g RMS noise: least squares %.3f g/s RMS error (bias %.4f), "
+           "difference and flow filter %.3f g/s RMS error (bias %.4f)\n",
+           RAMP_SLOPE, NOISE_RMS, slope_error_rms(&fitError), slope_error_bias(&fitError),
+           slope_error_rms(&differenceError), slope_error_bias(&differenceError));
+
+    // Both track the slope without bias
+    HOST_TEST_CHECK_NEAR(0.0, slope_error_bias(&fitError), 0.02);
+    HOST_TEST_CHECK_NEAR(0.0, slope_error_bias(&differenceError), 0.02);
+
+    // The fit averages over a longer span than the flow filter, it must be the quieter of the two
+    HOST_TEST_CHECK(slope_error_rms(&fitError) < 0.5f * slope_error_rms(&differenceError));
+
+    // The slope of a least squares line through N evenly spaced samples of white noise has a standard deviation
+    // of sigma * sqrt(12 / (N (N^2 - 1))) / T. With the noise above the weight filter cutoff already gone the fit
+    // does at least as well as on the raw samples
+    float windowSamples = FIT_WINDOW * SAMPLE_RATE;
+    float whiteNoiseSlopeRms = NOISE_RMS * SAMPLE_RATE *
+                               sqrtf(12.0f / (windowSamples * (windowSamples * windowSamples - 1.0f)));
+
+    printf("least squares on the raw samples would be %.3f g/s RMS\n", whiteNoiseSlopeRms);
+
+    HOST_TEST_CHECK(slope_error_rms(&fitError) < whiteNoiseSlopeRms);
+}
+
+int main(void)
+{
+    HOST_TEST_RUN(test_exact_on_a_clean_ramp);
+    HOST_TEST_RUN(test_fit_against_difference_on_a_noisy_ramp);
+
+    return host_test_result();
+}
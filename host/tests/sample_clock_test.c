@@ -0,0 +1,141 @@
+#include <stdio.h>
+
+#include "host_test.h"
+#include "host_nrf.h"
+#include "Components/WeightSensor/SampleClock/sample_clock.h"
+
+// Sample clock on the RTC with the TIMER only run for the readout: conversion timestamps taken back to the
+// capture event whatever the interrupt latency, the TIMER (and so the high frequency clock) stopped between
+// conversions, and the time carried on across the wrap of the 24 bit RTC counter
+
+int host_test_failures = 0;
+
+#define CAPTURE_EVENT       HOST_GPIOTE_IN_EVENT(33)
+
+// One RTC tick is 1 / 32768 s, timestamps are the RTC time rounded down to a whole tick
+#define RTC_TICK_US         (1000000.0 / 32768.0)
+
+#define CONVERSION_US       12500   // 80 SPS
+
+static void setup_clock(void)
+{
+    // Left running by the test before
+    sample_clock_stop();
+
+    host_nrf_reset();
+    HOST_TEST_CHECK_EQUAL(NRF_SUCCESS, sample_clock_init(CAPTURE_EVENT));
+    sample_clock_start();
+}
+
+// Conversion readout started by the capture event, its interrupt running latencyUs later
+static uint32_t convert(uint32_t latencyUs)
+{
+    host_event_raise(CAPTURE_EVENT);
+    host_nrf_advance(latencyUs);
+    return sample_clock_get_capture();
+}
+
+static void test_capture_ignores_interrupt_latency(void)
+{
+    setup_clock();
+
+    static const uint32_t latencies[] = { 0, 15, 31, 100, 250, 999, 2000, 5000 };
+    uint64_t eventUs = 0;
+
+    for (uint32_t i = 0; i < 400; i++)
+    {
+        uint32_t latencyUs = latencies[i % (sizeof(latencies) / sizeof(latencies[0]))];
+
+        host_nrf_advance(CONVERSION_US + (i % 7) - latencyUs % 11);
+        eventUs = host_nrf_time_us();
+
+        uint32_t captured = convert(latencyUs);
+
+        HOST_TEST_CHECK(captured <= eventUs);
+        HOST_TEST_CHECK_NEAR((double)eventUs, captured, RTC_TICK_US + 1.0);
+
+        host_nrf_advance(CONVERSION_US - latencyUs);
+    }
+}
+
+static void test_timer_only_runs_for_the_readout(void)
+{
+    setup_clock();
+
+    const uint32_t latencyUs = 60;
+    const uint32_t conversions = 800;   // 10 s
+
+    for (uint32_t i = 0; i < conversions; i++)
+    {
+        host_nrf_advance(CONVERSION_US - latencyUs);
+        (void)convert(latencyUs);
+    }
+
+    uint64_t runningUs = host_timer_running_us(SAMPLE_CLOCK_TIMER_INSTANCE);
+    printf("TIMER%d ran %llu us of %llu us (%.2f%%)\n", SAMPLE_CLOCK_TIMER_INSTANCE,
+           (unsigned long long)runningUs, (unsigned long long)host_nrf_time_us(),
+           100.0 * runningUs / host_nrf_time_us());
+
+    HOST_TEST_CHECK_EQUAL((uint64_t)conversions * latencyUs, runningUs);
+
+    // Idle between conversions and once stopped, nothing keeps it running
+    host_nrf_advance(1000000);
+    HOST_TEST_CHECK_EQUAL((uint64_t)conversions * latencyUs, host_timer_running_us(SAMPLE_CLOCK_TIMER_INSTANCE));
+
+    host_event_raise(CAPTURE_EVENT);
+    sample_clock_stop();
+    host_nrf_advance(1000000);
+    HOST_TEST_CHECK_EQUAL((uint64_t)conversions * latencyUs, host_timer_running_us(SAMPLE_CLOCK_TIMER_INSTANCE));
+
+    // A capture event while stopped doesn't start it
+    host_event_raise(CAPTURE_EVENT);
+    host_nrf_advance(1000000);
+    HOST_TEST_CHECK_EQUAL((uint64_t)conversions * latencyUs, host_timer_running_us(SAMPLE_CLOCK_TIMER_INSTANCE));
+}
+
+static void test_now_carries_on_across_the_rtc_wrap(void)
+{
+    setup_clock();
+
+    // 2^24 ticks at 32768 Hz
+    const uint64_t wrapUs = 512000000ULL;
+
+    host_nrf_advance(wrapUs - 50000);
+
+    uint32_t last = sample_clock_now();
+
+    while (host_nrf_time_us() < wrapUs + 50000)
+    {
+        host_nrf_advance(997);
+
+        uint32_t now = sample_clock_now();
+
+        HOST_TEST_CHECK(now > last);
+        HOST_TEST_CHECK_NEAR((double)host_nrf_time_us(), now, RTC_TICK_US + 1.0);
+        last = now;
+    }
+
+    // Timestamps wrap at 2^32 us, the differences the filters use carry on through it
+    host_nrf_advance(0x100000000ULL - host_nrf_time_us() - 5000);
+
+    uint32_t before = sample_clock_now();
+    host_nrf_advance(10000);
+    uint32_t after = sample_clock_now();
+
+    HOST_TEST_CHECK_NEAR(10000.0, (double)(uint32_t)(after - before), RTC_TICK_US + 1.0);
+
+    // Started again the clock counts from 0
+    sample_clock_stop();
+    host_nrf_advance(1000000);
+    sample_clock_start();
+    HOST_TEST_CHECK(sample_clock_now() < RTC_TICK_US);
+}
+
+int main(void)
+{
+    HOST_TEST_RUN(test_capture_ignores_interrupt_latency);
+    HOST_TEST_RUN(test_timer_only_runs_for_the_readout);
+    HOST_TEST_RUN(test_now_carries_on_across_the_rtc_wrap);
+
+    return host_test_result();
+}
@@ -0,0 +1,198 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "replay_harness.h"
+#include "trace_replay.h"
+#include "Components/Brew/shot_timer.h"
+#include "Components/WeightSensor/SampleClock/sample_clock.h"
+#include "Components/WeightSensor/WeightSensor.h"
+
+// Espresso shot timer on the weight sensor output, replaying the recorded shot through the firmware pipeline.
+// For the start and the stop it measures against the noise free trace:
+//  - latency: from the weight crossing the threshold to the conversion whose filtered weight fires the event,
+//    which has to be inside SHOT_TIMER_MAX_LATENCY_MS
+//  - error: of the interpolated, delay corrected event time the shot is timed from
+// The trace file is the first argument
+
+int host_test_failures = 0;
+
+#define TRACE_NOISE         0.02f   // g RMS
+#define MAX_TIME_ERROR_MS   25.0f
+
+static trace_replay_point_t mPoints[TRACE_REPLAY_MAX_POINTS];
+static uint32_t mPointCount;
+
+// Crossing times of the trace and what the shot timer made of them, in sample clock ticks
+typedef struct
+{
+    float threshold;
+    bool crossed;
+    uint32_t crossing;
+    bool fired;
+    uint32_t detected;      // timestamp of the conversion that fired the event
+    uint32_t event_time;
+} shot_timer_edge_t;
+
+typedef struct
+{
+    shot_timer_t timer;
+    shot_timer_edge_t start;
+    shot_timer_edge_t stop;
+
+    bool previous_valid;
+    float previous_trace_grams;
+    uint32_t previous_timestamp;
+} shot_replay_t;
+
+static void edge_track(shot_timer_edge_t *edge, const shot_replay_t *replay, const replay_harness_sample_t *sample)
+{
+    if (edge->crossed || !replay->previous_valid ||
+        !(replay->previous_trace_grams < edge->threshold && sample->trace_grams >= edge->threshold))
+    {
+        return;
+    }
+
+    float fraction = (edge->threshold - replay->previous_trace_grams) / (sample->trace_grams - replay->previous_trace_grams);
+
+    edge->crossing = replay->previous_timestamp + (uint32_t)(fraction * (float)(sample->timestamp - replay->previous_timestamp));
+    edge->crossed = true;
+}
+
+static void edge_fired(shot_timer_edge_t *edge, const shot_replay_t *replay, const replay_harness_sample_t *sample)
+{
+    edge->fired = true;
+    edge->detected = sample->timestamp;
+    edge->event_time = replay->timer.event_time;
+}
+
+static void shot_replay_observe(void *context, const replay_harness_sample_t *sample)
+{
+    shot_replay_t *replay = context;
+
+    edge_track(&replay->start, replay, sample);
+    edge_track(&replay->stop, replay, sample);
+
+    switch (shot_timer_update(&replay->timer, sample->grams, sample->timestamp, weight_sensor_get_filter_delay()))
+    {
+        case SHOT_TIMER_EVENT_STARTED:
+            edge_fired(&replay->start, replay, sample);
+            break;
+
+        case SHOT_TIMER_EVENT_STOPPED:
+            edge_fired(&replay->stop, replay, sample);
+            break;
+
+        default:
+            break;
+    }
+
+    replay->previous_valid = true;
+    replay->previous_trace_grams = sample->trace_grams;
+    replay->previous_timestamp = sample->timestamp;
+}
+
+static float ticks_to_ms(int32_t ticks)
+{
+    return (float)ticks * 1000.0f / (float)SAMPLE_CLOCK_TICKS_PER_SECOND;
+}
+
+static void check_edge(const char *name, const shot_timer_edge_t *edge)
+{
+    HOST_TEST_CHECK(edge->crossed);
+    HOST_TEST_CHECK(edge->fired);
+
+    if (!edge->crossed || !edge->fired)
+    {
+        return;
+    }
+
+    float latencyMs = ticks_to_ms((int32_t)(edge->detected - edge->crossing));
+    float errorMs = ticks_to_ms((int32_t)(edge->event_time - edge->crossing));
+
+    printf("%s at %.1f g: detected %.1f ms after the crossing, timed %+.1f ms from it\n",
+           name, edge->threshold, latencyMs, errorMs);
+
+    HOST_TEST_CHECK(latencyMs >= 0.0f);
+    HOST_TEST_CHECK(latencyMs < SHOT_TIMER_MAX_LATENCY_MS);
+    HOST_TEST_CHECK(fabsf(errorMs) < MAX_TIME_ERROR_MS);
+}
+
+// As weigh_mode_apply(WEIGH_MODE_ESPRESSO) sets the sensor up
+static void espresso_settings(void)
+{
+    weight_sensor_set_rate_mode(WEIGHT_SENSOR_RATE_FAST);
+    weight_sensor_set_pipeline(WEIGHT_SENSOR_PIPELINE_BIQUAD);
+    weight_sensor_set_weight_filter_cutoff(8.0f);
+    weight_sensor_set_flow_fit_window(0.3f);
+    weight_sensor_set_flow_source(WEIGHT_SENSOR_FLOW_LEAST_SQUARES);
+    weight_sensor_set_notch_enabled(true);
+}
+
+static bool run_shot(shot_replay_t *replay, float target)
+{
+    trace_replay_config_t config =
+    {
+        .trace = TRACE_REPLAY_FILE,
+        .noise = TRACE_NOISE,
+        .points = mPoints,
+        .point_count = mPointCount,
+    };
+    trace_replay_t trace;
+
+    memset(replay, 0, sizeof(*replay));
+    shot_timer_init(&replay->timer);
+    shot_timer_set_target(&replay->timer, target);
+    replay->start.threshold = SHOT_TIMER_START_GRAMS;
+    replay->stop.threshold = target;
+
+    if (!trace_replay_init(&trace, &config) || !replay_harness_init(NULL))
+    {
+        return false;
+    }
+
+    espresso_settings();
+
+    return replay_harness_run(&trace, shot_replay_observe, replay);
+}
+
+static void test_shot_to_mid_extraction_target(void)
+{
+    shot_replay_t replay;
+
+    HOST_TEST_CHECK(run_shot(&replay, 20.0f));
+
+    check_edge("start", &replay.start);
+    check_edge("stop", &replay.stop);
+
+    // The shot time is the difference of the two, so it is as good as they are
+    float trueMs = ticks_to_ms((int32_t)(replay.stop.crossing - replay.start.crossing));
+
+    printf("shot time %u ms, trace %.1f ms\n", replay.timer.result.time_ms, trueMs);
+    HOST_TEST_CHECK_NEAR(trueMs, replay.timer.result.time_ms, 2.0f * MAX_TIME_ERROR_MS);
+}
+
+static void test_shot_to_late_target(void)
+{
+    shot_replay_t replay;
+
+    HOST_TEST_CHECK(run_shot(&replay, 34.0f));
+
+    check_edge("start", &replay.start);
+    check_edge("stop", &replay.stop);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || (mPointCount = trace_replay_load_file(argv[1], mPoints, TRACE_REPLAY_MAX_POINTS)) == 0)
+    {
+        fprintf(stderr, "usage: %s espresso_shot.csv\n", argv[0]);
+        return 2;
+    }
+
+    HOST_TEST_RUN(test_shot_to_mid_extraction_target);
+    HOST_TEST_RUN(test_shot_to_late_target);
+
+    return host_test_result();
+}
@@ -0,0 +1,132 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "host_test.h"
+#include "replay_harness.h"
+#include "Components/WeightSensor/WeightSensor.h"
+
+// Vibration notch on a synthetic tone riding on a cup of coffee: the notch has to find the tone, follow it when
+// the pump changes speed, and take it out of the filtered weight. Tones are kept inside the espresso weight
+// filter passband, so what the weight filter does to them on its own is the reference
+
+int host_test_failures = 0;
+
+#define CUP_GRAMS           250.0f
+#define TONE_GRAMS          0.5f        // peak
+#define WEIGHT_CUTOFF       8.0f        // Hz, the espresso weight filter
+#define FIRST_TONE_HZ       4.0f
+#define SECOND_TONE_HZ      6.5f        // pump speeding up
+#define TONE_SECONDS        10.0f
+#define MEASURE_SECONDS     3.0f        // at the end of each tone, the notch has had time to move
+#define MAX_FREQUENCY_ERROR 0.4f        // Hz, inside the notch width
+#define MIN_ATTENUATION     5.0f        // the scan places the tone to within a bin fraction, not exactly
+
+typedef struct
+{
+    float phase;                // rad, carried across frequency changes
+    double error_squares;
+    uint32_t count;
+} tone_run_t;
+
+// Runs seconds of the tone at hz, measuring the filtered weight against the cup over the last MEASURE_SECONDS.
+// Returns the RMS error
+static float tone_run(tone_run_t *run, float hz, float seconds)
+{
+    float time = 0.0f;
+
+    run->error_squares = 0.0;
+    run->count = 0;
+
+    while (time < seconds)
+    {
+        float period = replay_harness_conversion_period();
+
+        run->phase = fmodf(run->phase + 2.0f * (float)M_PI * hz * period, 2.0f * (float)M_PI);
+        time += period;
+
+        float tone = hz > 0.0f ? TONE_GRAMS * sinf(run->phase) : 0.0f;
+
+        if (replay_harness_convert(CUP_GRAMS + tone, NULL) &&
+            time >= seconds - MEASURE_SECONDS)
+        {
+            float error = replay_harness_filtered_grams() - CUP_GRAMS;
+
+            run->error_squares += (double)error * error;
+            run->count++;
+        }
+    }
+
+    return run->count > 0 ? (float)sqrt(run->error_squares / run->count) : INFINITY;
+}
+
+static bool setup(bool notch)
+{
+    if (!replay_harness_init(NULL))
+    {
+        return false;
+    }
+
+    weight_sensor_set_rate_mode(WEIGHT_SENSOR_RATE_FAST);
+    weight_sensor_set_weight_filter_cutoff(WEIGHT_CUTOFF);
+    weight_sensor_set_notch_enabled(notch);
+
+    // The cup goes on before the pump starts, the step is out of the scan window by the time it is measured
+    tone_run_t settle = { 0 };
+    tone_run(&settle, 0.0f, 2.0f);
+
+    return true;
+}
+
+static void test_notch_tracks_and_attenuates(void)
+{
+    tone_run_t plain = { 0 };
+    tone_run_t notched = { 0 };
+
+    // The weight filter alone lets the tones through
+    HOST_TEST_CHECK(setup(false));
+    float plainFirst = tone_run(&plain, FIRST_TONE_HZ, TONE_SECONDS);
+    float plainSecond = tone_run(&plain, SECOND_TONE_HZ, TONE_SECONDS);
+
+    HOST_TEST_CHECK_EQUAL(0, weight_sensor_get_notch_frequency());
+    HOST_TEST_CHECK(plainFirst > 0.5f * TONE_GRAMS / sqrtf(2.0f));
+    HOST_TEST_CHECK(plainSecond > 0.5f * TONE_GRAMS / sqrtf(2.0f));
+
+    HOST_TEST_CHECK(setup(true));
+    float notchedFirst = tone_run(&notched, FIRST_TONE_HZ, TONE_SECONDS);
+    float firstHz = weight_sensor_get_notch_frequency();
+    float notchedSecond = tone_run(&notched, SECOND_TONE_HZ, TONE_SECONDS);
+    float secondHz = weight_sensor_get_notch_frequency();
+
+    printf("%.1f Hz tone: notch at %.2f Hz, %.4f g RMS against %.4f g without (%.1fx)\n",
+           FIRST_TONE_HZ, firstHz, notchedFirst, plainFirst, plainFirst / notchedFirst);
+    printf("%.1f Hz tone: notch at %.2f Hz, %.4f g RMS against %.4f g without (%.1fx)\n",
+           SECOND_TONE_HZ, secondHz, notchedSecond, plainSecond, plainSecond / notchedSecond);
+
+    HOST_TEST_CHECK_NEAR(FIRST_TONE_HZ, firstHz, MAX_FREQUENCY_ERROR);
+    HOST_TEST_CHECK_NEAR(SECOND_TONE_HZ, secondHz, MAX_FREQUENCY_ERROR);
+    HOST_TEST_CHECK(notchedFirst * MIN_ATTENUATION < plainFirst);
+    HOST_TEST_CHECK(notchedSecond * MIN_ATTENUATION < plainSecond);
+}
+
+static void test_notch_leaves_when_the_tone_stops(void)
+{
+    tone_run_t run = { 0 };
+
+    HOST_TEST_CHECK(setup(true));
+    tone_run(&run, FIRST_TONE_HZ, TONE_SECONDS);
+    HOST_TEST_CHECK(weight_sensor_get_notch_frequency() > 0.0f);
+
+    // Pump off, the cup reads true again without the notch in the path
+    float rms = tone_run(&run, 0.0f, TONE_SECONDS);
+
+    HOST_TEST_CHECK_EQUAL(0, weight_sensor_get_notch_frequency());
+    HOST_TEST_CHECK(rms < 0.05f);
+}
+
+int main(void)
+{
+    HOST_TEST_RUN(test_notch_tracks_and_attenuates);
+    HOST_TEST_RUN(test_notch_leaves_when_the_tone_stops);
+
+    return host_test_result();
+}
@@ -19,6 +19,54 @@ float biquad_process(Biquad *filt, float in);
 // Process sample through cascaded biquads
 float filter_process(Biquad *filt, int num_sections, float in);
 
+// Process a block of samples through cascaded biquads, section by section. in and out may be the same buffer.
+// Gives the same output as filter_process on each sample, no faster than it on the host
+void filter_process_block(Biquad *filt, int num_sections, const float *in, float *out, int num_samples);
+
+// filter_process on each sample in turn, what filter_process_block is checked against
+void filter_process_block_reference(Biquad *filt, int num_sections, const float *in, float *out, int num_samples);
+
 void biquad_reset(Biquad *filt, int num_sections);
 
+// Copy the coefficients of a cascade into filt, leaving its state untouched
+void filter_set_coefficients(Biquad *filt, const Biquad *coefficients, int num_sections);
+
+// Set the state of a cascade as if it had settled on a constant input
+void filter_preload(Biquad *filt, int num_sections, float in);
+
+// Swap in new coefficients without a step in the output. The state is preloaded as if the new cascade
+// had settled on out, the last output of the old one
+void filter_swap_coefficients(Biquad *filt, const Biquad *coefficients, int num_sections, float out);
+
+// Design a Butterworth low-pass of the given order as cascaded sections (an odd order ends with a first
+// order section). Returns the number of sections written, or 0 if the order doesn't fit in max_sections
+// or the cutoff isn't between 0 and the Nyquist frequency
+int biquad_design_butterworth_lowpass(Biquad *sections, int max_sections, int order, float cutoff_hz, float sample_rate_hz);
+
+// Design a notch with unity gain away from center_hz and the given -3 dB bandwidth. Returns 1, or 0 if the
+// notch doesn't fit between 0 and the Nyquist frequency
+int biquad_design_notch(Biquad *section, float center_hz, float bandwidth_hz, float sample_rate_hz);
+
+// Fixed point biquad. Coefficients are Q2.29 so a1 down to -2 fits, the state is kept in 64 bits
+// so no precision is lost between samples
+#define BIQUAD_Q_FRACTIONAL_BITS 29
+
+typedef struct {
+    int32_t b0, b1, b2;
+    int32_t a1, a2;
+    int64_t z1, z2;
+} __attribute__((aligned(8))) BiquadQ;
+
+// Convert the coefficients of a floating point cascade, leaving the state untouched
+void filter_q_set_coefficients(BiquadQ *filt, const Biquad *coefficients, int num_sections);
+
+// Process one sample through one fixed point biquad section
+int32_t biquad_q_process(BiquadQ *filt, int32_t in);
+
+// Process sample through cascaded fixed point biquads
+int32_t filter_q_process(BiquadQ *filt, int num_sections, int32_t in);
+
+// Set the state of a fixed point cascade as if it had settled on a constant input
+void filter_q_preload(BiquadQ *filt, int num_sections, int32_t in);
+
 #endif
\ No newline at end of file
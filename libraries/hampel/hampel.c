@@ -0,0 +1,77 @@
+#include "hampel.h"
+
+// Scales the MAD to the standard deviation of normally distributed noise
+#define HAMPEL_MAD_SCALE 1.4826f
+
+static int32_t hampel_median(int32_t *values, uint8_t n) {
+    // Insertion sort, the window is only a handful of samples
+    for (uint8_t i = 1; i < n; i++) {
+        int32_t value = values[i];
+        int j = i - 1;
+        while (j >= 0 && values[j] > value) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = value;
+    }
+    return values[n / 2];
+}
+
+bool hampel_init(Hampel *filt, uint8_t size, float threshold, int32_t min_deviation) {
+    if (size == 0 || size > HAMPEL_MAX_WINDOW || (size % 2) == 0) {
+        return false;
+    }
+
+    filt->size = size;
+    filt->threshold = threshold;
+    filt->min_deviation = min_deviation;
+    filt->rejected = 0;
+    hampel_reset(filt);
+
+    return true;
+}
+
+void hampel_reset(Hampel *filt) {
+    filt->count = 0;
+    filt->next = 0;
+}
+
+int32_t hampel_process(Hampel *filt, int32_t in) {
+    filt->window[filt->next] = in;
+    filt->next = (filt->next + 1) % filt->size;
+
+    if (filt->count < filt->size) {
+        filt->count++;
+        return in;
+    }
+
+    int32_t sorted[HAMPEL_MAX_WINDOW];
+    for (uint8_t i = 0; i < filt->size; i++) {
+        sorted[i] = filt->window[i];
+    }
+    int32_t median = hampel_median(sorted, filt->size);
+
+    int32_t deviations[HAMPEL_MAX_WINDOW];
+    for (uint8_t i = 0; i < filt->size; i++) {
+        int32_t deviation = filt->window[i] - median;
+        deviations[i] = deviation < 0 ? -deviation : deviation;
+    }
+    int32_t mad = hampel_median(deviations, filt->size);
+
+    float limit = filt->threshold * HAMPEL_MAD_SCALE * (float)mad;
+    if (limit < (float)filt->min_deviation) {
+        limit = (float)filt->min_deviation;
+    }
+
+    int32_t deviation = in - median;
+    if ((float)(deviation < 0 ? -deviation : deviation) > limit) {
+        filt->rejected++;
+        return median;
+    }
+
+    return in;
+}
+
+uint32_t hampel_get_rejected(Hampel *filt) {
+    return filt->rejected;
+}
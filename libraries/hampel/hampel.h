@@ -0,0 +1,36 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef HAMPEL_h
+#define HAMPEL_h
+
+#define HAMPEL_MAX_WINDOW 9
+
+// Causal Hampel filter. Each sample is compared with the median of the window ending on it and replaced
+// by that median if it is further away than threshold scaled median absolute deviations (MAD) of the
+// window, or min_deviation if that is larger so a very quiet signal isn't chopped up
+typedef struct {
+    int32_t window[HAMPEL_MAX_WINDOW];     // raw samples, outliers included
+    uint8_t size;
+    uint8_t count;
+    uint8_t next;
+
+    float threshold;
+    int32_t min_deviation;
+
+    uint32_t rejected;
+} Hampel;
+
+// size must be odd and no more than HAMPEL_MAX_WINDOW. Returns false if it isn't
+bool hampel_init(Hampel *filt, uint8_t size, float threshold, int32_t min_deviation);
+
+// Empty the window, the rejected count is kept
+void hampel_reset(Hampel *filt);
+
+// Returns in, or the median of the window if in is an outlier. Samples pass straight through until
+// the window is full
+int32_t hampel_process(Hampel *filt, int32_t in);
+
+uint32_t hampel_get_rejected(Hampel *filt);
+
+#endif
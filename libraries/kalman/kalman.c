@@ -0,0 +1,56 @@
+#include "kalman.h"
+
+void kalman_init(Kalman *filt, float process_noise, float measurement_noise) {
+    filt->value = 0.0f;
+    filt->rate = 0.0f;
+    filt->p00 = 0.0f;
+    filt->p01 = 0.0f;
+    filt->p11 = 0.0f;
+    filt->process_noise = process_noise;
+    filt->measurement_noise = measurement_noise;
+    filt->initialised = false;
+}
+
+void kalman_set_noise(Kalman *filt, float process_noise, float measurement_noise) {
+    filt->process_noise = process_noise;
+    filt->measurement_noise = measurement_noise;
+}
+
+void kalman_reset(Kalman *filt, float value, float rate) {
+    filt->value = value;
+    filt->rate = rate;
+    filt->p00 = filt->measurement_noise;
+    filt->p01 = 0.0f;
+    filt->p11 = filt->measurement_noise;
+    filt->initialised = true;
+}
+
+void kalman_update(Kalman *filt, float measurement, float dt) {
+    if (!filt->initialised) {
+        kalman_reset(filt, measurement, 0.0f);
+        return;
+    }
+
+    // Predict, x = F x and P = F P F' + Q with F = [1 dt; 0 1]
+    float dt2 = dt * dt;
+    float q = filt->process_noise;
+
+    filt->value += filt->rate * dt;
+
+    float p00 = filt->p00 + 2.0f * dt * filt->p01 + dt2 * filt->p11 + q * dt2 * dt / 3.0f;
+    float p01 = filt->p01 + dt * filt->p11 + q * dt2 / 2.0f;
+    float p11 = filt->p11 + q * dt;
+
+    // Correct with the measurement, H = [1 0]
+    float s = p00 + filt->measurement_noise;
+    float k0 = p00 / s;
+    float k1 = p01 / s;
+    float innovation = measurement - filt->value;
+
+    filt->value += k0 * innovation;
+    filt->rate += k1 * innovation;
+
+    filt->p00 = (1.0f - k0) * p00;
+    filt->p01 = (1.0f - k0) * p01;
+    filt->p11 = p11 - k1 * p01;
+}
@@ -0,0 +1,35 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef KALMAN_h
+#define KALMAN_h
+
+// Constant velocity Kalman filter estimating a value and its rate of change together from noisy,
+// irregularly timed measurements of the value. The rate is modelled as a random walk driven by white
+// noise acceleration of spectral density process_noise, measurements have variance measurement_noise
+typedef struct {
+    float value;
+    float rate;
+
+    // Covariance of the estimate, symmetric so p10 isn't stored
+    float p00, p01, p11;
+
+    float process_noise;        // (units/s^2)^2 per Hz
+    float measurement_noise;    // units^2
+
+    bool initialised;
+} Kalman;
+
+void kalman_init(Kalman *filt, float process_noise, float measurement_noise);
+
+// Change the noise parameters, the estimate is kept
+void kalman_set_noise(Kalman *filt, float process_noise, float measurement_noise);
+
+// Restart the estimate at a known value and rate. The covariance starts at the measurement noise
+void kalman_reset(Kalman *filt, float value, float rate);
+
+// Predict forward dt seconds and correct with a measurement. The first measurement after init
+// starts the estimate
+void kalman_update(Kalman *filt, float measurement, float dt);
+
+#endif
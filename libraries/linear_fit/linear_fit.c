@@ -0,0 +1,125 @@
+#include "linear_fit.h"
+
+#include <math.h>
+
+#define LINEAR_FIT_US_PER_SECOND 1000000.0f
+
+bool linear_fit_window_init(LinearFitWindow *fit, float windowSeconds) {
+    linear_fit_window_reset(fit);
+
+    return linear_fit_window_set_length(fit, windowSeconds);
+}
+
+void linear_fit_window_reset(LinearFitWindow *fit) {
+    fit->count = 0;
+    fit->oldest = 0;
+    fit->since_rebase = 0;
+    fit->reference_time = 0;
+    fit->reference_value = 0.0f;
+    fit->sum_t = 0.0f;
+    fit->sum_v = 0.0f;
+    fit->sum_tt = 0.0f;
+    fit->sum_tv = 0.0f;
+    fit->sum_vv = 0.0f;
+}
+
+static void linear_fit_window_accumulate(LinearFitWindow *fit, uint16_t index, float sign) {
+    float t = (float)(fit->timestamps[index] - fit->reference_time) / LINEAR_FIT_US_PER_SECOND;
+    float v = fit->values[index] - fit->reference_value;
+
+    fit->sum_t += sign * t;
+    fit->sum_v += sign * v;
+    fit->sum_tt += sign * t * t;
+    fit->sum_tv += sign * t * v;
+    fit->sum_vv += sign * v * v;
+}
+
+// Sum again from the oldest sample, which becomes the reference
+static void linear_fit_window_rebase(LinearFitWindow *fit) {
+    fit->sum_t = 0.0f;
+    fit->sum_v = 0.0f;
+    fit->sum_tt = 0.0f;
+    fit->sum_tv = 0.0f;
+    fit->sum_vv = 0.0f;
+
+    if (fit->count > 0) {
+        fit->reference_time = fit->timestamps[fit->oldest];
+        fit->reference_value = fit->values[fit->oldest];
+    }
+
+    uint16_t index = fit->oldest;
+    for (uint16_t i = 0; i < fit->count; i++) {
+        linear_fit_window_accumulate(fit, index, 1.0f);
+        index = (index + 1) % LINEAR_FIT_MAX_SAMPLES;
+    }
+
+    fit->since_rebase = 0;
+}
+
+static void linear_fit_window_remove_oldest(LinearFitWindow *fit) {
+    linear_fit_window_accumulate(fit, fit->oldest, -1.0f);
+    fit->oldest = (fit->oldest + 1) % LINEAR_FIT_MAX_SAMPLES;
+    fit->count--;
+}
+
+bool linear_fit_window_set_length(LinearFitWindow *fit, float windowSeconds) {
+    if (!(windowSeconds > 0.0f)) {
+        return false;
+    }
+
+    fit->window = (uint32_t)(windowSeconds * LINEAR_FIT_US_PER_SECOND);
+
+    return true;
+}
+
+void linear_fit_window_add(LinearFitWindow *fit, uint32_t timestamp, float value) {
+    if (fit->count == 0) {
+        fit->reference_time = timestamp;
+        fit->reference_value = value;
+    }
+
+    while (fit->count > 0 &&
+           (fit->count == LINEAR_FIT_MAX_SAMPLES || timestamp - fit->timestamps[fit->oldest] > fit->window)) {
+        linear_fit_window_remove_oldest(fit);
+    }
+
+    uint16_t index = (fit->oldest + fit->count) % LINEAR_FIT_MAX_SAMPLES;
+
+    fit->timestamps[index] = timestamp;
+    fit->values[index] = value;
+    fit->count++;
+
+    linear_fit_window_accumulate(fit, index, 1.0f);
+
+    if (++fit->since_rebase >= LINEAR_FIT_MAX_SAMPLES) {
+        linear_fit_window_rebase(fit);
+    }
+}
+
+float linear_fit_window_slope(LinearFitWindow *fit) {
+    float n = (float)fit->count;
+    float timeSpread = n * fit->sum_tt - fit->sum_t * fit->sum_t;
+
+    if (fit->count < 2 || timeSpread <= 0.0f) {
+        return 0.0f;
+    }
+
+    return (n * fit->sum_tv - fit->sum_t * fit->sum_v) / timeSpread;
+}
+
+float linear_fit_window_r_squared(LinearFitWindow *fit) {
+    float n = (float)fit->count;
+    float timeSpread = n * fit->sum_tt - fit->sum_t * fit->sum_t;
+    float valueSpread = n * fit->sum_vv - fit->sum_v * fit->sum_v;
+    float covariance = n * fit->sum_tv - fit->sum_t * fit->sum_v;
+
+    if (fit->count < 2 || timeSpread <= 0.0f) {
+        return 0.0f;
+    }
+
+    if (valueSpread <= 0.0f) {
+        return 1.0f;
+    }
+
+    return fminf(covariance * covariance / (timeSpread * valueSpread), 1.0f);
+}
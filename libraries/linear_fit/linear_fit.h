@@ -0,0 +1,49 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef LINEAR_FIT_h
+#define LINEAR_FIT_h
+
+#define LINEAR_FIT_MAX_SAMPLES 128
+
+// Least squares line through the timestamped samples of the last window seconds. The running sums of the fit
+// are updated as samples enter and leave the window, so each sample is amortised O(1) whatever the window
+// length. Times and values are summed relative to the oldest sample, rebased every LINEAR_FIT_MAX_SAMPLES
+// samples so the float sums stay well conditioned and rounding can't accumulate. Samples past
+// LINEAR_FIT_MAX_SAMPLES in the window push the oldest out early
+typedef struct {
+    uint32_t timestamps[LINEAR_FIT_MAX_SAMPLES];    // us
+    float values[LINEAR_FIT_MAX_SAMPLES];
+    uint16_t count;
+    uint16_t oldest;
+    uint16_t since_rebase;
+    uint32_t window;            // us
+
+    uint32_t reference_time;    // us
+    float reference_value;
+    float sum_t;                // s
+    float sum_v;
+    float sum_tt;
+    float sum_tv;
+    float sum_vv;
+} LinearFitWindow;
+
+// Returns false if the window isn't positive
+bool linear_fit_window_init(LinearFitWindow *fit, float windowSeconds);
+
+// Keeps the samples that still fit in the new window
+bool linear_fit_window_set_length(LinearFitWindow *fit, float windowSeconds);
+
+void linear_fit_window_reset(LinearFitWindow *fit);
+
+// timestamp in microseconds, wrapping like the sample clock
+void linear_fit_window_add(LinearFitWindow *fit, uint32_t timestamp, float value);
+
+// Slope of the fit in value units per second, 0 with fewer than two distinct times
+float linear_fit_window_slope(LinearFitWindow *fit);
+
+// Fraction of the variance of the values explained by the fit, 0 (no trend in the noise) to 1 (on a line).
+// A window of equal values is a perfect fit
+float linear_fit_window_r_squared(LinearFitWindow *fit);
+
+#endif
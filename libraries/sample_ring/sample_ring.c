@@ -0,0 +1,87 @@
+#include "sample_ring.h"
+#include "nrf.h"
+
+#define SAMPLE_RING_MASK (SAMPLE_RING_SIZE - 1)
+
+#if (SAMPLE_RING_SIZE & SAMPLE_RING_MASK) != 0
+#error "SAMPLE_RING_SIZE must be a power of two"
+#endif
+
+void sample_ring_init(sample_ring_t *ring)
+{
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overruns = 0;
+    ring->highWatermark = 0;
+}
+
+bool sample_ring_push(sample_ring_t *ring, int32_t value, uint32_t timestamp)
+{
+    uint32_t head = ring->head;
+    uint32_t count = head - ring->tail;
+
+    if (count >= SAMPLE_RING_SIZE)
+    {
+        ring->overruns++;
+        return false;
+    }
+
+    ring->samples[head & SAMPLE_RING_MASK].value = value;
+    ring->samples[head & SAMPLE_RING_MASK].timestamp = timestamp;
+
+    // Make sure the sample is in memory before the consumer can see the new head
+    __DMB();
+    ring->head = head + 1;
+
+    if (count + 1 > ring->highWatermark)
+    {
+        ring->highWatermark = count + 1;
+    }
+
+    return true;
+}
+
+uint32_t sample_ring_pop_batch(sample_ring_t *ring, ring_sample_t *samples, uint32_t maxSamples)
+{
+    uint32_t tail = ring->tail;
+    uint32_t available = ring->head - tail;
+
+    // Read the head before the samples it publishes
+    __DMB();
+
+    if (available > maxSamples)
+    {
+        available = maxSamples;
+    }
+
+    for (uint32_t i = 0; i < available; i++)
+    {
+        samples[i] = ring->samples[(tail + i) & SAMPLE_RING_MASK];
+    }
+
+    // Finish reading the samples before the producer is allowed to reuse the slots
+    __DMB();
+    ring->tail = tail + available;
+
+    return available;
+}
+
+uint32_t sample_ring_count(sample_ring_t *ring)
+{
+    return ring->head - ring->tail;
+}
+
+uint32_t sample_ring_get_overruns(sample_ring_t *ring)
+{
+    return ring->overruns;
+}
+
+uint32_t sample_ring_get_high_watermark(sample_ring_t *ring)
+{
+    return ring->highWatermark;
+}
+
+void sample_ring_flush(sample_ring_t *ring)
+{
+    ring->tail = ring->head;
+}
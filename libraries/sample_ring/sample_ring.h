@@ -0,0 +1,43 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef SAMPLE_RING_h
+#define SAMPLE_RING_h
+
+// Number of slots in a sample ring, must be a power of two
+#define SAMPLE_RING_SIZE 64
+
+typedef struct {
+    int32_t value;          // raw conversion code
+    uint32_t timestamp;     // capture time of the conversion
+} ring_sample_t;
+
+// Single producer / single consumer ring of timestamped samples.
+// The producer (interrupt) only ever writes head, the consumer (main context) only ever writes tail,
+// so no locking is needed on a single core.
+typedef struct {
+    ring_sample_t samples[SAMPLE_RING_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t overruns;         // samples dropped because the ring was full
+    volatile uint32_t highWatermark;    // most samples ever waiting in the ring
+} sample_ring_t;
+
+void sample_ring_init(sample_ring_t *ring);
+
+// Producer side. Returns false and counts an overrun if the ring is full
+bool sample_ring_push(sample_ring_t *ring, int32_t value, uint32_t timestamp);
+
+// Consumer side. Copies up to maxSamples into samples and returns the number copied
+uint32_t sample_ring_pop_batch(sample_ring_t *ring, ring_sample_t *samples, uint32_t maxSamples);
+
+uint32_t sample_ring_count(sample_ring_t *ring);
+
+uint32_t sample_ring_get_overruns(sample_ring_t *ring);
+
+uint32_t sample_ring_get_high_watermark(sample_ring_t *ring);
+
+// Consumer side. Discards everything currently queued
+void sample_ring_flush(sample_ring_t *ring);
+
+#endif
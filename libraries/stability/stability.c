@@ -0,0 +1,105 @@
+#include "stability.h"
+
+bool stability_window_init(StabilityWindow *window, uint16_t size) {
+    if (size == 0 || size > STABILITY_MAX_WINDOW) {
+        return false;
+    }
+
+    window->size = size;
+    stability_window_reset(window);
+
+    return true;
+}
+
+void stability_window_reset(StabilityWindow *window) {
+    window->count = 0;
+    window->next = 0;
+    window->since_resum = 0;
+    window->reference = 0.0f;
+    window->sum = 0.0f;
+    window->sum_squares = 0.0f;
+    window->sum_index_values = 0.0f;
+}
+
+static void stability_window_resum(StabilityWindow *window) {
+    window->sum = 0.0f;
+    window->sum_squares = 0.0f;
+    window->sum_index_values = 0.0f;
+
+    // Oldest first, the oldest sample of a full window is the next to be overwritten
+    uint16_t index = window->count < window->size ? 0 : window->next;
+    for (uint16_t i = 0; i < window->count; i++) {
+        float value = window->values[index];
+        window->sum += value;
+        window->sum_squares += value * value;
+        window->sum_index_values += (float)i * value;
+        index = (index + 1) % window->size;
+    }
+
+    window->since_resum = 0;
+}
+
+void stability_window_add(StabilityWindow *window, float value) {
+    if (window->count == 0) {
+        window->reference = value;
+    }
+
+    float relative = value - window->reference;
+
+    if (window->count < window->size) {
+        window->sum_index_values += (float)window->count * relative;
+        window->sum += relative;
+        window->sum_squares += relative * relative;
+        window->values[window->next] = relative;
+        window->count++;
+    } else {
+        // Every remaining sample moves one index older
+        float oldest = window->values[window->next];
+        window->sum_index_values += (float)(window->size - 1) * relative - (window->sum - oldest);
+        window->sum += relative - oldest;
+        window->sum_squares += relative * relative - oldest * oldest;
+        window->values[window->next] = relative;
+    }
+
+    window->next = (window->next + 1) % window->size;
+
+    if (++window->since_resum >= window->size) {
+        stability_window_resum(window);
+    }
+}
+
+bool stability_window_full(StabilityWindow *window) {
+    return window->count == window->size;
+}
+
+float stability_window_mean(StabilityWindow *window) {
+    if (window->count == 0) {
+        return 0.0f;
+    }
+
+    return window->reference + window->sum / (float)window->count;
+}
+
+float stability_window_variance(StabilityWindow *window) {
+    if (window->count == 0) {
+        return 0.0f;
+    }
+
+    float n = (float)window->count;
+    float mean = window->sum / n;
+    float variance = window->sum_squares / n - mean * mean;
+
+    return variance > 0.0f ? variance : 0.0f;
+}
+
+float stability_window_slope(StabilityWindow *window) {
+    if (window->count < 2) {
+        return 0.0f;
+    }
+
+    float n = (float)window->count;
+    float meanIndex = (n - 1.0f) / 2.0f;
+    float indexVariance = n * (n * n - 1.0f) / 12.0f;
+
+    return (window->sum_index_values - meanIndex * window->sum) / indexVariance;
+}
@@ -0,0 +1,43 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef STABILITY_h
+#define STABILITY_h
+
+#define STABILITY_MAX_WINDOW 128
+
+// Sliding window over the most recent samples keeping the running sums needed for the mean, variance and
+// least squares slope, so each sample is an O(1) update. Values are stored relative to the first sample
+// after a reset to keep the float sums well conditioned, and the sums are rebuilt from the window once
+// per window length so rounding can't accumulate
+typedef struct {
+    float values[STABILITY_MAX_WINDOW];
+    uint16_t size;
+    uint16_t count;
+    uint16_t next;
+    uint16_t since_resum;
+
+    float reference;
+    float sum;              // sum of values
+    float sum_squares;      // sum of values squared
+    float sum_index_values; // sum of index * value, index 0 is the oldest sample
+} StabilityWindow;
+
+// Returns false if size is 0 or more than STABILITY_MAX_WINDOW
+bool stability_window_init(StabilityWindow *window, uint16_t size);
+
+void stability_window_reset(StabilityWindow *window);
+
+void stability_window_add(StabilityWindow *window, float value);
+
+bool stability_window_full(StabilityWindow *window);
+
+float stability_window_mean(StabilityWindow *window);
+
+// Population variance of the window
+float stability_window_variance(StabilityWindow *window);
+
+// Least squares slope of the window, per sample
+float stability_window_slope(StabilityWindow *window);
+
+#endif
@@ -0,0 +1,154 @@
+#include "vibration.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Line through the samples as value = offset + slope * (i - centre)
+typedef struct {
+    float centre;
+    float offset;
+    float slope;
+} Trend;
+
+static Trend vibration_trend(const float *samples, int num_samples) {
+    Trend trend;
+    float sum = 0.0f;
+    float sum_index_values = 0.0f;
+    float sum_index_squares = 0.0f;
+
+    trend.centre = 0.5f * (float)(num_samples - 1);
+
+    for (int i = 0; i < num_samples; i++) {
+        float index = (float)i - trend.centre;
+        sum += samples[i];
+        sum_index_values += index * samples[i];
+        sum_index_squares += index * index;
+    }
+
+    trend.offset = sum / (float)num_samples;
+    trend.slope = sum_index_squares > 0.0f ? sum_index_values / sum_index_squares : 0.0f;
+
+    return trend;
+}
+
+static float vibration_goertzel(const float *samples, int num_samples, const Trend *trend, int k) {
+    float coefficient = 2.0f * cosf(2.0f * (float)M_PI * (float)k / (float)num_samples);
+    float s1 = 0.0f;
+    float s2 = 0.0f;
+
+    for (int i = 0; i < num_samples; i++) {
+        float value = samples[i] - trend->offset - trend->slope * ((float)i - trend->centre);
+        float s0 = value + coefficient * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    return s1 * s1 + s2 * s2 - coefficient * s1 * s2;
+}
+
+void vibration_detector_init(VibrationDetector *detector) {
+    memset(detector, 0, sizeof(*detector));
+}
+
+void vibration_detector_reset(VibrationDetector *detector) {
+    detector->count = 0;
+}
+
+// Strongest bin of the window. Returns false if nothing stands out of the rest of the signal
+static bool vibration_scan(VibrationDetector *detector, float sample_rate_hz, float *frequency, float *amplitude) {
+    const int n = VIBRATION_WINDOW;
+    Trend trend = vibration_trend(detector->samples, n);
+
+    float energy = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float value = detector->samples[i] - trend.offset - trend.slope * ((float)i - trend.centre);
+        energy += value * value;
+    }
+
+    int first = (int)ceilf(VIBRATION_MIN_HZ * (float)n / sample_rate_hz);
+    int last = n / 2 - 1;
+
+    if (first < 1) {
+        first = 1;
+    }
+
+    if (energy <= 0.0f || last - first < 2) {
+        return false;
+    }
+
+    float power[VIBRATION_WINDOW / 2];
+    int peak = first;
+
+    for (int k = first; k <= last; k++) {
+        power[k] = vibration_goertzel(detector->samples, n, &trend, k);
+        if (power[k] > power[peak]) {
+            peak = k;
+        }
+    }
+
+    // Between bins a sinusoid leaks into its neighbours, count them in
+    float below = peak > first ? power[peak - 1] : 0.0f;
+    float above = peak < last ? power[peak + 1] : 0.0f;
+
+    // By Parseval each bin below Nyquist holds 2 |X(k)|^2 / n of the energy
+    float fraction = 2.0f * (below + power[peak] + above) / ((float)n * energy);
+
+    *amplitude = sqrtf(2.0f * fraction * energy / (float)n);
+
+    // Parabola through the magnitudes places the peak between bins
+    float m0 = sqrtf(below);
+    float m1 = sqrtf(power[peak]);
+    float m2 = sqrtf(above);
+    float curvature = m0 - 2.0f * m1 + m2;
+    float offset = curvature < 0.0f ? 0.5f * (m0 - m2) / curvature : 0.0f;
+
+    offset = fmaxf(-0.5f, fminf(offset, 0.5f));
+    *frequency = ((float)peak + offset) * sample_rate_hz / (float)n;
+
+    return fraction >= VIBRATION_MIN_POWER_FRACTION && *amplitude >= VIBRATION_MIN_AMPLITUDE;
+}
+
+bool vibration_detector_add(VibrationDetector *detector, float sample, float sample_rate_hz) {
+    detector->samples[detector->count++] = sample;
+
+    if (detector->count < VIBRATION_WINDOW) {
+        return false;
+    }
+
+    float frequency = 0.0f;
+    float amplitude = 0.0f;
+
+    if (sample_rate_hz > 0.0f && vibration_scan(detector, sample_rate_hz, &frequency, &amplitude)) {
+        detector->misses = 0;
+        if (detector->hits < VIBRATION_CONFIRM_SCANS) {
+            detector->hits++;
+        }
+
+        if (detector->hits >= VIBRATION_CONFIRM_SCANS) {
+            detector->detected = true;
+            detector->frequency = frequency;
+            detector->amplitude = amplitude;
+        }
+    } else {
+        detector->hits = 0;
+        if (detector->misses < VIBRATION_CONFIRM_SCANS) {
+            detector->misses++;
+        }
+
+        if (detector->misses >= VIBRATION_CONFIRM_SCANS) {
+            detector->detected = false;
+            detector->frequency = 0.0f;
+            detector->amplitude = 0.0f;
+        }
+    }
+
+    // Keep the newer half so the next scan overlaps this one
+    memmove(detector->samples, &detector->samples[VIBRATION_WINDOW / 2], (VIBRATION_WINDOW / 2) * sizeof(float));
+    detector->count = VIBRATION_WINDOW / 2;
+
+    return true;
+}
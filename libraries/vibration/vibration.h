@@ -0,0 +1,38 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef VIBRATION_h
+#define VIBRATION_h
+
+#define VIBRATION_WINDOW 128
+
+// Finds a steady periodic component in the weight, such as an espresso pump or grinder shaking the drip
+// tray. The most recent VIBRATION_WINDOW samples are detrended, so a pour doesn't count, and scanned with
+// the Goertzel algorithm at every DFT bin from VIBRATION_MIN_HZ up to Nyquist. The window is scanned each
+// time half of it has been replaced. A vibration is reported once the strongest bin and its neighbours
+// hold most of the signal in VIBRATION_CONFIRM_SCANS scans in a row, and released after as many misses
+#define VIBRATION_MIN_HZ                3.0f    // below this it is the weight changing, not vibration
+#define VIBRATION_MIN_POWER_FRACTION    0.3f    // of the detrended signal power in the peak
+#define VIBRATION_MIN_AMPLITUDE         0.05f   // peak amplitude, in the units of the samples
+#define VIBRATION_CONFIRM_SCANS         2
+
+typedef struct {
+    float samples[VIBRATION_WINDOW];
+    uint16_t count;
+
+    uint8_t hits;           // scans in a row that found, or didn't find, a vibration
+    uint8_t misses;
+    bool detected;
+    float frequency;        // Hz of the vibration while detected
+    float amplitude;
+} VibrationDetector;
+
+void vibration_detector_init(VibrationDetector *detector);
+
+// Drops the samples in the window, e.g. after the sample rate changed, keeping what has been detected
+void vibration_detector_reset(VibrationDetector *detector);
+
+// Returns true when the sample completed a scan, detected, frequency and amplitude are then up to date
+bool vibration_detector_add(VibrationDetector *detector, float sample, float sample_rate_hz);
+
+#endif
@@ -11,6 +11,7 @@
 #include "nrf_sdh_soc.h"
 #include "nrf_sdh_ble.h"
 #include "app_timer.h"
+#include "app_scheduler.h"
 #include "nrf_pwr_mgmt.h"
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
@@ -32,8 +33,14 @@
 #include "Components/Bluetooth/Services/DiagnosticsService.h"
 #include "Components/SavedParameters/SavedParameters.h"
 #include "Components/IQS227D/iqs227d.h"
+#include "Components/Brew/pour_predictor.h"
+#include "Components/Brew/brew_phase.h"
+#include "Components/Brew/weigh_mode.h"
+#include "Components/Brew/shot_timer.h"
+#include "Components/WeightSensor/SampleClock/sample_clock.h"
 
 APP_TIMER_DEF(m_elapsed_time_timer_id);
+APP_TIMER_DEF(m_shot_timer_display_timer_id);
 APP_TIMER_DEF(m_battery_level_timer_id);
 APP_TIMER_DEF(m_touch_sensor1_timer_id);
 APP_TIMER_DEF(m_touch_sensor4_timer_id);
@@ -80,22 +87,95 @@ const nrfx_twi_t m_twi_secondary = NRFX_TWI_INSTANCE(TWI_SECONDARY_INSTANCE_ID);
 static const nrfx_spim_t spim3 = NRFX_SPIM_INSTANCE(ST7789_SPI_INSTANCE);  /**< SPI instance. */
 
 #define ELAPSED_TIMER_TIMER_INTERVAL            APP_TIMER_TICKS(1000) 
+#define SHOT_TIMER_DISPLAY_INTERVAL             APP_TIMER_TICKS(100) 
 #define BATTERY_LEVEL_TIMER_INTERVAL            APP_TIMER_TICKS(500) 
 #define TOUCH_SENSOR1_TIMER_INTERVAL            APP_TIMER_TICKS(3000) 
 #define TOUCH_SENSOR4_TIMER_INTERVAL            APP_TIMER_TICKS(3000) 
 
+// time from a new filtered weight to the weight bar changing colour on the display
+#define DISPLAY_LATENCY_S                       0.05f
+
+// learned pour in flight times closer than this to the saved one are only written to flash when going to sleep,
+// every pour would otherwise be a flash write
+#define POUR_IN_FLIGHT_SAVE_THRESHOLD_S         0.05f
+
+// Touch, BLE and battery timer handlers run in interrupt context. Anything they do to the weight sensor, or to the
+// brew state its callbacks update, is put on the scheduler and run from the main loop alongside weight_sensor_process
+typedef struct
+{
+    uint8_t command;
+    float referenceMass;
+} calibration_request_t;
+
+#define SCHED_MAX_EVENT_DATA_SIZE               MAX(sizeof(calibration_request_t), sizeof(diagnostics_pipeline_t))
+#define SCHED_QUEUE_SIZE                        8
+
+static void schedule(app_sched_event_handler_t handler, const void *data, uint16_t size)
+{
+    ret_code_t err_code = app_sched_event_put(data, size, handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+static pour_predictor_t mPourPredictor;
+static brew_phase_tracker_t mBrewPhase;
+static shot_timer_t mShotTimer;
+
 MAX17260 max17260Sensor;
 bool writeToWeightCharacteristic = false;
 
 void begin_timer_on_weight_change();
 void start_weight_sensor_timers();
 void set_coffee_weight_callback();
+static void timer_stable_weight_callback(weight_sensor_result_t result, float weight, float confidence);
+static void coffee_stable_weight_callback(weight_sensor_result_t result, float weight, float confidence);
 void start_elapsed_timer_timer_callback();
+void tare_complete_callback(weight_sensor_result_t result);
 void stop_elapsed_time_timer();
 
 void prepare_to_sleep();
 void wakeup_from_sleep();
 
+static void touch_sensor1_released(void * p_event_data, uint16_t event_size)
+{
+    if (button1OperationState == WAITING_FOR_TOUCH_RELEASE)
+    {
+        weight_sensor_get_stable_weight(NULL, timer_stable_weight_callback);
+
+        button1OperationState = IDLE;
+    }
+    else
+    {
+        if (elapsed_time_timer_running) {
+            stop_elapsed_time_timer();  // Call this if the timer is running
+
+        } else {
+            start_elapsed_timer_timer_callback();
+        }
+    }
+}
+
+static void touch_sensor2_released(void * p_event_data, uint16_t event_size)
+{
+    weight_sensor_get_stable_weight(NULL, coffee_stable_weight_callback);
+}
+
+static void touch_sensor4_released(void * p_event_data, uint16_t event_size)
+{
+    if (scalesOperationalState == OFF)
+    {
+        wakeup_from_sleep();
+    }
+    else if (scalesOperationalState == WAITING_FOR_TOUCH_4_RELEASE)
+    {
+        scalesOperationalState = OFF;
+    }
+    else
+    {
+        display_indicate_tare();
+        weight_sensor_tare(tare_complete_callback);
+    }
+}
+
 void touchSensor1TOutChanged(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
 {
     if (nrf_gpio_pin_read(pin) == 0U)
@@ -114,22 +194,8 @@ void touchSensor1TOutChanged(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action
         ret_code_t err_code = app_timer_stop(m_touch_sensor1_timer_id);
         APP_ERROR_CHECK(err_code);
         NRF_LOG_INFO("Pin %d Tout released.", pin);
-        
-        if (button1OperationState == WAITING_FOR_TOUCH_RELEASE)
-        {
-            weight_sensor_get_stable_weight(begin_timer_on_weight_change);
-            
-            button1OperationState = IDLE;
-        }
-        else
-        {
-            if (elapsed_time_timer_running) {
-                stop_elapsed_time_timer();  // Call this if the timer is running
-                
-            } else {
-                start_elapsed_timer_timer_callback();
-            }
-        }    
+
+        schedule(touch_sensor1_released, NULL, 0);
     }
 
     NRF_LOG_FLUSH();
@@ -144,7 +210,7 @@ void touchSensor2TOutChanged(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action
     else
     {
         NRF_LOG_INFO("Pin %d Tout released.", pin);
-        weight_sensor_get_stable_weight(set_coffee_weight_callback);
+        schedule(touch_sensor2_released, NULL, 0);
     }
     NRF_LOG_FLUSH();
 }
@@ -176,19 +242,7 @@ void touchSensor4TOutChanged(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action
         ret_code_t err_code = app_timer_stop(m_touch_sensor4_timer_id);
         APP_ERROR_CHECK(err_code);
         NRF_LOG_INFO("Pin %d Tout released.", pin);
-        if (scalesOperationalState == OFF)
-        {
-            wakeup_from_sleep();
-        }
-        else if (scalesOperationalState == WAITING_FOR_TOUCH_4_RELEASE)
-        {
-            scalesOperationalState = OFF;
-        }
-        else
-        {
-            display_indicate_tare();
-            weight_sensor_tare();
-        }
+        schedule(touch_sensor4_released, NULL, 0);
     }
     NRF_LOG_FLUSH();
 }
@@ -239,29 +293,207 @@ Scales_Display_t display1 = {
 };
 
 
-static void weight_filter_output_coefficient_callback(float coeffifient)
+static void weight_filter_cutoff_set(void * p_event_data, uint16_t event_size)
 {
-    NRF_LOG_INFO("weight_filter_output_coefficient_callback entered.");
-    NRF_LOG_FLUSH();
-    weight_sensor_set_weight_filter_output_coefficient(coeffifient);
-    NRF_LOG_INFO("weight_filter_output_coefficient_callback complete");
-    NRF_LOG_FLUSH();
+    float cutoffHz = *(float *)p_event_data;
+
+    if (weight_sensor_set_weight_filter_cutoff(cutoffHz))
+    {
+        saved_parameters_setWeightFilterCutoff(cutoffHz);
+    }
+    else
+    {
+        NRF_LOG_INFO("Weight filter cutoff " NRF_LOG_FLOAT_MARKER " Hz rejected", NRF_LOG_FLOAT(cutoffHz));
+    }
+
+    // report the cutoff in use so a rejected value doesn't stay on the client
+    diagnostics_service_weight_filter_cutoff_update(weight_sensor_get_weight_filter_cutoff(), BLE_CONN_HANDLE_ALL);
+}
+
+static void weight_filter_cutoff_callback(float cutoffHz)
+{
+    NRF_LOG_INFO("weight_filter_cutoff_callback entered.");
+    schedule(weight_filter_cutoff_set, &cutoffHz, sizeof(cutoffHz));
+}
+
+// Report the pipeline in use and the Kalman tuning, a weigh mode change or a rejected write can change what
+// the client last wrote
+static void publish_pipeline()
+{
+    float processNoise;
+    float measurementNoise;
+
+    // Not straight into the packed fields, the FPU can't store to unaligned addresses
+    weight_sensor_get_kalman_noise(&processNoise, &measurementNoise);
+
+    diagnostics_pipeline_t pipeline =
+    {
+        .pipeline = (uint8_t)weight_sensor_get_pipeline(),
+        .process_noise = processNoise,
+        .measurement_noise = measurementNoise
+    };
+
+    diagnostics_service_pipeline_update(&pipeline, BLE_CONN_HANDLE_ALL);
+}
+
+// Selects the pipeline until the next weigh mode change, which sets the one of its profile
+static void pipeline_set(void * p_event_data, uint16_t event_size)
+{
+    diagnostics_pipeline_t *pipeline = (diagnostics_pipeline_t *)p_event_data;
+
+    if (!weight_sensor_set_kalman_noise(pipeline->process_noise, pipeline->measurement_noise))
+    {
+        NRF_LOG_INFO("Kalman noise " NRF_LOG_FLOAT_MARKER ", " NRF_LOG_FLOAT_MARKER " rejected",
+                     NRF_LOG_FLOAT(pipeline->process_noise), NRF_LOG_FLOAT(pipeline->measurement_noise));
+    }
+
+    if (pipeline->pipeline == WEIGHT_SENSOR_PIPELINE_BIQUAD || pipeline->pipeline == WEIGHT_SENSOR_PIPELINE_KALMAN)
+    {
+        weight_sensor_set_pipeline((weight_sensor_pipeline_t)pipeline->pipeline);
+    }
+    else
+    {
+        NRF_LOG_INFO("Unknown pipeline %d rejected", pipeline->pipeline);
+    }
+
+    publish_pipeline();
+}
+
+static void pipeline_callback(const diagnostics_pipeline_t *pipeline)
+{
+    NRF_LOG_INFO("pipeline_callback entered.");
+    schedule(pipeline_set, pipeline, sizeof(*pipeline));
+}
+
+static void save_load_cell_compensation()
+{
+    load_cell_compensation_coefficients_t coefficients;
+    weight_sensor_get_compensation(&coefficients);
+
+    saved_parameters_setLoadCellCompensation(coefficients.offset_tempco,
+                                             coefficients.span_tempco,
+                                             coefficients.span_reference_temperature,
+                                             coefficients.creep_coefficient,
+                                             coefficients.creep_time_constant);
+}
+
+static void compensation_learning_complete_callback(weight_sensor_result_t result, const load_cell_compensation_coefficients_t *coefficients)
+{
+    if (result == WEIGHT_SENSOR_SUCCESS)
+    {
+        save_load_cell_compensation();
+    }
+    else
+    {
+        NRF_LOG_WARNING("Compensation learning failed: %d", result);
+    }
+
+    diagnostics_service_compensation_learning_result_update((uint8_t)result, BLE_CONN_HANDLE_ALL);
+}
+
+static void compensation_learning_command(void * p_event_data, uint16_t event_size)
+{
+    uint8_t command = *(uint8_t *)p_event_data;
+
+    switch (command)
+    {
+        case DIAGNOSTICS_COMPENSATION_LEARNING_OFFSET_TEMPCO:
+            weight_sensor_learning_start(WEIGHT_SENSOR_LEARNING_OFFSET_TEMPCO, compensation_learning_complete_callback);
+            break;
+
+        case DIAGNOSTICS_COMPENSATION_LEARNING_SPAN_TEMPCO:
+            weight_sensor_learning_start(WEIGHT_SENSOR_LEARNING_SPAN_TEMPCO, compensation_learning_complete_callback);
+            break;
+
+        case DIAGNOSTICS_COMPENSATION_LEARNING_CREEP:
+            weight_sensor_learning_start(WEIGHT_SENSOR_LEARNING_CREEP, compensation_learning_complete_callback);
+            break;
+
+        case DIAGNOSTICS_COMPENSATION_LEARNING_FINISH:
+            weight_sensor_learning_finish();
+            break;
+
+        default:
+            NRF_LOG_WARNING("Unknown compensation learning command %d", command);
+            break;
+    }
+}
+
+static void compensation_learning_callback(uint8_t command)
+{
+    schedule(compensation_learning_command, &command, sizeof(command));
 }
 
-static void calibration_complete_callback(float scaleFactor)
+static void calibration_complete_callback(weight_sensor_result_t result, float scaleFactor)
 {
     NRF_LOG_INFO("calibration_complete_callback entered.");
     NRF_LOG_FLUSH();
+
+    if (result != WEIGHT_SENSOR_SUCCESS)
+    {
+        NRF_LOG_WARNING("Calibration failed: %d", result);
+        return;
+    }
+
     saved_parameters_SetSavedScaleFactor(scaleFactor);
+
+    calibration_table_t calibrationTable;
+    weight_sensor_get_calibration_table(&calibrationTable);
+    saved_parameters_setCalibrationPoints(calibrationTable.reading, calibrationTable.mass, calibrationTable.count);
+
+    // calibration moves the span reference temperature to the current temperature
+    save_load_cell_compensation();
+
     NRF_LOG_INFO("Calibration complete callback.");
     NRF_LOG_FLUSH();
 }
 
-static void weight_sensor_service_calibration_callback()
+void tare_complete_callback(weight_sensor_result_t result)
 {
-    weight_sensor_calibrate(calibration_complete_callback);
+    if (result != WEIGHT_SENSOR_SUCCESS)
+    {
+        NRF_LOG_WARNING("Tare failed: %d", result);
+        return;
+    }
 
-    NRF_LOG_INFO("weight_sensor_service_calibration_callback exit.");
+    // The weight sensor logs the same figures, this makes them visible in the field
+    diagnostics_service_tare_update(weight_sensor_get_tare_latency_ms(), weight_sensor_get_last_tare_attempts(),
+                                    BLE_CONN_HANDLE_ALL);
+}
+
+static void tare_requested(void * p_event_data, uint16_t event_size)
+{
+    weight_sensor_tare(tare_complete_callback);
+}
+
+static void weight_sensor_service_tare_callback()
+{
+    schedule(tare_requested, NULL, 0);
+}
+
+static void calibration_requested(void * p_event_data, uint16_t event_size)
+{
+    calibration_request_t *request = (calibration_request_t *)p_event_data;
+
+    if (request->command == WEIGHT_SENSOR_CALIBRATION_ADD_POINT)
+    {
+        weight_sensor_calibrate_point(request->referenceMass, calibration_complete_callback);
+    }
+    else
+    {
+        weight_sensor_calibrate(request->referenceMass, calibration_complete_callback);
+    }
+}
+
+static void weight_sensor_service_calibration_callback(uint8_t command, float referenceMass)
+{
+    calibration_request_t request =
+    {
+        .command = command,
+        .referenceMass = referenceMass,
+    };
+
+    schedule(calibration_requested, &request, sizeof(request));
 }
 
 void set_coffee_to_water_ratio(uint16_t requestValue)
@@ -270,23 +502,95 @@ void set_coffee_to_water_ratio(uint16_t requestValue)
     saved_parameters_setCoffeeToWaterRatioDenominator(requestValue);
 }
 
+static void weigh_mode_requested(void * p_event_data, uint16_t event_size)
+{
+    uint8_t requestValue = *(uint8_t *)p_event_data;
+
+    // A shot or brew in progress belongs to the mode it started in
+    if (requestValue != weigh_mode_get() && elapsed_time_timer_running)
+    {
+        stop_elapsed_time_timer();
+    }
+
+    if (weigh_mode_apply(requestValue))
+    {
+        saved_parameters_setWeighMode(requestValue);
+        publish_pipeline();
+    }
+}
+
 void set_weigh_mode(uint8_t requestValue)
 {
-    saved_parameters_setWeighMode(requestValue);
+    schedule(weigh_mode_requested, &requestValue, sizeof(requestValue));
 }
 
-void set_coffee_weight_callback()
+static void set_coffee_weight(float weight)
 {
-    float coffeeWeight = roundf(weight_sensor_get_weight_filtered() * 10)/10.0;
+    float coffeeWeight = roundf(weight * 10)/10.0;
 
     display_update_coffee_weight_label(coffeeWeight);
 
     float waterWeight = coffeeWeight / (saved_parameters_getCoffeeToWaterRatioNumerator()) * saved_parameters_getCoffeeToWaterRatioDenominator();
     NRF_LOG_RAW_INFO("waterWeight:%s%d.%01d\n" , NRF_LOG_FLOAT_SCALES(waterWeight) );
-    NRF_LOG_INFO("set_coffee_weight_callback - calculated water weight");
+    NRF_LOG_INFO("set_coffee_weight - calculated water weight");
     ble_weight_sensor_service_water_weight_update(waterWeight);
     display_update_water_weight_label(waterWeight);
-    NRF_LOG_INFO("set_coffee_weight_callback - exit");
+
+    pour_predictor_set_target(&mPourPredictor, waterWeight);
+    brew_phase_set_target(&mBrewPhase, waterWeight);
+    shot_timer_set_target(&mShotTimer, waterWeight);
+    display_indicate_pour_stop(false);
+    ble_weight_sensor_service_pour_stop_update(0);
+    NRF_LOG_INFO("set_coffee_weight - exit");
+}
+
+static void coffee_weight_requested(void * p_event_data, uint16_t event_size)
+{
+    set_coffee_weight(weight_sensor_get_weight_filtered());
+}
+
+void set_coffee_weight_callback()
+{
+    schedule(coffee_weight_requested, NULL, 0);
+}
+
+static void coffee_stable_weight_callback(weight_sensor_result_t result, float weight, float confidence)
+{
+    if (result != WEIGHT_SENSOR_SUCCESS)
+    {
+        // Keep the previous coffee weight rather than take one that never settled
+        NRF_LOG_INFO("Coffee weight not stable, result %d", result);
+        return;
+    }
+
+    NRF_LOG_INFO("Coffee weight stable, confidence " NRF_LOG_FLOAT_MARKER, NRF_LOG_FLOAT(confidence));
+    set_coffee_weight(weight);
+}
+
+static void timer_stable_weight_callback(weight_sensor_result_t result, float weight, float confidence)
+{
+    if (result == WEIGHT_SENSOR_ERROR_CANCELLED)
+    {
+        return;
+    }
+
+    // Arm the timer even if the weight never settled, the button was pressed to start it
+    if (result != WEIGHT_SENSOR_SUCCESS)
+    {
+        NRF_LOG_INFO("Weight not stable before starting the timer, result %d", result);
+    }
+
+    begin_timer_on_weight_change();
+}
+
+static void start_timer_requested(void * p_event_data, uint16_t event_size)
+{
+    begin_timer_on_weight_change();
+}
+
+static void start_timer_callback()
+{
+    schedule(start_timer_requested, NULL, 0);
 }
 
 void begin_timer_on_weight_change()
@@ -305,11 +609,73 @@ void begin_timer_on_weight_change()
 
     display_update_timer_label(0);
 
+    // The brew starts with the first drips, keep zero tracking from taking them out
+    weight_sensor_set_brew_active(true);
+
+    // Espresso shots start themselves from the conversion timestamps
+    if (weigh_mode_get() == WEIGH_MODE_ESPRESSO)
+    {
+        shot_timer_reset(&mShotTimer);
+        return;
+    }
+
     weight_sensor_enable_weight_change_sense(start_elapsed_timer_timer_callback);
 }
 
+// ms from the interpolated start or stop of a shot to its time being sent to the display
+static uint32_t shot_timer_display_latency()
+{
+    uint32_t latencyMs = (sample_clock_now() - mShotTimer.event_time) / (SAMPLE_CLOCK_TICKS_PER_SECOND / 1000);
+
+    if (latencyMs > SHOT_TIMER_MAX_LATENCY_MS)
+    {
+        NRF_LOG_WARNING("Shot timer display latency %d ms", latencyMs);
+    }
+
+    return latencyMs;
+}
+
+static void start_shot_timer_display()
+{
+    ret_code_t err_code = app_timer_stop(m_elapsed_time_timer_id);
+    APP_ERROR_CHECK(err_code);
+
+    currentElapsedTime = 0;
+
+    display_stop_flash_elapsed_time_label();
+    display_update_timer_label_tenths(shot_timer_elapsed_ms(&mShotTimer, sample_clock_now()) / 100);
+    NRF_LOG_INFO("Shot started, %d ms latency", shot_timer_display_latency());
+
+    err_code = app_timer_start(m_shot_timer_display_timer_id, SHOT_TIMER_DISPLAY_INTERVAL, NULL);
+    APP_ERROR_CHECK(err_code);
+
+    elapsed_time_timer_running = true;
+}
+
+static void publish_shot_result()
+{
+    shot_timer_result_t *result = &mShotTimer.result;
+
+    display_update_timer_label_tenths(result->time_ms / 100);
+
+    uint32_t latencyMs = shot_timer_display_latency();
+    result->latency_ms = (latencyMs > UINT16_MAX) ? UINT16_MAX : latencyMs;
+
+    NRF_LOG_INFO("Shot " NRF_LOG_FLOAT_MARKER " g in %d ms, %d ms latency", NRF_LOG_FLOAT(result->yield), result->time_ms, result->latency_ms);
+    ble_weight_sensor_service_shot_result_update((uint8_t *)result, sizeof(*result));
+}
+
 void start_elapsed_timer_timer_callback()
 {
+    // The shot timer starts on the first drips, the button only arms it
+    if (weigh_mode_get() == WEIGH_MODE_ESPRESSO)
+    {
+        shot_timer_reset(&mShotTimer);
+        display_update_timer_label_tenths(0);
+        weight_sensor_set_brew_active(true);
+        return;
+    }
+
     ret_code_t err_code = app_timer_stop(m_elapsed_time_timer_id);
     APP_ERROR_CHECK(err_code);
 
@@ -321,6 +687,15 @@ void start_elapsed_timer_timer_callback()
     APP_ERROR_CHECK(err_code);   
 
     elapsed_time_timer_running = true;
+    weight_sensor_set_brew_active(true);
+}
+
+static void publish_brew_phase()
+{
+    const brew_phase_summary_t *summary = &mBrewPhase.last_summary;
+
+    NRF_LOG_INFO("Brew phase %d ended, %d - %d ms", summary->phase, summary->start_ms, summary->end_ms);
+    ble_weight_sensor_service_brew_phase_update((uint8_t *)summary, sizeof(*summary));
 }
 
 void stop_elapsed_time_timer()
@@ -328,7 +703,48 @@ void stop_elapsed_time_timer()
     ret_code_t err_code = app_timer_stop(m_elapsed_time_timer_id);
     APP_ERROR_CHECK(err_code);
 
+    err_code = app_timer_stop(m_shot_timer_display_timer_id);
+    APP_ERROR_CHECK(err_code);
+
     elapsed_time_timer_running = false;
+    weight_sensor_set_brew_active(false);
+
+    if (brew_phase_stop(&mBrewPhase, weight_sensor_get_weight_filtered()))
+    {
+        publish_brew_phase();
+    }
+
+    if (shot_timer_stop(&mShotTimer, weight_sensor_get_weight_filtered(), sample_clock_now()))
+    {
+        publish_shot_result();
+    }
+}
+
+static void shot_timer_weight_update(int32_t milligrams)
+{
+    float delay = weight_sensor_get_filter_delay();
+
+    switch (shot_timer_update(&mShotTimer, milligrams / 1000.0f, weight_sensor_get_sample_timestamp(), delay))
+    {
+        case SHOT_TIMER_EVENT_STARTED:
+            start_shot_timer_display();
+            weight_sensor_set_brew_active(true);
+            break;
+
+        case SHOT_TIMER_EVENT_STOPPED:
+        {
+            ret_code_t err_code = app_timer_stop(m_shot_timer_display_timer_id);
+            APP_ERROR_CHECK(err_code);
+
+            elapsed_time_timer_running = false;
+            weight_sensor_set_brew_active(false);
+            publish_shot_result();
+            break;
+        }
+
+        default:
+            break;
+    }
 }
 
 void enable_write_to_weight_characteristic()
@@ -343,6 +759,17 @@ void disable_write_to_weight_characteristic()
     writeToWeightCharacteristic = false;
 }
 
+// Write the learned pour in flight time to flash once it has moved more than threshold from the saved one
+static void save_pour_in_flight_time(float threshold)
+{
+    float learned = mPourPredictor.in_flight_time;
+
+    if (fabsf(learned - saved_parameters_getPourInFlightTime()) > threshold)
+    {
+        saved_parameters_setPourInFlightTime(learned);
+    }
+}
+
 /**@brief Function for handling the weight measurement timer timeout.
  *
  * @details This function will be called each time the weight measurement timer expires.
@@ -350,26 +777,112 @@ void disable_write_to_weight_characteristic()
  * @param[in] p_context  Pointer used for passing some arbitrary information (context) from the
  *                       app_start_timer() call to the timeout handler.
  */
-static void new_weight_value_received_handler(float weight)
+
+static void new_weight_value_received_handler(int32_t milligrams)
 {
-    float scaleValue = roundf(weight*10)/10.0;
+    float samplingRate = weight_sensor_get_sampling_rate();
+    float dt = samplingRate > 0.0f ? 1.0f / samplingRate : 0.0f;
+
+    // The weigh mode decides how often the weight is shown and notified
+    if (weigh_mode_ble_update_due(dt) && writeToWeightCharacteristic)
+    {
+        ble_weight_sensor_service_sensor_data_milligrams_update(milligrams);
+    }
+
+    if (weigh_mode_display_update_due(dt))
+    {
+        display_update_weight_label_milligrams(milligrams);
+    }
+
+    if (samplingRate <= 0.0f)
+    {
+        return;
+    }
+
+    pour_predictor_set_latency(&mPourPredictor, weight_sensor_get_filter_delay() + DISPLAY_LATENCY_S);
+
+    switch (pour_predictor_update(&mPourPredictor, milligrams / 1000.0f, weight_sensor_get_grams_per_second(), dt))
+    {
+        case POUR_PREDICTOR_EVENT_STOP_NOW:
+            NRF_LOG_INFO("Stop pouring");
+            display_indicate_pour_stop(true);
+            ble_weight_sensor_service_pour_stop_update(1);
+            break;
+
+        case POUR_PREDICTOR_EVENT_REARMED:
+            display_indicate_pour_stop(false);
+            ble_weight_sensor_service_pour_stop_update(0);
+            break;
+
+        case POUR_PREDICTOR_EVENT_LEARNED:
+            NRF_LOG_INFO("Pour in flight time " NRF_LOG_FLOAT_MARKER " s", NRF_LOG_FLOAT(mPourPredictor.in_flight_time));
+            save_pour_in_flight_time(POUR_IN_FLIGHT_SAVE_THRESHOLD_S);
+            break;
+
+        default:
+            break;
+    }
+
+    // Espresso shots are timed from the conversion timestamps, the brew phases are for pour over
+    if (weigh_mode_get() == WEIGH_MODE_ESPRESSO)
+    {
+        shot_timer_weight_update(milligrams);
+        return;
+    }
 
-    if (writeToWeightCharacteristic)
+    switch (brew_phase_update(&mBrewPhase, milligrams / 1000.0f, weight_sensor_get_grams_per_second(), dt))
     {
-        ble_weight_sensor_service_sensor_data_update((uint8_t*)&scaleValue, sizeof(float));
+        case BREW_PHASE_EVENT_STARTED:
+            // Pouring started without the timer, start it for the brew
+            if (!elapsed_time_timer_running)
+            {
+                start_elapsed_timer_timer_callback();
+            }
+            break;
+
+        case BREW_PHASE_EVENT_PHASE_ENDED:
+            publish_brew_phase();
+            break;
+
+        case BREW_PHASE_EVENT_FINISHED:
+            publish_brew_phase();
+
+            if (elapsed_time_timer_running)
+            {
+                stop_elapsed_time_timer();
+            }
+            break;
+
+        default:
+            break;
     }
-    display_update_weight_label(scaleValue);
 }
 
 static void weight_conversion_complete_handler()
 {
     float gramsPerSecond = weight_sensor_get_grams_per_second();
-    uint16_t samplingRate = weight_sensor_get_sampling_rate();
+    float samplingRate = weight_sensor_get_sampling_rate();
 
 
     display_update_tare_attempts_label(weight_sensor_get_taring_attempts());
     display_update_grams_per_second_bar_label(gramsPerSecond);
     display_update_sampling_rate_label(samplingRate);
+
+    diagnostics_service_rejected_samples_update(weight_sensor_get_rejected_samples(), BLE_CONN_HANDLE_ALL);
+    diagnostics_service_sample_queue_update(weight_sensor_get_sample_overruns(),
+                                            weight_sensor_get_sample_queue_high_watermark(),
+                                            BLE_CONN_HANDLE_ALL);
+
+    // Rounded so the slow creep of the correction doesn't notify on every conversion
+    float zeroTrackingCorrection = roundf(weight_sensor_get_zero_tracking_correction() * 100.0f) / 100.0f;
+    diagnostics_service_zero_tracking_update(zeroTrackingCorrection, BLE_CONN_HANDLE_ALL);
+
+    // Only the least squares flow has a fit behind it, rounded for the same reason
+    if (weight_sensor_get_flow_source() == WEIGHT_SENSOR_FLOW_LEAST_SQUARES)
+    {
+        float flowFitQuality = roundf(weight_sensor_get_flow_fit_quality() * 100.0f) / 100.0f;
+        diagnostics_service_flow_fit_quality_update(flowFitQuality, BLE_CONN_HANDLE_ALL);
+    }
 }
 
 void elapsed_time_timeout_handler(void * p_context)
@@ -388,6 +901,44 @@ void elapsed_time_timeout_handler(void * p_context)
     display_update_timer_label(currentElapsedTime);
 }
 
+static void shot_timer_display_tick(void * p_event_data, uint16_t event_size)
+{
+    // A tick queued just before the shot stopped shows the final time, one queued before a reset is dropped
+    if (mShotTimer.state == SHOT_TIMER_IDLE)
+    {
+        return;
+    }
+
+    uint32_t elapsedMs = shot_timer_elapsed_ms(&mShotTimer, sample_clock_now());
+
+    display_update_timer_label_tenths(elapsedMs / 100);
+
+    // The elapsed time service counts whole seconds
+    if (elapsedMs / 1000 != currentElapsedTime)
+    {
+        currentElapsedTime = elapsedMs / 1000;
+
+        ble_elapsed_time_t elapsed_time = 
+        {
+            .flags = 0b00000001, // Time value is counter
+            .elapsed_time_lsb = currentElapsedTime & 0xFF,
+            .elapsed_time_5sb = currentElapsedTime >> 8 & 0xFF
+        };
+
+        ble_elapsed_time_service_elapsed_time_update(elapsed_time);
+    }
+}
+
+void shot_timer_display_timeout_handler(void * p_context)
+{
+    schedule(shot_timer_display_tick, NULL, 0);
+}
+
+static void temperature_update(void * p_event_data, uint16_t event_size)
+{
+    weight_sensor_set_temperature(*(float *)p_event_data);
+}
+
 void battery_level_timeout_handler(void * p_context)
 {
     if (max17260Sensor.initialised)
@@ -402,6 +953,13 @@ void battery_level_timeout_handler(void * p_context)
         float remaining_capacity;
         float fullCapacity;
         float remainingCapacity;
+        float temperature;
+
+        // the fuel gauge sits next to the load cell, its temperature drives the load cell compensation
+        if (max17260_getTemperature(&max17260Sensor, &temperature))
+        {
+            schedule(temperature_update, &temperature, sizeof(temperature));
+        }
 
         max17260_getStateOfCharge(&max17260Sensor, &soc);
         max17260_getAvgCurrent(&max17260Sensor, &averageCurrent);
@@ -474,13 +1032,15 @@ void touch_sensor1_timeout_handler(void * p_context)
     {
         ret_code_t err_code = app_timer_stop(m_elapsed_time_timer_id);
         APP_ERROR_CHECK(err_code);
+        err_code = app_timer_stop(m_shot_timer_display_timer_id);
+        APP_ERROR_CHECK(err_code);
         display_flash_elapsed_time_label();
         display_update_timer_label(0);
         button1OperationState = WAITING_FOR_TOUCH_RELEASE;
     }
 }
 
-void touch_sensor4_timeout_handler(void * p_context)
+static void touch_sensor4_held(void * p_event_data, uint16_t event_size)
 {
     if (scalesOperationalState == ON)
     {
@@ -489,6 +1049,11 @@ void touch_sensor4_timeout_handler(void * p_context)
     }
 }
 
+void touch_sensor4_timeout_handler(void * p_context)
+{
+    schedule(touch_sensor4_held, NULL, 0);
+}
+
 /**@brief Function for the Timer initialization.
  *
  * @details Initializes the timer module. This creates and starts application timers.
@@ -502,6 +1067,9 @@ static void timers_init(void)
     err_code = app_timer_create(&m_elapsed_time_timer_id, APP_TIMER_MODE_REPEATED, elapsed_time_timeout_handler);
     APP_ERROR_CHECK(err_code);
 
+    err_code = app_timer_create(&m_shot_timer_display_timer_id, APP_TIMER_MODE_REPEATED, shot_timer_display_timeout_handler);
+    APP_ERROR_CHECK(err_code);
+
     err_code = app_timer_create(&m_battery_level_timer_id, APP_TIMER_MODE_SINGLE_SHOT, battery_level_timeout_handler);
     APP_ERROR_CHECK(err_code);
 
@@ -527,6 +1095,9 @@ void timers_stop()
     err_code = app_timer_stop(m_elapsed_time_timer_id);
     APP_ERROR_CHECK(err_code);
 
+    err_code = app_timer_stop(m_shot_timer_display_timer_id);
+    APP_ERROR_CHECK(err_code);
+
     err_code = app_timer_stop(m_battery_level_timer_id);
     APP_ERROR_CHECK(err_code);
 
@@ -675,6 +1246,9 @@ void prepare_to_sleep()
 {
     timers_stop();
 
+    // whatever the pours since the last save taught the predictor
+    save_pour_in_flight_time(0.0f);
+
     // send components to sleep
     weight_sensor_sleep();
     display_sleep();
@@ -708,9 +1282,7 @@ void wakeup_from_sleep()
 
     // wake up components
     display_wakeup();
-    weight_sensor_wakeup();
-        
-   // weight_sensor_tare();
+    weight_sensor_wakeup(tare_complete_callback);
 
     timers_start();
 
@@ -740,6 +1312,10 @@ int main(void)
 
     // Initialise the saved parameters module
     saved_parameters_init();
+
+    pour_predictor_init(&mPourPredictor, saved_parameters_getPourInFlightTime());
+    brew_phase_init(&mBrewPhase);
+    shot_timer_init(&mShotTimer);
     
     // Start execution.
     NRF_LOG_INFO("Scales Started.");
@@ -749,6 +1325,7 @@ int main(void)
     twi0_master_init();                  // initialize nRF5 the twi library 
     spi3_master_init();
     //twi_master_secondary_init();
+    APP_SCHED_INIT(SCHED_MAX_EVENT_DATA_SIZE, SCHED_QUEUE_SIZE);
     timers_init();                      // Initialise nRF5 timers library
     nrf_buddy_leds_init();              // initialise nRF52 buddy leds library
     power_management_init();            // initialise the nRF5 power management library
@@ -780,19 +1357,29 @@ int main(void)
         NRF_LOG_INFO("Error initialing diagnostics service");
     }
 
-    ble_weight_sensor_set_tare_callback(weight_sensor_tare);
+    ble_weight_sensor_set_tare_callback(weight_sensor_service_tare_callback);
     ble_weight_sensor_set_calibration_callback(weight_sensor_service_calibration_callback);
     ble_weight_sensor_set_coffee_to_water_ratio_callback(set_coffee_to_water_ratio);
     ble_weight_sensor_set_weigh_mode_callback(set_weigh_mode);
     ble_weight_sensor_set_coffee_weight_callback(set_coffee_weight_callback);
-    ble_weight_sensor_set_start_timer_callback(begin_timer_on_weight_change);
+    ble_weight_sensor_set_start_timer_callback(start_timer_callback);
 
     saved_parameters_setCoffeeToWaterRatioNumerator(1);
     saved_parameters_setCoffeeToWaterRatioDenominator(16);
 
-    weight_sensor_set_weight_filter_output_coefficient(saved_parameters_getWeightFilterOutputCoefficient());
+    float savedCutoff = saved_parameters_getWeightFilterCutoff();
 
-    diagnostics_service_weight_filter_output_coefficient_received_callback(weight_filter_output_coefficient_callback);
+    if (!weight_sensor_set_weight_filter_cutoff(savedCutoff))
+    {
+        NRF_LOG_WARNING("Saved weight filter cutoff " NRF_LOG_FLOAT_MARKER " Hz rejected, using the default",
+                        NRF_LOG_FLOAT(savedCutoff));
+        weight_sensor_set_weight_filter_cutoff(WEIGHT_SENSOR_DEFAULT_FILTER_CUTOFF_HZ);
+    }
+    diagnostics_service_weight_filter_cutoff_update(weight_sensor_get_weight_filter_cutoff(), BLE_CONN_HANDLE_ALL);
+
+    diagnostics_service_weight_filter_cutoff_received_callback(weight_filter_cutoff_callback);
+    diagnostics_service_compensation_learning_received_callback(compensation_learning_callback);
+    diagnostics_service_pipeline_received_callback(pipeline_callback);
 
     uint16_t savedCoffeeToWaterRatio = saved_parameters_getCoffeeToWaterRatioNumerator() << 8 | saved_parameters_getCoffeeToWaterRatioDenominator();
     ble_weight_sensor_service_coffee_to_water_ratio_update((uint8_t*)&savedCoffeeToWaterRatio, sizeof(savedCoffeeToWaterRatio));
@@ -809,12 +1396,32 @@ int main(void)
     weight_sensor_init_t ws_init = {
         .scaleFactor = saved_parameters_getSavedScaleFactor(),
         .newWeightValueReceivedCallback = NULL,//new_weight_value_received_handler,
-        .newWeightFilteredValueReceivedCallback = new_weight_value_received_handler,
+        .newWeightFilteredValueReceivedCallback = NULL,
+        .newWeightFilteredMilligramsReceivedCallback = new_weight_value_received_handler,
+        .rawSampleReceivedCallback = diagnostics_service_raw_capture_add,
         .conversionCompleteCallback = weight_conversion_complete_handler
     };
 
     weight_sensor_init(ws_init);
 
+    load_cell_compensation_coefficients_t compensation = {
+        .offset_tempco = saved_parameters_getOffsetTempco(),
+        .span_tempco = saved_parameters_getSpanTempco(),
+        .span_reference_temperature = saved_parameters_getSpanReferenceTemperature(),
+        .creep_coefficient = saved_parameters_getCreepCoefficient(),
+        .creep_time_constant = saved_parameters_getCreepTimeConstant()
+    };
+
+    weight_sensor_set_compensation(&compensation);
+
+    calibration_table_t calibrationTable;
+    calibrationTable.count = saved_parameters_getCalibrationPoints(calibrationTable.reading, calibrationTable.mass, CALIBRATION_TABLE_MAX_POINTS);
+    weight_sensor_set_calibration_table(&calibrationTable);
+
+    // Unknown saved modes leave the sensor in its pour over defaults
+    weigh_mode_apply(saved_parameters_getWeighMode());
+    publish_pipeline();
+
     if (max17260_init(&max17260Sensor, &m_twi0))
     {
         NRF_LOG_INFO("MAX17260 Initialised");
@@ -845,8 +1452,11 @@ int main(void)
 
     for (;;)
     {
+        app_sched_execute();
+
         if (scalesOperationalState == ON)
         {
+            weight_sensor_process();
             display_loop();
         }
         else